@@ -0,0 +1,93 @@
+#ifndef __NATIVE_FAKES_ADAFRUIT_ADS1X15_H__
+#define __NATIVE_FAKES_ADAFRUIT_ADS1X15_H__
+
+#include <stdint.h>
+
+#include <functional>
+
+#define ADS1X15_ADDRESS (0x48)
+
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_0 (0x4000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_1 (0x5000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_2 (0x6000)
+#define ADS1X15_REG_CONFIG_MUX_SINGLE_3 (0x7000)
+
+#define RATE_ADS1115_8SPS (0x0000)
+#define RATE_ADS1115_16SPS (0x0020)
+#define RATE_ADS1115_32SPS (0x0040)
+#define RATE_ADS1115_64SPS (0x0060)
+#define RATE_ADS1115_128SPS (0x0080)
+#define RATE_ADS1115_250SPS (0x00A0)
+#define RATE_ADS1115_475SPS (0x00C0)
+#define RATE_ADS1115_860SPS (0x00E0)
+
+typedef enum {
+    GAIN_TWOTHIRDS = 0x0000,
+    GAIN_ONE = 0x0200,
+    GAIN_TWO = 0x0400,
+    GAIN_FOUR = 0x0600,
+    GAIN_EIGHT = 0x0800,
+    GAIN_SIXTEEN = 0x0A00
+} adsGain_t;
+
+class TwoWire;
+
+/**
+ * @brief ADS1115 model with the Adafruit driver's API
+ *
+ * Every register access spends the virtual time its I2C transaction takes,
+ * at 100 kHz unless set otherwise, and a single-shot conversion completes
+ * 1/SPS after it was started, scaled by the chip's clock error. The
+ * conversion register keeps the last result until the next conversion
+ * completes. The inputs are functions of
+ * the virtual time in us, in volts at the chip's pins.
+ */
+class Adafruit_ADS1115 {
+   public:
+    // Pointer, config and 16-bit value: 38 bits at 100 kHz
+    static const uint32_t WRITE_REGISTER_US = 380;
+    // Pointer write, then address and 16-bit value: 49 bits at 100 kHz
+    static const uint32_t READ_REGISTER_US = 490;
+
+    bool begin(uint8_t i2c_addr = ADS1X15_ADDRESS, TwoWire* wire = nullptr);
+    void setGain(adsGain_t gain) { gain_ = gain; }
+    adsGain_t getGain() { return gain_; }
+    void setDataRate(uint16_t rate);
+    uint16_t getDataRate() { return data_rate_; }
+
+    // Blocks until the conversion is done, polling the config register
+    int16_t readADC_SingleEnded(uint8_t channel);
+    void startADCReading(uint16_t mux, bool continuous);
+    bool conversionComplete();
+    int16_t getLastConversionResults();
+    float computeVolts(int16_t counts);
+
+    // Test side
+    void set_input(int channel, std::function<float(uint64_t us)> volts) { inputs_[channel] = volts; }
+    // Relative error of the chip's oscillator, e.g. 0.1 for 10% slow
+    void set_clock_error(float error) { clock_error_ = error; }
+    // I2C bus frequency the transactions take the time of
+    void set_i2c_frequency(uint32_t hz) { i2c_frequency_ = hz; }
+    uint32_t transactions() { return transactions_; }
+    uint32_t conversions() { return conversions_; }
+
+   private:
+    void transaction(uint32_t us);
+    // Moves a completed conversion into the conversion register
+    void latch();
+    float full_scale();
+
+    adsGain_t gain_ = GAIN_TWOTHIRDS;
+    uint16_t data_rate_ = RATE_ADS1115_128SPS;
+    std::function<float(uint64_t)> inputs_[4];
+    float clock_error_ = 0;
+    uint32_t i2c_frequency_ = 100000;
+    int channel_ = 0;
+    uint64_t conversion_start_ = 0;
+    uint64_t conversion_end_ = 0;
+    int16_t result_ = 0;
+    uint32_t transactions_ = 0;
+    uint32_t conversions_ = 0;
+};
+
+#endif
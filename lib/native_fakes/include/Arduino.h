@@ -0,0 +1,70 @@
+#ifndef __NATIVE_FAKES_ARDUINO_H__
+#define __NATIVE_FAKES_ARDUINO_H__
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "HardwareSerial.h"
+#include "WString.h"
+#include "esp_err.h"
+#include "fakes/clock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// The ESP32 core brings these into the global namespace
+using std::max;
+using std::min;
+
+#define constrain(value, low, high) ((value) < (low) ? (low) : ((value) > (high) ? (high) : (value)))
+
+#define PROGMEM
+#define FPSTR(p) (p)
+#define F(s) (s)
+#define IRAM_ATTR
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define LOW 0x0
+#define HIGH 0x1
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+typedef enum {
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_4 = 4,
+    GPIO_NUM_15 = 15,
+    GPIO_NUM_16 = 16,
+    GPIO_NUM_17 = 17,
+    GPIO_NUM_21 = 21,
+    GPIO_NUM_23 = 23,
+    GPIO_NUM_32 = 32,
+    GPIO_NUM_34 = 34,
+} gpio_num_t;
+
+// 32-bit wrapping counters, as on the ESP32
+inline unsigned long millis() { return (uint32_t)(fakes::now_us() / 1000); }
+inline unsigned long micros() { return (uint32_t)fakes::now_us(); }
+inline void delay(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+inline void delayMicroseconds(uint32_t us) { fakes::advance_us(us); }
+// A yield costs about a microsecond, so busy-waits on micros() end
+inline void yield() { fakes::advance_us(1); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline int digitalRead(uint8_t pin) { return LOW; }
+
+// Cycle counter of a 240 MHz core, derived from the virtual time
+class EspClass {
+   public:
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount() { return (uint32_t)(fakes::now_us() * 240); }
+};
+
+extern EspClass ESP;
+
+#endif
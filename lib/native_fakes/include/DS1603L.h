@@ -0,0 +1,42 @@
+#ifndef __NATIVE_FAKES_DS1603L_H__
+#define __NATIVE_FAKES_DS1603L_H__
+
+#include <stdint.h>
+
+#include "HardwareSerial.h"
+
+#define DS1603L_NO_SENSOR_DETECTED 0
+#define DS1603L_READING_SUCCESS 1
+#define DS1603L_READING_CHECKSUM_FAIL 2
+
+/**
+ * @brief DS1603L driver with the Arduino_DS1603L API
+ *
+ * Parses the sensor's 4-byte frames (0xFF, level high, level low, sum of
+ * the first three) from the stream; the test plays the sensor by feeding
+ * frames to the fake Serial1, e.g. with frame().
+ */
+class DS1603L {
+   public:
+    // No valid frame for that long means no sensor (ms)
+    static const uint32_t TIMEOUT = 10000;
+
+    DS1603L(Stream& sensor) : sensor_{sensor} {}
+    void begin() {}
+    uint16_t readSensor();
+    uint8_t getStatus() { return status_; }
+
+    // Test side: the frame the sensor sends for `level` mm
+    static void frame(uint16_t level, uint8_t* buffer);
+
+   private:
+    Stream& sensor_;
+    uint8_t buffer_[4];
+    uint8_t length_ = 0;
+    uint16_t level_ = 0;
+    uint8_t status_ = DS1603L_NO_SENSOR_DETECTED;
+    bool received_ = false;
+    uint32_t last_valid_ = 0;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef __NATIVE_FAKES_FS_H__
+#define __NATIVE_FAKES_FS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "WString.h"
+
+namespace fs {
+
+struct FileState;
+
+/**
+ * @brief Open file of the fake flash file system
+ *
+ * Behaves like the ESP32 core's fs::File on SPIFFS; every byte written goes
+ * through the flash model of fakes/flash.h, so it can be cut short by a
+ * simulated power loss.
+ */
+class File {
+   public:
+    File() {}
+    File(std::shared_ptr<FileState> state, bool writable, size_t position)
+        : state_{state},
+          writable_{writable},
+          position_{position} {}
+
+    explicit operator bool() const { return state_ != nullptr; }
+
+    size_t read(uint8_t* buffer, size_t size);
+    int read();
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    bool seek(uint32_t position);
+    size_t position() const { return position_; }
+    size_t size() const;
+    int available() const { return state_ == nullptr ? 0 : (int)(size() - position_); }
+    void close() { state_ = nullptr; }
+
+   private:
+    std::shared_ptr<FileState> state_;
+    bool writable_ = false;
+    size_t position_ = 0;
+};
+
+class FS {
+   public:
+    File open(const char* path, const char* mode = "r");
+    File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
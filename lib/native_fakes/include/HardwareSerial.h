@@ -0,0 +1,57 @@
+#ifndef __NATIVE_FAKES_HARDWARESERIAL_H__
+#define __NATIVE_FAKES_HARDWARESERIAL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+
+#define SERIAL_8N1 0x800001c
+
+class Stream {
+   public:
+    virtual ~Stream() {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t write(uint8_t byte) = 0;
+};
+
+/**
+ * @brief UART whose receive side is fed by the test
+ *
+ * receive() queues bytes as if the device on the other end had sent them;
+ * written bytes are dropped.
+ */
+class HardwareSerial : public Stream {
+   public:
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rx_pin = -1, int8_t tx_pin = -1) { baud_ = baud; }
+    void end() {}
+    int available() override { return rx_.size(); }
+    int read() override {
+        if (rx_.empty()) {
+            return -1;
+        }
+        uint8_t byte = rx_.front();
+        rx_.pop_front();
+        return byte;
+    }
+    int peek() override { return rx_.empty() ? -1 : rx_.front(); }
+    size_t write(uint8_t byte) override { return 1; }
+    size_t write(const char* buffer, size_t size) { return size; }
+    int availableForWrite() { return 128; }
+    int printf(const char* format, ...) { return 0; }
+
+    // Test side
+    void receive(const uint8_t* data, size_t length) { rx_.insert(rx_.end(), data, data + length); }
+    unsigned long baud() { return baud_; }
+
+   private:
+    std::deque<uint8_t> rx_;
+    unsigned long baud_ = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef __NATIVE_FAKES_N2KMESSAGES_H__
+#define __NATIVE_FAKES_N2KMESSAGES_H__
+
+#include "N2kMsg.h"
+#include "N2kTypes.h"
+
+// The PGNs of the NMEA2000 library used by the firmware, with the same
+// field layouts, resolutions and lengths
+
+void SetN2kPGN127488(tN2kMsg& N2kMsg, unsigned char EngineInstance, double EngineSpeed,
+                     double EngineBoostPressure = N2kDoubleNA, int8_t EngineTiltTrim = N2kInt8NA);
+
+void SetN2kPGN127489(tN2kMsg& N2kMsg, unsigned char EngineInstance, double EngineOilPress, double EngineOilTemp,
+                     double EngineCoolantTemp, double AltenatorVoltage, double FuelRate, double EngineHours,
+                     double EngineCoolantPress = N2kDoubleNA, double EngineFuelPress = N2kDoubleNA,
+                     int8_t EngineLoad = N2kInt8NA, int8_t EngineTorque = N2kInt8NA,
+                     tN2kEngineDiscreteStatus1 Status1 = 0, tN2kEngineDiscreteStatus2 Status2 = 0);
+
+inline void SetN2kEngineDynamicParam(tN2kMsg& N2kMsg, unsigned char EngineInstance, double EngineOilPress,
+                                     double EngineOilTemp, double EngineCoolantTemp, double AltenatorVoltage,
+                                     double FuelRate, double EngineHours, double EngineCoolantPress = N2kDoubleNA,
+                                     double EngineFuelPress = N2kDoubleNA, int8_t EngineLoad = N2kInt8NA,
+                                     int8_t EngineTorque = N2kInt8NA, tN2kEngineDiscreteStatus1 Status1 = 0,
+                                     tN2kEngineDiscreteStatus2 Status2 = 0) {
+    SetN2kPGN127489(N2kMsg, EngineInstance, EngineOilPress, EngineOilTemp, EngineCoolantTemp, AltenatorVoltage,
+                    FuelRate, EngineHours, EngineCoolantPress, EngineFuelPress, EngineLoad, EngineTorque, Status1,
+                    Status2);
+}
+
+bool ParseN2kPGN127489(const tN2kMsg& N2kMsg, unsigned char& EngineInstance, double& EngineOilPress,
+                       double& EngineOilTemp, double& EngineCoolantTemp, double& AltenatorVoltage, double& FuelRate,
+                       double& EngineHours, double& EngineCoolantPress, double& EngineFuelPress, int8_t& EngineLoad,
+                       int8_t& EngineTorque, tN2kEngineDiscreteStatus1& Status1, tN2kEngineDiscreteStatus2& Status2);
+
+void SetN2kPGN127505(tN2kMsg& N2kMsg, unsigned char Instance, tN2kFluidType FluidType, double Level, double Capacity);
+
+inline void SetN2kFluidLevel(tN2kMsg& N2kMsg, unsigned char Instance, tN2kFluidType FluidType, double Level,
+                             double Capacity) {
+    SetN2kPGN127505(N2kMsg, Instance, FluidType, Level, Capacity);
+}
+
+bool ParseN2kPGN127505(const tN2kMsg& N2kMsg, unsigned char& Instance, tN2kFluidType& FluidType, double& Level,
+                       double& Capacity);
+
+void SetN2kPGN127508(tN2kMsg& N2kMsg, unsigned char BatteryInstance, double BatteryVoltage,
+                     double BatteryCurrent = N2kDoubleNA, double BatteryTemperature = N2kDoubleNA,
+                     unsigned char SID = 1);
+
+bool ParseN2kPGN127508(const tN2kMsg& N2kMsg, unsigned char& BatteryInstance, double& BatteryVoltage,
+                       double& BatteryCurrent, double& BatteryTemperature, unsigned char& SID);
+
+void SetN2kPGN130312(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+                     double ActualTemperature, double SetTemperature = N2kDoubleNA);
+
+inline void SetN2kTemperature(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance,
+                              tN2kTempSource TempSource, double ActualTemperature,
+                              double SetTemperature = N2kDoubleNA) {
+    SetN2kPGN130312(N2kMsg, SID, TempInstance, TempSource, ActualTemperature, SetTemperature);
+}
+
+bool ParseN2kPGN130312(const tN2kMsg& N2kMsg, unsigned char& SID, unsigned char& TempInstance,
+                       tN2kTempSource& TempSource, double& ActualTemperature, double& SetTemperature);
+
+void SetN2kPGN130316(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+                     double ActualTemperature, double SetTemperature = N2kDoubleNA);
+
+bool ParseN2kPGN130316(const tN2kMsg& N2kMsg, unsigned char& SID, unsigned char& TempInstance,
+                       tN2kTempSource& TempSource, double& ActualTemperature, double& SetTemperature);
+
+#endif
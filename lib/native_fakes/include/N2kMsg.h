@@ -0,0 +1,74 @@
+#ifndef __NATIVE_FAKES_N2KMSG_H__
+#define __NATIVE_FAKES_N2KMSG_H__
+
+#include <stdint.h>
+
+#include "N2kTypes.h"
+
+// NMEA 2000 message with the field encoding of the NMEA2000 library
+class tN2kMsg {
+   public:
+    static const int MaxDataLen = 223;
+
+    unsigned long PGN = 0;
+    unsigned char Priority = 6;
+    unsigned char Source = 0;
+    unsigned char Destination = 0xff;
+    int DataLen = 0;
+    unsigned char Data[MaxDataLen];
+    unsigned long MsgTime = 0;
+
+    void SetPGN(unsigned long pgn) {
+        PGN = pgn;
+        DataLen = 0;
+    }
+
+    void AddByte(unsigned char value) { Data[DataLen++] = value; }
+    void Add2ByteUDouble(double value, double precision) { AddUInt(value, precision, 2); }
+    void Add2ByteDouble(double value, double precision) { AddInt(value, precision, 2); }
+    void Add3ByteUDouble(double value, double precision) { AddUInt(value, precision, 3); }
+    void Add4ByteUDouble(double value, double precision) { AddUInt(value, precision, 4); }
+    void Add2ByteUInt(uint16_t value) { AddRaw(value, 2); }
+
+    unsigned char GetByte(int& index) const { return Data[index++]; }
+    double Get2ByteUDouble(double precision, int& index) const { return GetUInt(precision, 2, index); }
+    double Get2ByteDouble(double precision, int& index) const { return GetInt(precision, 2, index); }
+    double Get3ByteUDouble(double precision, int& index) const { return GetUInt(precision, 3, index); }
+    double Get4ByteUDouble(double precision, int& index) const { return GetUInt(precision, 4, index); }
+    uint16_t Get2ByteUInt(int& index) const { return GetRaw(2, index); }
+
+   private:
+    // The all-ones (unsigned) or largest (signed) value marks a missing field
+    void AddUInt(double value, double precision, int size) {
+        uint64_t na = (1ull << (8 * size)) - 1;
+        AddRaw(N2kIsNA(value) || value < 0 ? na : (uint64_t)(value / precision + 0.5), size);
+    }
+    void AddInt(double value, double precision, int size) {
+        int64_t na = (1ll << (8 * size - 1)) - 1;
+        int64_t raw = value / precision + (value < 0 ? -0.5 : 0.5);
+        AddRaw(N2kIsNA(value) ? na : raw, size);
+    }
+    void AddRaw(uint64_t raw, int size) {
+        for (int i = 0; i < size; i++) {
+            Data[DataLen++] = (raw >> (8 * i)) & 0xff;
+        }
+    }
+    double GetUInt(double precision, int size, int& index) const {
+        uint64_t raw = GetRaw(size, index);
+        return raw == (1ull << (8 * size)) - 1 ? N2kDoubleNA : raw * precision;
+    }
+    double GetInt(double precision, int size, int& index) const {
+        int64_t raw = GetRaw(size, index);
+        raw = (raw ^ (1ll << (8 * size - 1))) - (1ll << (8 * size - 1));
+        return raw == (1ll << (8 * size - 1)) - 1 ? N2kDoubleNA : raw * precision;
+    }
+    uint64_t GetRaw(int size, int& index) const {
+        uint64_t raw = 0;
+        for (int i = 0; i < size; i++) {
+            raw |= (uint64_t)Data[index++] << (8 * i);
+        }
+        return raw;
+    }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __NATIVE_FAKES_N2KTYPES_H__
+#define __NATIVE_FAKES_N2KTYPES_H__
+
+#include <stdint.h>
+
+#define N2kDoubleNA -1e9
+#define N2kFloatNA -1e9
+#define N2kInt8NA 127
+
+inline bool N2kIsNA(double value) { return value == N2kDoubleNA; }
+
+enum tN2kFluidType {
+    N2kft_Fuel = 0,
+    N2kft_Water = 1,
+    N2kft_GrayWater = 2,
+    N2kft_LiveWell = 3,
+    N2kft_Oil = 4,
+    N2kft_BlackWater = 5,
+};
+
+enum tN2kTempSource {
+    N2kts_SeaTemperature = 0,
+    N2kts_OutsideTemperature = 1,
+    N2kts_InsideTemperature = 2,
+    N2kts_EngineRoomTemperature = 3,
+    N2kts_MainCabinTemperature = 4,
+    N2kts_LiveWellTemperature = 5,
+    N2kts_BaitWellTemperature = 6,
+    N2kts_RefridgerationTemperature = 7,
+    N2kts_HeatingSystemTemperature = 8,
+    N2kts_DewPointTemperature = 9,
+    N2kts_ApparentWindChillTemperature = 10,
+    N2kts_TheoreticalWindChillTemperature = 11,
+    N2kts_HeatIndexTemperature = 12,
+    N2kts_FreezerTemperature = 13,
+    N2kts_ExhaustGasTemperature = 14,
+};
+
+union tN2kEngineDiscreteStatus1 {
+    uint16_t Status;
+    struct {
+        uint16_t CheckEngine : 1;
+        uint16_t OverTemperature : 1;
+        uint16_t LowOilPressure : 1;
+        uint16_t LowOilLevel : 1;
+        uint16_t LowFuelPressure : 1;
+        uint16_t LowSystemVoltage : 1;
+        uint16_t LowCoolantLevel : 1;
+        uint16_t WaterFlow : 1;
+        uint16_t WaterInFuel : 1;
+        uint16_t ChargeIndicator : 1;
+        uint16_t PreheatIndicator : 1;
+        uint16_t HighBoostPressure : 1;
+        uint16_t RevLimitExceeded : 1;
+        uint16_t EGRSystem : 1;
+        uint16_t ThrottlePositionSensor : 1;
+        uint16_t EngineEmergencyStopMode : 1;
+    } Bits;
+    tN2kEngineDiscreteStatus1(uint16_t status = 0) : Status{status} {}
+};
+
+union tN2kEngineDiscreteStatus2 {
+    uint16_t Status;
+    struct {
+        uint16_t WarningLevel1 : 1;
+        uint16_t WarningLevel2 : 1;
+        uint16_t LowOiPowerReduction : 1;
+        uint16_t MaintenanceNeeded : 1;
+        uint16_t EngineCommError : 1;
+        uint16_t SubOrSecondaryThrottle : 1;
+        uint16_t NeutralStartProtect : 1;
+        uint16_t EngineShuttingDown : 1;
+        uint16_t Manufacturer1 : 1;
+        uint16_t Manufacturer2 : 1;
+        uint16_t Manufacturer3 : 1;
+        uint16_t Manufacturer4 : 1;
+        uint16_t Manufacturer5 : 1;
+        uint16_t Manufacturer6 : 1;
+        uint16_t Manufacturer7 : 1;
+        uint16_t Manufacturer8 : 1;
+    } Bits;
+    tN2kEngineDiscreteStatus2(uint16_t status = 0) : Status{status} {}
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __NATIVE_FAKES_NMEA2000_H__
+#define __NATIVE_FAKES_NMEA2000_H__
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "N2kMsg.h"
+
+/**
+ * @brief NMEA 2000 stack with the NMEA2000 library's API, on the fake bus
+ *
+ * SendMsg() puts the message on fakes::can_bus() right away; messages
+ * received on the bus are handed to the message handlers by
+ * ParseMessages(), like the real stack does.
+ */
+class tNMEA2000 {
+   public:
+    typedef enum {
+        N2km_ListenOnly,
+        N2km_NodeOnly,
+        N2km_ListenAndNode,
+        N2km_SendOnly,
+        N2km_ListenAndSend
+    } tN2kMode;
+
+    class tMsgHandler {
+       public:
+        tMsgHandler(unsigned long pgn = 0, tNMEA2000* nmea2000 = nullptr) : pgn_{pgn} {}
+        virtual ~tMsgHandler() {}
+        virtual void HandleMsg(const tN2kMsg& N2kMsg) = 0;
+        // 0 for every PGN
+        unsigned long GetPGN() const { return pgn_; }
+
+       private:
+        unsigned long pgn_;
+    };
+
+    virtual ~tNMEA2000() {}
+
+    void SetN2kCANSendFrameBufSize(uint16_t size) {}
+    void SetN2kCANReceiveFrameBufSize(uint16_t size) {}
+    void SetProductInformation(const char* ModelSerialCode, unsigned short ProductCode, const char* ModelID,
+                               const char* SwCode, const char* ModelVersion) {}
+    void SetDeviceInformation(unsigned long UniqueNumber, unsigned char DeviceFunction, unsigned char DeviceClass,
+                              uint16_t ManufacturerCode) {}
+    void SetMode(tN2kMode mode, unsigned long N2kSource = 15) { source_ = N2kSource; }
+    void EnableForward(bool state = true) {}
+    void AttachMsgHandler(tMsgHandler* handler) { handlers_.push_back(handler); }
+    bool Open() { return true; }
+    void ParseMessages();
+    bool SendMsg(const tN2kMsg& N2kMsg, int DeviceIndex = -1);
+
+   private:
+    std::vector<tMsgHandler*> handlers_;
+    unsigned char source_ = 15;
+};
+
+#endif
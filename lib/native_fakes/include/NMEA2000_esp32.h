@@ -0,0 +1,23 @@
+#ifndef __NATIVE_FAKES_NMEA2000_ESP32_H__
+#define __NATIVE_FAKES_NMEA2000_ESP32_H__
+
+#include "Arduino.h"
+#include "NMEA2000.h"
+#include "fakes/can_bus.h"
+
+class tNMEA2000_esp32 : public tNMEA2000 {
+   public:
+    tNMEA2000_esp32(gpio_num_t tx_pin = GPIO_NUM_16, gpio_num_t rx_pin = GPIO_NUM_4) {}
+
+   protected:
+    // Frames queued by the CAN interrupt, i.e. received on the fake bus but
+    // not parsed yet
+    struct RxQueueView {
+        bool isEmpty() { return fakes::can_bus().frames_pending() == 0; }
+    };
+
+    RxQueueView rx_queue_;
+    RxQueueView* RxQueue = &rx_queue_;
+};
+
+#endif
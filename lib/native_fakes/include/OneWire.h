@@ -0,0 +1,53 @@
+#ifndef __NATIVE_FAKES_ONEWIRE_H__
+#define __NATIVE_FAKES_ONEWIRE_H__
+
+#include <stdint.h>
+
+#include <functional>
+
+/**
+ * @brief 1-Wire bus of DS18B20s with the OneWire library's API
+ *
+ * Every reset, bit slot and search spends the virtual time it takes at
+ * standard speed. The DS18B20s answer Skip ROM, Match ROM, Convert T and
+ * the scratchpad commands; a conversion completes after the time of the
+ * sensor's resolution, and until then the scratchpad holds the previous
+ * temperature (85 C after power-on). The sensors are shared by every
+ * OneWire instance, as the firmware has a single bus.
+ */
+class OneWire {
+   public:
+    static const uint32_t RESET_US = 960;
+    static const uint32_t SLOT_US = 70;
+
+    OneWire(uint8_t pin) {}
+
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v, uint8_t power = 0);
+    uint8_t read();
+    void read_bytes(uint8_t* buf, uint16_t count);
+    void reset_search();
+    // Returns the sensors in the order they were added
+    bool search(uint8_t* newAddr, bool search_mode = true);
+
+    static uint8_t crc8(const uint8_t* addr, uint8_t len);
+
+    // Test side
+    // ROM address of a DS18B20 with the given serial number
+    static void ds18b20_rom(uint8_t serial, uint8_t rom[8]);
+    static void add_ds18b20(const uint8_t rom[8], std::function<float(uint64_t us)> celsius);
+    static void remove_devices();
+    // Virtual time spent on the bus, and complete searches, since reset_stats()
+    static uint64_t bus_us();
+    static uint32_t searches();
+    static void reset_stats();
+
+   private:
+    void slots(uint32_t count);
+
+    uint32_t search_index_ = 0;
+};
+
+#endif
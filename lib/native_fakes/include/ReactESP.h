@@ -0,0 +1,89 @@
+#ifndef __NATIVE_FAKES_REACTESP_H__
+#define __NATIVE_FAKES_REACTESP_H__
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+namespace reactesp {
+
+typedef std::function<void()> react_callback;
+
+class ReactESP;
+
+class Reaction {
+   public:
+    Reaction(react_callback callback) : callback_{callback} {}
+    virtual ~Reaction() {}
+    virtual void tick(ReactESP* app) = 0;
+
+   protected:
+    react_callback callback_;
+};
+
+class TimedReaction : public Reaction {
+   public:
+    TimedReaction(uint64_t interval_us, react_callback callback);
+    uint64_t trigger_time() const { return last_trigger_us_ + interval_us_; }
+
+   protected:
+    uint64_t interval_us_;
+    uint64_t last_trigger_us_;
+};
+
+// Runs once and deletes itself
+class DelayReaction : public TimedReaction {
+   public:
+    using TimedReaction::TimedReaction;
+    void tick(ReactESP* app) override;
+};
+
+// Runs every interval, counted from the last run
+class RepeatReaction : public TimedReaction {
+   public:
+    using TimedReaction::TimedReaction;
+    void tick(ReactESP* app) override;
+};
+
+class TickReaction : public Reaction {
+   public:
+    using Reaction::Reaction;
+    void tick(ReactESP* app) override { callback_(); }
+};
+
+/**
+ * @brief ReactESP event loop driven by the virtual clock
+ *
+ * Same scheduling as ReactESP 2: tick reactions run on every tick, then the
+ * timed reactions that are due, earliest first.
+ */
+class ReactESP {
+   public:
+    ReactESP(bool singleton = true) {
+        if (singleton) {
+            app = this;
+        }
+    }
+
+    void tick();
+
+    DelayReaction* onDelay(uint32_t delay, react_callback callback);
+    DelayReaction* onDelayMicros(uint64_t delay, react_callback callback);
+    RepeatReaction* onRepeat(uint32_t interval, react_callback callback);
+    RepeatReaction* onRepeatMicros(uint64_t interval, react_callback callback);
+    TickReaction* onTick(react_callback callback);
+
+    static ReactESP* app;
+
+   private:
+    friend class RepeatReaction;
+
+    std::vector<TimedReaction*> timed_;
+    std::vector<TimedReaction*> due_;
+    std::vector<TickReaction*> ticks_;
+};
+
+}  // namespace reactesp
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef __NATIVE_FAKES_SPIFFS_H__
+#define __NATIVE_FAKES_SPIFFS_H__
+
+#include "FS.h"
+
+namespace fs {
+
+class SPIFFSFS : public FS {
+   public:
+    bool begin(bool format_on_fail = false) { return true; }
+};
+
+}  // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
+
+#endif
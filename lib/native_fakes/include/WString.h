@@ -0,0 +1,120 @@
+#ifndef __NATIVE_FAKES_WSTRING_H__
+#define __NATIVE_FAKES_WSTRING_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <string>
+
+/**
+ * @brief Arduino String on top of std::string
+ *
+ * Only the members used by the firmware and ArduinoJson are provided. As in
+ * the ESP32 core, numeric constructors are explicit, so only strings and
+ * string literals convert to a String implicitly.
+ */
+class String {
+   public:
+    String(const char* cstr = "") : value_{cstr == nullptr ? "" : cstr} {}
+    String(const std::string& value) : value_{value} {}
+    explicit String(char c) : value_(1, c) {}
+    explicit String(int value) : value_{std::to_string(value)} {}
+    explicit String(unsigned int value) : value_{std::to_string(value)} {}
+    explicit String(long value) : value_{std::to_string(value)} {}
+    explicit String(unsigned long value) : value_{std::to_string(value)} {}
+    explicit String(float value, unsigned int decimals = 2) : String((double)value, decimals) {}
+    explicit String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return value_.c_str(); }
+    unsigned int length() const { return value_.length(); }
+    char operator[](unsigned int index) const { return index < value_.length() ? value_[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    bool concat(const String& str) {
+        value_ += str.value_;
+        return true;
+    }
+    bool concat(const char* cstr) {
+        value_ += cstr;
+        return true;
+    }
+    bool concat(const char* cstr, unsigned int length) {
+        value_.append(cstr, length);
+        return true;
+    }
+    bool concat(char c) {
+        value_ += c;
+        return true;
+    }
+    String& operator+=(const String& rhs) {
+        concat(rhs);
+        return *this;
+    }
+    String& operator+=(const char* rhs) {
+        concat(rhs);
+        return *this;
+    }
+    String& operator+=(char rhs) {
+        concat(rhs);
+        return *this;
+    }
+
+    bool equals(const String& other) const { return value_ == other.value_; }
+    bool equals(const char* other) const { return value_ == other; }
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* rhs) const { return equals(rhs); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* rhs) const { return !equals(rhs); }
+    bool operator<(const String& rhs) const { return value_ < rhs.value_; }
+
+    bool startsWith(const String& prefix) const { return value_.compare(0, prefix.value_.length(), prefix.value_) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value_.length() >= suffix.value_.length() &&
+               value_.compare(value_.length() - suffix.value_.length(), suffix.value_.length(), suffix.value_) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t index = value_.find(c, from);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+    String substring(unsigned int from, unsigned int to = (unsigned int)-1) const {
+        if (from > value_.length()) {
+            return String();
+        }
+        return String(value_.substr(from, to == (unsigned int)-1 ? std::string::npos : to - from));
+    }
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+        if (index < value_.length()) {
+            value_.erase(index, count);
+        }
+    }
+    long toInt() const { return strtol(value_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(value_.c_str(), nullptr); }
+
+   private:
+    std::string value_;
+};
+
+inline String operator+(const String& lhs, const String& rhs) {
+    String result = lhs;
+    result.concat(rhs);
+    return result;
+}
+
+inline String operator+(const String& lhs, const char* rhs) {
+    String result = lhs;
+    result.concat(rhs);
+    return result;
+}
+
+inline String operator+(const char* lhs, const String& rhs) {
+    String result = lhs;
+    result.concat(rhs);
+    return result;
+}
+
+// Numbers are appended in decimal, as by the Arduino StringSumHelper
+inline String operator+(const String& lhs, unsigned long rhs) { return lhs + String(rhs); }
+
+inline bool operator==(const char* lhs, const String& rhs) { return rhs == lhs; }
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef __NATIVE_FAKES_ESP32_ROM_CRC_H__
+#define __NATIVE_FAKES_ESP32_ROM_CRC_H__
+
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3) of the ESP32 ROM, inverted on entry and exit like zlib
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef __NATIVE_FAKES_ESP_ERR_H__
+#define __NATIVE_FAKES_ESP_ERR_H__
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NOT_FOUND 0x105
+
+#endif
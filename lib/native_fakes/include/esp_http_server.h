@@ -0,0 +1,62 @@
+#ifndef __NATIVE_FAKES_ESP_HTTP_SERVER_H__
+#define __NATIVE_FAKES_ESP_HTTP_SERVER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include "esp_err.h"
+
+// In-process stand-in for the ESP-IDF HTTP server; requests are made with
+// fakes::http_get() and the response body is collected in the request
+
+typedef void* httpd_handle_t;
+
+typedef enum {
+    HTTP_GET = 1,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_404_NOT_FOUND = 404,
+    HTTPD_500_INTERNAL_SERVER_ERROR = 500,
+} httpd_err_code_t;
+
+#define HTTPD_RESP_USE_STRLEN -1
+
+struct httpd_req_t {
+    const char* uri;
+    void* user_ctx;
+    int status;
+    std::string content_type;
+    std::string body;
+    bool complete;
+};
+
+typedef struct {
+    const char* uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t* r);
+    void* user_ctx;
+} httpd_uri_t;
+
+typedef struct {
+    uint16_t server_port;
+    uint16_t ctrl_port;
+    uint16_t max_uri_handlers;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() \
+    httpd_config_t { 80, 32768, 8 }
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size);
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type);
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error, const char* msg);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef __NATIVE_FAKES_FAKES_CAN_BUS_H__
+#define __NATIVE_FAKES_FAKES_CAN_BUS_H__
+
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+#include "N2kMsg.h"
+
+namespace fakes {
+
+/**
+ * @brief NMEA 2000 bus at 250 kbit/s between the firmware and the test
+ *
+ * Records every message the firmware sends with the virtual time it was
+ * sent at, and the CAN frames and bits that took. Messages from other
+ * devices are injected with receive() and wait in the receive queue until
+ * the stack parses them.
+ */
+class CanBus {
+   public:
+    static const uint32_t BIT_RATE = 250000;
+    // Extended data frame with 8 data bytes, before bit stuffing
+    static const uint32_t BITS_PER_FRAME = 67 + 8 * 8;
+
+    struct Sent {
+        uint64_t time_us;
+        tN2kMsg msg;
+    };
+
+    // Single frame up to 8 bytes, fast packet above
+    static uint32_t frames(const tN2kMsg& msg) { return msg.DataLen <= 8 ? 1 : 1 + (msg.DataLen - 6 + 7 - 1) / 7; }
+
+    void send(const tN2kMsg& msg);
+    void receive(const tN2kMsg& msg);
+
+    const std::vector<Sent>& sent() { return sent_; }
+    uint32_t sent_count(unsigned long pgn);
+    uint64_t frames_sent() { return frames_sent_; }
+    // Share of the bus taken by the sent frames over `duration_us`
+    float bus_load(uint64_t duration_us) { return frames_sent_ * BITS_PER_FRAME * 1e6f / BIT_RATE / duration_us; }
+    uint32_t frames_pending();
+    bool next_received(tN2kMsg& msg);
+    uint32_t parse_calls() { return parse_calls_; }
+    void count_parse() { parse_calls_++; }
+    void clear();
+
+   private:
+    std::vector<Sent> sent_;
+    std::deque<tN2kMsg> received_;
+    uint64_t frames_sent_ = 0;
+    uint32_t parse_calls_ = 0;
+};
+
+CanBus& can_bus();
+
+}  // namespace fakes
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __NATIVE_FAKES_FAKES_CLOCK_H__
+#define __NATIVE_FAKES_FAKES_CLOCK_H__
+
+#include <stdint.h>
+
+/**
+ * @brief Virtual time behind millis(), micros() and the FreeRTOS tick
+ *
+ * Time starts at zero and only moves when a test advances it, or when a
+ * fake peripheral spends it (e.g. an I2C transaction), so runs are
+ * deterministic and simulated hours take milliseconds.
+ *
+ * Fake FreeRTOS tasks run in lockstep with the virtual time: a task blocked
+ * in vTaskDelay() is resumed by advance_us() once its delay is over, and
+ * advance_us() returns only after every resumed task is blocked again. Only
+ * one thread runs firmware code at any time.
+ *
+ * time() is the wall clock: 0 until set_wall_clock(), as before SNTP has
+ * set it, then it moves with the virtual time.
+ *
+ * use_real_time() switches to the host's monotonic clock instead, with
+ * tasks running freely on their own threads, for concurrency tests.
+ */
+namespace fakes {
+
+uint64_t now_us();
+
+// From the test thread: moves the time forward, running the tasks whose
+// delay expires on the way. From a task: spends `us` of the task's time.
+void advance_us(uint64_t us);
+inline void advance_ms(uint32_t ms) { advance_us(ms * 1000ull); }
+
+// Ticks ReactESP::app once per virtual ms for `ms` ms, like loop() does
+void run_ms(uint32_t ms);
+
+// Sets the wall clock to `epoch_s` seconds, as SNTP would
+void set_wall_clock(uint32_t epoch_s);
+
+void use_real_time();
+bool real_time();
+
+// Longest stretch of virtual time a task ran between two delays, i.e. how
+// long it kept its core without blocking (us). Reset by reset_task_stats().
+uint64_t max_task_busy_us();
+void reset_task_stats();
+
+// The tasks created so far stay blocked for good, as if deleted, so the
+// next test starts without the previous test's tasks. Test thread, lockstep
+// mode only.
+void retire_tasks();
+
+}  // namespace fakes
+
+#endif
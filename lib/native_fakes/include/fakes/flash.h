@@ -0,0 +1,45 @@
+#ifndef __NATIVE_FAKES_FAKES_FLASH_H__
+#define __NATIVE_FAKES_FAKES_FLASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Wear and power loss model behind the fake SPIFFS
+ *
+ * The partition is FLASH_BLOCKS erase blocks of FLASH_PAGES_PER_BLOCK
+ * pages, as in min_spiffs.csv. SPIFFS never rewrites a page in place: each
+ * write() programs a fresh page for every page of the file it touches, plus
+ * one for the file's index, and the pages they replace become obsolete.
+ * When no erased page is left, the block with the most obsolete pages is
+ * erased and its live pages are moved, which is what wears the flash out.
+ *
+ * cut_power_after() makes the flash lose power once that many more bytes
+ * are written, in the middle of a write() if it comes to that. Every file
+ * operation then fails until power_on(), i.e. the next boot.
+ */
+namespace fakes {
+
+static const size_t FLASH_PAGE_SIZE = 256;
+static const size_t FLASH_PAGES_PER_BLOCK = 16;
+static const size_t FLASH_BLOCKS = 48;
+
+struct FlashStats {
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+    uint64_t page_programs;
+    uint64_t block_erases;
+};
+
+// Erases the whole partition and clears the statistics
+void flash_format();
+FlashStats flash_stats();
+void reset_flash_stats();
+
+void cut_power_after(size_t bytes);
+void power_on();
+bool powered();
+
+}  // namespace fakes
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef __NATIVE_FAKES_FAKES_HEAP_H__
+#define __NATIVE_FAKES_FAKES_HEAP_H__
+
+#include <stdint.h>
+
+namespace fakes {
+
+// Number of operator new calls since the start of the program, on any thread
+uint64_t allocations();
+
+}  // namespace fakes
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef __NATIVE_FAKES_FAKES_HTTP_H__
+#define __NATIVE_FAKES_FAKES_HTTP_H__
+
+#include <string>
+
+namespace fakes {
+
+struct HttpResponse {
+    int status;
+    std::string content_type;
+    std::string body;
+};
+
+// Runs the handler registered for the path part of `url` on the calling
+// thread, as the HTTP server task would; 404 if there is none
+HttpResponse http_get(const std::string& url);
+
+}  // namespace fakes
+
+#endif
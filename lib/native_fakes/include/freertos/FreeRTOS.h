@@ -0,0 +1,39 @@
+#ifndef __NATIVE_FAKES_FREERTOS_FREERTOS_H__
+#define __NATIVE_FAKES_FREERTOS_FREERTOS_H__
+
+#include <stdint.h>
+
+#include <atomic>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+// One tick per ms, as configured for the ESP32 Arduino core
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+// Spinlock taken by portENTER_CRITICAL()
+typedef struct {
+    std::atomic<bool> locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {false}
+
+inline void vPortEnterCritical(portMUX_TYPE* mux) {
+    while (mux->locked.exchange(true, std::memory_order_acquire)) {
+    }
+}
+
+inline void vPortExitCritical(portMUX_TYPE* mux) { mux->locked.store(false, std::memory_order_release); }
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+
+#endif
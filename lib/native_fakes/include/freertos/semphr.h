@@ -0,0 +1,16 @@
+#ifndef __NATIVE_FAKES_FREERTOS_SEMPHR_H__
+#define __NATIVE_FAKES_FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+
+struct FakeSemaphore;
+typedef FakeSemaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+// `ticks` is either 0 (try) or portMAX_DELAY; other timeouts wait forever too
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __NATIVE_FAKES_FREERTOS_TASK_H__
+#define __NATIVE_FAKES_FREERTOS_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// Tasks are host threads, scheduled as described in fakes/clock.h; the
+// priority and core are ignored
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(function, name, stack_depth, parameters, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelay(TickType_t ticks);
+
+#define taskYIELD() vTaskDelay(0)
+
+#endif
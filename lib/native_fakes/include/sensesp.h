@@ -0,0 +1,22 @@
+#ifndef __NATIVE_FAKES_SENSESP_H__
+#define __NATIVE_FAKES_SENSESP_H__
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ReactESP.h>
+
+namespace sensesp {
+
+using namespace reactesp;
+
+// Warnings and errors are printed; set FAKES_LOG=1 to print everything
+void fake_log(char level, const char* format, ...);
+
+}  // namespace sensesp
+
+#define debugD(format, ...) sensesp::fake_log('D', format, ##__VA_ARGS__)
+#define debugI(format, ...) sensesp::fake_log('I', format, ##__VA_ARGS__)
+#define debugW(format, ...) sensesp::fake_log('W', format, ##__VA_ARGS__)
+#define debugE(format, ...) sensesp::fake_log('E', format, ##__VA_ARGS__)
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __NATIVE_FAKES_SENSESP_SENSORS_SENSOR_H__
+#define __NATIVE_FAKES_SENSESP_SENSORS_SENSOR_H__
+
+#include "sensesp/system/configurable.h"
+#include "sensesp/system/startable.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+class SensorConfig : public Configurable, public Startable {
+   public:
+    SensorConfig(String config_path) : Configurable(config_path), Startable(10) {}
+};
+
+template <typename T>
+class Sensor : public SensorConfig, public ValueProducer<T> {
+   public:
+    Sensor(String config_path) : SensorConfig(config_path) {}
+};
+
+typedef Sensor<float> FloatSensor;
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef __NATIVE_FAKES_SENSESP_SIGNALK_SIGNALK_OUTPUT_H__
+#define __NATIVE_FAKES_SENSESP_SIGNALK_SIGNALK_OUTPUT_H__
+
+#include <algorithm>
+#include <vector>
+
+#include "sensesp/system/configurable.h"
+#include "sensesp/system/valueconsumer.h"
+
+namespace sensesp {
+
+// Signal K output that keeps the last value and counts the deltas it would
+// send. The outputs are listed in all() for the tests.
+template <typename T>
+class SKOutputNumeric : public ValueConsumer<T>, public Configurable {
+   public:
+    SKOutputNumeric(String sk_path, String config_path = "", String units = "")
+        : Configurable(config_path),
+          sk_path_{sk_path},
+          units_{units} {
+        load_configuration();
+        all().push_back(this);
+    }
+    ~SKOutputNumeric() { all().erase(std::remove(all().begin(), all().end(), this), all().end()); }
+
+    void set_input(T new_value, uint8_t input_channel = 0) override {
+        value_ = new_value;
+        count_++;
+    }
+
+    void get_configuration(JsonObject& root) override { root["sk_path"] = sk_path_; }
+
+    bool set_configuration(const JsonObject& config) override {
+        if (!config.containsKey("sk_path")) {
+            return false;
+        }
+        sk_path_ = config["sk_path"].as<String>();
+        return true;
+    }
+
+    const String& sk_path() { return sk_path_; }
+    T value() { return value_; }
+    uint32_t count() { return count_; }
+
+    // Test side: every output created since forget_all()
+    static std::vector<SKOutputNumeric*>& all() {
+        static std::vector<SKOutputNumeric*> outputs;
+        return outputs;
+    }
+    static void forget_all() { all().clear(); }
+
+   private:
+    String sk_path_;
+    String units_;
+    T value_ = T();
+    uint32_t count_ = 0;
+};
+
+typedef SKOutputNumeric<float> SKOutputFloat;
+typedef SKOutputNumeric<String> SKOutputString;
+
+}  // namespace sensesp
+
+#endif
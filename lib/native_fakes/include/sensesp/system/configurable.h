@@ -0,0 +1,32 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_CONFIGURABLE_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_CONFIGURABLE_H__
+
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief SensESP 2 Configurable, stored in the fake SPIFFS
+ *
+ * Loads from "/" + Base64Sha1(config_path) or, failing that, from the
+ * config path itself, and saves to the former, like SensESP. Nothing is
+ * registered with a web UI.
+ */
+class Configurable {
+   public:
+    Configurable(String config_path = "", String description = "", int sort_order = 1000)
+        : config_path_{config_path} {}
+    virtual ~Configurable() {}
+
+    const String config_path_;
+
+    virtual void get_configuration(JsonObject& config) {}
+    virtual bool set_configuration(const JsonObject& config) { return false; }
+    virtual String get_config_schema() { return "{}"; }
+    virtual void load_configuration();
+    virtual void save_configuration();
+};
+
+}  // namespace sensesp
+
+#endif
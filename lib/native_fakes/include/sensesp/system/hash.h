@@ -0,0 +1,14 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_HASH_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_HASH_H__
+
+#include <Arduino.h>
+
+namespace sensesp {
+
+// Stands in for SensESP's base64 SHA-1: a short file name unique to `payload`
+// (a hex FNV-1a hash here, not the real digest)
+String Base64Sha1(String payload);
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_LAMBDA_CONSUMER_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_LAMBDA_CONSUMER_H__
+
+#include <functional>
+
+#include "sensesp/system/valueconsumer.h"
+
+namespace sensesp {
+
+template <typename IN>
+class LambdaConsumer : public ValueConsumer<IN> {
+   public:
+    LambdaConsumer(std::function<void(IN)> function) : function_{function} {}
+    void set_input(IN input, uint8_t input_channel = 0) override { function_(input); }
+
+   private:
+    std::function<void(IN)> function_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_OBSERVABLE_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_OBSERVABLE_H__
+
+#include <forward_list>
+#include <functional>
+
+namespace sensesp {
+
+class Observable {
+   public:
+    // Observers are called newest first, as in SensESP
+    void attach(std::function<void()> observer) { observers_.push_front(observer); }
+    void notify() {
+        for (auto& observer : observers_) {
+            observer();
+        }
+    }
+
+   private:
+    std::forward_list<std::function<void()>> observers_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_OBSERVABLEVALUE_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_OBSERVABLEVALUE_H__
+
+#include "sensesp/system/valueconsumer.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+template <typename T>
+class ObservableValue : public ValueConsumer<T>, public ValueProducer<T> {
+   public:
+    ObservableValue() {}
+    ObservableValue(const T& value) : ValueProducer<T>(value) {}
+
+    void set(const T& value) { this->emit(value); }
+    void set_input(T new_value, uint8_t input_channel = 0) override { this->emit(new_value); }
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_STARTABLE_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_STARTABLE_H__
+
+#include <algorithm>
+#include <vector>
+
+namespace sensesp {
+
+// Registered at construction, as in SensESP, for start_all(); tests may also
+// call start() themselves
+class Startable {
+   public:
+    Startable(int priority = 0) : priority_{priority} { startables().push_back(this); }
+    virtual ~Startable() {
+        auto& all = startables();
+        all.erase(std::remove(all.begin(), all.end(), this), all.end());
+    }
+    virtual void start() = 0;
+
+    // Starts the registered startables, highest priority first, as the app does
+    static void start_all() {
+        std::vector<Startable*> all = startables();
+        std::stable_sort(all.begin(), all.end(),
+                         [](Startable* a, Startable* b) { return a->priority_ > b->priority_; });
+        for (auto startable : all) {
+            startable->start();
+        }
+    }
+
+    // Test side: forgets the startables created so far, e.g. by a previous test
+    static void forget_all() { startables().clear(); }
+
+   private:
+    static std::vector<Startable*>& startables() {
+        static std::vector<Startable*> startables;
+        return startables;
+    }
+
+    int priority_;
+};
+
+}  // namespace sensesp
+
+#endif
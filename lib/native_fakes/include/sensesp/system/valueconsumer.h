@@ -0,0 +1,17 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_VALUECONSUMER_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_VALUECONSUMER_H__
+
+#include <stdint.h>
+
+namespace sensesp {
+
+template <typename T>
+class ValueConsumer {
+   public:
+    virtual ~ValueConsumer() {}
+    virtual void set_input(T new_value, uint8_t input_channel = 0) {}
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef __NATIVE_FAKES_SENSESP_SYSTEM_VALUEPRODUCER_H__
+#define __NATIVE_FAKES_SENSESP_SYSTEM_VALUEPRODUCER_H__
+
+#include "sensesp/system/observable.h"
+#include "sensesp/system/valueconsumer.h"
+
+namespace sensesp {
+
+template <typename C, typename P>
+class Transform;
+
+// SensESP 2 ValueProducer: connect_to() a transform returns that transform,
+// typed as a Transform, for chaining
+template <typename T>
+class ValueProducer : virtual public Observable {
+   public:
+    ValueProducer() {}
+    ValueProducer(const T& initial_value) : output(initial_value) {}
+
+    virtual const T& get() { return output; }
+
+    void connect_to(ValueConsumer<T>* consumer, uint8_t input_channel = 0) {
+        this->attach([this, consumer, input_channel]() { consumer->set_input(this->get(), input_channel); });
+    }
+
+    template <typename T2>
+    Transform<T, T2>* connect_to(Transform<T, T2>* consumer, uint8_t input_channel = 0) {
+        this->attach([this, consumer, input_channel]() { consumer->set_input(this->get(), input_channel); });
+        return consumer;
+    }
+
+    void emit(T new_value) {
+        this->output = new_value;
+        this->notify();
+    }
+
+   protected:
+    T output;
+};
+
+}  // namespace sensesp
+
+#endif
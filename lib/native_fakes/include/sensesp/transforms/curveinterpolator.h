@@ -0,0 +1,45 @@
+#ifndef __NATIVE_FAKES_SENSESP_TRANSFORMS_CURVEINTERPOLATOR_H__
+#define __NATIVE_FAKES_SENSESP_TRANSFORMS_CURVEINTERPOLATOR_H__
+
+#include <set>
+
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+// SensESP 2 CurveInterpolator, with the same set_input() walk over the
+// samples, as the reference for CompiledCurveInterpolator
+class CurveInterpolator : public FloatTransform {
+   public:
+    class Sample {
+       public:
+        float input;
+        float output;
+
+        Sample() {}
+        Sample(float input, float output) : input{input}, output{output} {}
+
+        friend bool operator<(const Sample& lhs, const Sample& rhs) { return lhs.input < rhs.input; }
+    };
+
+    CurveInterpolator(std::set<Sample>* defaults = NULL, String config_path = "");
+
+    virtual void set_input(float input, uint8_t inputChannel = 0) override;
+    virtual void get_configuration(JsonObject& doc) override;
+    virtual bool set_configuration(const JsonObject& config) override;
+    virtual String get_config_schema() override;
+
+    void clear_samples() { samples_.clear(); }
+    void add_sample(const Sample& new_sample) { samples_.insert(new_sample); }
+    void set_input_title(String input_title) { input_title_ = input_title; }
+    void set_output_title(String output_title) { output_title_ = output_title; }
+
+   protected:
+    std::set<Sample> samples_;
+    String input_title_ = "Input";
+    String output_title_ = "Output";
+};
+
+}  // namespace sensesp
+
+#endif
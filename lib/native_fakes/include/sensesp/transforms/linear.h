@@ -0,0 +1,40 @@
+#ifndef __NATIVE_FAKES_SENSESP_TRANSFORMS_LINEAR_H__
+#define __NATIVE_FAKES_SENSESP_TRANSFORMS_LINEAR_H__
+
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+class Linear : public FloatTransform {
+   public:
+    Linear(float multiplier, float offset, String config_path = "")
+        : FloatTransform(config_path),
+          multiplier_{multiplier},
+          offset_{offset} {
+        load_configuration();
+    }
+
+    void set_input(float input, uint8_t inputChannel = 0) override { this->emit(multiplier_ * input + offset_); }
+
+    void get_configuration(JsonObject& root) override {
+        root["multiplier"] = multiplier_;
+        root["offset"] = offset_;
+    }
+
+    bool set_configuration(const JsonObject& config) override {
+        if (!config.containsKey("multiplier") || !config.containsKey("offset")) {
+            return false;
+        }
+        multiplier_ = config["multiplier"];
+        offset_ = config["offset"];
+        return true;
+    }
+
+   private:
+    float multiplier_;
+    float offset_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef __NATIVE_FAKES_SENSESP_TRANSFORMS_MOVING_AVERAGE_H__
+#define __NATIVE_FAKES_SENSESP_TRANSFORMS_MOVING_AVERAGE_H__
+
+#include <vector>
+
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+// SensESP 2 MovingAverage: the window starts filled with the first input
+class MovingAverage : public FloatTransform {
+   public:
+    MovingAverage(int sample_size, float multiplier = 1.0, String config_path = "")
+        : FloatTransform(config_path),
+          sample_size_{sample_size},
+          multiplier_{multiplier} {
+        load_configuration();
+    }
+
+    void set_input(float input, uint8_t inputChannel = 0) override {
+        if (!initialized_) {
+            buffer_.assign(sample_size_, input);
+            output = input;
+            initialized_ = true;
+        } else {
+            output += -multiplier_ * buffer_[index_] / sample_size_;
+            output += multiplier_ * input / sample_size_;
+            buffer_[index_] = input;
+            index_ = (index_ + 1) % sample_size_;
+        }
+        notify();
+    }
+
+    void get_configuration(JsonObject& root) override {
+        root["multiplier"] = multiplier_;
+        root["sample_size"] = sample_size_;
+    }
+
+    bool set_configuration(const JsonObject& config) override {
+        if (!config.containsKey("multiplier") || !config.containsKey("sample_size")) {
+            return false;
+        }
+        multiplier_ = config["multiplier"];
+        sample_size_ = config["sample_size"];
+        initialized_ = false;
+        index_ = 0;
+        return true;
+    }
+
+   private:
+    int sample_size_;
+    float multiplier_;
+    std::vector<float> buffer_;
+    int index_ = 0;
+    bool initialized_ = false;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef __NATIVE_FAKES_SENSESP_TRANSFORMS_TRANSFORM_H__
+#define __NATIVE_FAKES_SENSESP_TRANSFORMS_TRANSFORM_H__
+
+#include "sensesp/system/configurable.h"
+#include "sensesp/system/valueconsumer.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+class TransformBase : public Configurable {
+   public:
+    TransformBase(String config_path = "") : Configurable(config_path) {}
+};
+
+template <typename C, typename P>
+class Transform : public TransformBase, public ValueConsumer<C>, public ValueProducer<P> {
+   public:
+    Transform(String config_path = "") : TransformBase(config_path) {}
+};
+
+template <typename T>
+class SymmetricTransform : public Transform<T, T> {
+   public:
+    SymmetricTransform(String config_path = "") : Transform<T, T>(config_path) {}
+};
+
+typedef SymmetricTransform<float> FloatTransform;
+
+}  // namespace sensesp
+
+#endif
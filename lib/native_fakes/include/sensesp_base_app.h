@@ -0,0 +1,16 @@
+#ifndef __NATIVE_FAKES_SENSESP_BASE_APP_H__
+#define __NATIVE_FAKES_SENSESP_BASE_APP_H__
+
+#include "WString.h"
+
+namespace sensesp {
+
+// Only the hostname, which names the Signal K paths of the diagnostics
+class SensESPBaseApp {
+   public:
+    static String get_hostname() { return "EngineMonitoring"; }
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,81 @@
+#include <math.h>
+
+#include "Adafruit_ADS1X15.h"
+#include "fakes/clock.h"
+
+static const uint16_t SPS_BY_DATA_RATE[] = {8, 16, 32, 64, 128, 250, 475, 860};
+
+bool Adafruit_ADS1115::begin(uint8_t i2c_addr, TwoWire* wire) {
+    transaction(READ_REGISTER_US);
+    return true;
+}
+
+void Adafruit_ADS1115::setDataRate(uint16_t rate) {
+    // The driver only keeps it for the next conversion
+    data_rate_ = rate;
+}
+
+int16_t Adafruit_ADS1115::readADC_SingleEnded(uint8_t channel) {
+    startADCReading(ADS1X15_REG_CONFIG_MUX_SINGLE_0 + (channel << 12), false);
+    while (!conversionComplete()) {
+    }
+    return getLastConversionResults();
+}
+
+void Adafruit_ADS1115::startADCReading(uint16_t mux, bool continuous) {
+    transaction(WRITE_REGISTER_US);
+    // A conversion still in progress is abandoned; a completed one stays
+    // in the conversion register until the new one completes
+    latch();
+    channel_ = (mux >> 12) & 0x03;
+    uint16_t sps = SPS_BY_DATA_RATE[(data_rate_ >> 5) & 0x07];
+    conversion_start_ = fakes::now_us();
+    conversion_end_ = conversion_start_ + (uint64_t)(1e6 / sps * (1 + clock_error_));
+}
+
+bool Adafruit_ADS1115::conversionComplete() {
+    transaction(READ_REGISTER_US);
+    return fakes::now_us() >= conversion_end_;
+}
+
+int16_t Adafruit_ADS1115::getLastConversionResults() {
+    transaction(READ_REGISTER_US);
+    latch();
+    return result_;
+}
+
+void Adafruit_ADS1115::latch() {
+    if (fakes::now_us() >= conversion_end_ && conversion_end_ > conversion_start_) {
+        // The delta-sigma converter averages over the conversion; take the
+        // input in the middle of it
+        float volts = inputs_[channel_] ? inputs_[channel_]((conversion_start_ + conversion_end_) / 2) : 0;
+        float counts = roundf(volts / full_scale() * 32768.0f);
+        result_ = counts > 32767 ? 32767 : counts < -32768 ? -32768 : (int16_t)counts;
+        conversion_start_ = conversion_end_;
+        conversions_++;
+    }
+}
+
+float Adafruit_ADS1115::computeVolts(int16_t counts) { return counts * full_scale() / 32768.0f; }
+
+void Adafruit_ADS1115::transaction(uint32_t us) {
+    transactions_++;
+    fakes::advance_us((uint64_t)us * 100000 / i2c_frequency_);
+}
+
+float Adafruit_ADS1115::full_scale() {
+    switch (gain_) {
+        case GAIN_TWOTHIRDS:
+            return 6.144f;
+        case GAIN_ONE:
+            return 4.096f;
+        case GAIN_TWO:
+            return 2.048f;
+        case GAIN_FOUR:
+            return 1.024f;
+        case GAIN_EIGHT:
+            return 0.512f;
+        default:
+            return 0.256f;
+    }
+}
@@ -0,0 +1,11 @@
+#include <Arduino.h>
+
+EspClass ESP;
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+String::String(double value, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    value_ = buffer;
+}
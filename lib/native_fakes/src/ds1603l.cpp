@@ -0,0 +1,37 @@
+#include "Arduino.h"
+#include "DS1603L.h"
+
+uint16_t DS1603L::readSensor() {
+    while (sensor_.available() > 0) {
+        uint8_t byte = sensor_.read();
+        if (length_ == 0 && byte != 0xFF) {
+            continue;
+        }
+        buffer_[length_++] = byte;
+        if (length_ < 4) {
+            continue;
+        }
+        length_ = 0;
+        uint16_t level = (buffer_[1] << 8) | buffer_[2];
+        if ((uint8_t)(buffer_[0] + buffer_[1] + buffer_[2]) == buffer_[3]) {
+            level_ = level;
+            status_ = DS1603L_READING_SUCCESS;
+            received_ = true;
+            last_valid_ = millis();
+        } else {
+            level_ = level;
+            status_ = DS1603L_READING_CHECKSUM_FAIL;
+        }
+    }
+    if (received_ && millis() - last_valid_ > TIMEOUT) {
+        status_ = DS1603L_NO_SENSOR_DETECTED;
+    }
+    return level_;
+}
+
+void DS1603L::frame(uint16_t level, uint8_t* buffer) {
+    buffer[0] = 0xFF;
+    buffer[1] = level >> 8;
+    buffer[2] = level & 0xFF;
+    buffer[3] = buffer[0] + buffer[1] + buffer[2];
+}
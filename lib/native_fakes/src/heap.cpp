@@ -0,0 +1,37 @@
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+#include "fakes/heap.h"
+
+// Counts every allocation, so tests can check that a pipeline doesn't
+// allocate per sample. Defined in the same object file as allocations(),
+// which makes sure the linker picks up these replacements.
+
+static std::atomic<uint64_t> allocation_count{0};
+
+void* operator new(size_t size) {
+    allocation_count++;
+    void* block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* block) noexcept { free(block); }
+
+void operator delete[](void* block) noexcept { free(block); }
+
+void operator delete(void* block, size_t size) noexcept { free(block); }
+
+void operator delete[](void* block, size_t size) noexcept { free(block); }
+
+namespace fakes {
+
+uint64_t allocations() { return allocation_count.load(); }
+
+}  // namespace fakes
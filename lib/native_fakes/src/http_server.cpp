@@ -0,0 +1,89 @@
+#include <string.h>
+
+#include <map>
+
+#include "esp_http_server.h"
+#include "fakes/http.h"
+
+namespace {
+
+std::map<std::string, httpd_uri_t> handlers;
+
+}  // namespace
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config) {
+    *handle = &handlers;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler) {
+    handlers[uri_handler->uri] = *uri_handler;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len) {
+    const char* query = strchr(r->uri, '?');
+    if (query == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    snprintf(buf, buf_len, "%s", query + 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size) {
+    size_t key_length = strlen(key);
+    const char* pair = qry;
+    while (pair != nullptr && *pair != '\0') {
+        const char* end = strchr(pair, '&');
+        size_t length = end == nullptr ? strlen(pair) : end - pair;
+        if (length > key_length && strncmp(pair, key, key_length) == 0 && pair[key_length] == '=') {
+            snprintf(val, val_size, "%.*s", (int)(length - key_length - 1), pair + key_length + 1);
+            return ESP_OK;
+        }
+        pair = end == nullptr ? nullptr : end + 1;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type) {
+    r->content_type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    if (buf == nullptr) {
+        r->complete = true;
+        return ESP_OK;
+    }
+    r->body.append(buf, buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : buf_len);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len) {
+    httpd_resp_send_chunk(r, buf, buf_len);
+    return httpd_resp_send_chunk(r, nullptr, 0);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error, const char* msg) {
+    req->status = error;
+    req->body = msg;
+    req->complete = true;
+    return ESP_FAIL;
+}
+
+namespace fakes {
+
+HttpResponse http_get(const std::string& url) {
+    auto handler = handlers.find(url.substr(0, url.find('?')));
+    if (handler == handlers.end()) {
+        return {404, "text/plain", "Not found"};
+    }
+    httpd_req_t req = {url.c_str(), handler->second.user_ctx, 200, "text/html", "", false};
+    handler->second.handler(&req);
+    if (!req.complete) {
+        return {500, "text/plain", "Response not finished"};
+    }
+    return {req.status, req.content_type, req.body};
+}
+
+}  // namespace fakes
@@ -0,0 +1,230 @@
+#include "N2kMessages.h"
+#include "NMEA2000.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+
+void SetN2kPGN127488(tN2kMsg& N2kMsg, unsigned char EngineInstance, double EngineSpeed, double EngineBoostPressure,
+                     int8_t EngineTiltTrim) {
+    N2kMsg.SetPGN(127488L);
+    N2kMsg.Priority = 2;
+    N2kMsg.AddByte(EngineInstance);
+    N2kMsg.Add2ByteUDouble(EngineSpeed, 0.25);
+    N2kMsg.Add2ByteUDouble(EngineBoostPressure, 100);
+    N2kMsg.AddByte(EngineTiltTrim);
+    N2kMsg.AddByte(0xff);
+    N2kMsg.AddByte(0xff);
+}
+
+void SetN2kPGN127489(tN2kMsg& N2kMsg, unsigned char EngineInstance, double EngineOilPress, double EngineOilTemp,
+                     double EngineCoolantTemp, double AltenatorVoltage, double FuelRate, double EngineHours,
+                     double EngineCoolantPress, double EngineFuelPress, int8_t EngineLoad, int8_t EngineTorque,
+                     tN2kEngineDiscreteStatus1 Status1, tN2kEngineDiscreteStatus2 Status2) {
+    N2kMsg.SetPGN(127489L);
+    N2kMsg.Priority = 2;
+    N2kMsg.AddByte(EngineInstance);
+    N2kMsg.Add2ByteUDouble(EngineOilPress, 100);
+    N2kMsg.Add2ByteUDouble(EngineOilTemp, 0.1);
+    N2kMsg.Add2ByteUDouble(EngineCoolantTemp, 0.01);
+    N2kMsg.Add2ByteDouble(AltenatorVoltage, 0.01);
+    N2kMsg.Add2ByteDouble(FuelRate, 0.1);
+    N2kMsg.Add4ByteUDouble(EngineHours, 1);
+    N2kMsg.Add2ByteUDouble(EngineCoolantPress, 100);
+    N2kMsg.Add2ByteUDouble(EngineFuelPress, 1000);
+    N2kMsg.AddByte(0xff);
+    N2kMsg.Add2ByteUInt(Status1.Status);
+    N2kMsg.Add2ByteUInt(Status2.Status);
+    N2kMsg.AddByte(EngineLoad);
+    N2kMsg.AddByte(EngineTorque);
+}
+
+bool ParseN2kPGN127489(const tN2kMsg& N2kMsg, unsigned char& EngineInstance, double& EngineOilPress,
+                       double& EngineOilTemp, double& EngineCoolantTemp, double& AltenatorVoltage, double& FuelRate,
+                       double& EngineHours, double& EngineCoolantPress, double& EngineFuelPress, int8_t& EngineLoad,
+                       int8_t& EngineTorque, tN2kEngineDiscreteStatus1& Status1, tN2kEngineDiscreteStatus2& Status2) {
+    if (N2kMsg.PGN != 127489L) {
+        return false;
+    }
+    int index = 0;
+    EngineInstance = N2kMsg.GetByte(index);
+    EngineOilPress = N2kMsg.Get2ByteUDouble(100, index);
+    EngineOilTemp = N2kMsg.Get2ByteUDouble(0.1, index);
+    EngineCoolantTemp = N2kMsg.Get2ByteUDouble(0.01, index);
+    AltenatorVoltage = N2kMsg.Get2ByteDouble(0.01, index);
+    FuelRate = N2kMsg.Get2ByteDouble(0.1, index);
+    EngineHours = N2kMsg.Get4ByteUDouble(1, index);
+    EngineCoolantPress = N2kMsg.Get2ByteUDouble(100, index);
+    EngineFuelPress = N2kMsg.Get2ByteUDouble(1000, index);
+    N2kMsg.GetByte(index);
+    Status1 = N2kMsg.Get2ByteUInt(index);
+    Status2 = N2kMsg.Get2ByteUInt(index);
+    EngineLoad = N2kMsg.GetByte(index);
+    EngineTorque = N2kMsg.GetByte(index);
+    return true;
+}
+
+void SetN2kPGN127505(tN2kMsg& N2kMsg, unsigned char Instance, tN2kFluidType FluidType, double Level,
+                     double Capacity) {
+    N2kMsg.SetPGN(127505L);
+    N2kMsg.Priority = 6;
+    N2kMsg.AddByte((Instance & 0x0f) | ((FluidType & 0x0f) << 4));
+    N2kMsg.Add2ByteDouble(Level, 0.004);
+    N2kMsg.Add4ByteUDouble(Capacity, 0.1);
+    N2kMsg.AddByte(0xff);
+}
+
+bool ParseN2kPGN127505(const tN2kMsg& N2kMsg, unsigned char& Instance, tN2kFluidType& FluidType, double& Level,
+                       double& Capacity) {
+    if (N2kMsg.PGN != 127505L) {
+        return false;
+    }
+    int index = 0;
+    unsigned char instance_type = N2kMsg.GetByte(index);
+    Instance = instance_type & 0x0f;
+    FluidType = (tN2kFluidType)(instance_type >> 4);
+    Level = N2kMsg.Get2ByteDouble(0.004, index);
+    Capacity = N2kMsg.Get4ByteUDouble(0.1, index);
+    return true;
+}
+
+void SetN2kPGN127508(tN2kMsg& N2kMsg, unsigned char BatteryInstance, double BatteryVoltage, double BatteryCurrent,
+                     double BatteryTemperature, unsigned char SID) {
+    N2kMsg.SetPGN(127508L);
+    N2kMsg.Priority = 6;
+    N2kMsg.AddByte(BatteryInstance);
+    N2kMsg.Add2ByteDouble(BatteryVoltage, 0.01);
+    N2kMsg.Add2ByteDouble(BatteryCurrent, 0.1);
+    N2kMsg.Add2ByteUDouble(BatteryTemperature, 0.01);
+    N2kMsg.AddByte(SID);
+}
+
+bool ParseN2kPGN127508(const tN2kMsg& N2kMsg, unsigned char& BatteryInstance, double& BatteryVoltage,
+                       double& BatteryCurrent, double& BatteryTemperature, unsigned char& SID) {
+    if (N2kMsg.PGN != 127508L) {
+        return false;
+    }
+    int index = 0;
+    BatteryInstance = N2kMsg.GetByte(index);
+    BatteryVoltage = N2kMsg.Get2ByteDouble(0.01, index);
+    BatteryCurrent = N2kMsg.Get2ByteDouble(0.1, index);
+    BatteryTemperature = N2kMsg.Get2ByteUDouble(0.01, index);
+    SID = N2kMsg.GetByte(index);
+    return true;
+}
+
+void SetN2kPGN130312(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+                     double ActualTemperature, double SetTemperature) {
+    N2kMsg.SetPGN(130312L);
+    N2kMsg.Priority = 5;
+    N2kMsg.AddByte(SID);
+    N2kMsg.AddByte(TempInstance);
+    N2kMsg.AddByte(TempSource);
+    N2kMsg.Add2ByteUDouble(ActualTemperature, 0.01);
+    N2kMsg.Add2ByteUDouble(SetTemperature, 0.01);
+    N2kMsg.AddByte(0xff);
+}
+
+bool ParseN2kPGN130312(const tN2kMsg& N2kMsg, unsigned char& SID, unsigned char& TempInstance,
+                       tN2kTempSource& TempSource, double& ActualTemperature, double& SetTemperature) {
+    if (N2kMsg.PGN != 130312L) {
+        return false;
+    }
+    int index = 0;
+    SID = N2kMsg.GetByte(index);
+    TempInstance = N2kMsg.GetByte(index);
+    TempSource = (tN2kTempSource)N2kMsg.GetByte(index);
+    ActualTemperature = N2kMsg.Get2ByteUDouble(0.01, index);
+    SetTemperature = N2kMsg.Get2ByteUDouble(0.01, index);
+    return true;
+}
+
+void SetN2kPGN130316(tN2kMsg& N2kMsg, unsigned char SID, unsigned char TempInstance, tN2kTempSource TempSource,
+                     double ActualTemperature, double SetTemperature) {
+    N2kMsg.SetPGN(130316L);
+    N2kMsg.Priority = 5;
+    N2kMsg.AddByte(SID);
+    N2kMsg.AddByte(TempInstance);
+    N2kMsg.AddByte(TempSource);
+    N2kMsg.Add3ByteUDouble(ActualTemperature, 0.001);
+    N2kMsg.Add2ByteUDouble(SetTemperature, 0.1);
+}
+
+bool ParseN2kPGN130316(const tN2kMsg& N2kMsg, unsigned char& SID, unsigned char& TempInstance,
+                       tN2kTempSource& TempSource, double& ActualTemperature, double& SetTemperature) {
+    if (N2kMsg.PGN != 130316L) {
+        return false;
+    }
+    int index = 0;
+    SID = N2kMsg.GetByte(index);
+    TempInstance = N2kMsg.GetByte(index);
+    TempSource = (tN2kTempSource)N2kMsg.GetByte(index);
+    ActualTemperature = N2kMsg.Get3ByteUDouble(0.001, index);
+    SetTemperature = N2kMsg.Get2ByteUDouble(0.1, index);
+    return true;
+}
+
+void tNMEA2000::ParseMessages() {
+    fakes::can_bus().count_parse();
+    tN2kMsg msg;
+    while (fakes::can_bus().next_received(msg)) {
+        for (tMsgHandler* handler : handlers_) {
+            if (handler->GetPGN() == 0 || handler->GetPGN() == msg.PGN) {
+                handler->HandleMsg(msg);
+            }
+        }
+    }
+}
+
+bool tNMEA2000::SendMsg(const tN2kMsg& N2kMsg, int DeviceIndex) {
+    tN2kMsg msg = N2kMsg;
+    msg.Source = source_;
+    fakes::can_bus().send(msg);
+    return true;
+}
+
+namespace fakes {
+
+void CanBus::send(const tN2kMsg& msg) {
+    sent_.push_back({now_us(), msg});
+    frames_sent_ += frames(msg);
+}
+
+void CanBus::receive(const tN2kMsg& msg) { received_.push_back(msg); }
+
+uint32_t CanBus::sent_count(unsigned long pgn) {
+    uint32_t count = 0;
+    for (auto& sent : sent_) {
+        count += sent.msg.PGN == pgn;
+    }
+    return count;
+}
+
+uint32_t CanBus::frames_pending() {
+    uint32_t count = 0;
+    for (auto& msg : received_) {
+        count += frames(msg);
+    }
+    return count;
+}
+
+bool CanBus::next_received(tN2kMsg& msg) {
+    if (received_.empty()) {
+        return false;
+    }
+    msg = received_.front();
+    received_.pop_front();
+    return true;
+}
+
+void CanBus::clear() {
+    sent_.clear();
+    received_.clear();
+    frames_sent_ = 0;
+    parse_calls_ = 0;
+}
+
+CanBus& can_bus() {
+    static CanBus* bus = new CanBus();
+    return *bus;
+}
+
+}  // namespace fakes
@@ -0,0 +1,238 @@
+#include <math.h>
+#include <string.h>
+
+#include <vector>
+
+#include "OneWire.h"
+#include "fakes/clock.h"
+
+namespace {
+
+const uint8_t SEARCH_ROM = 0xF0;
+const uint8_t MATCH_ROM = 0x55;
+const uint8_t SKIP_ROM = 0xCC;
+const uint8_t CONVERT_T = 0x44;
+const uint8_t WRITE_SCRATCHPAD = 0x4E;
+const uint8_t READ_SCRATCHPAD = 0xBE;
+
+// 85 C, the temperature register after power-on
+const int16_t POWER_ON_RAW = 0x0550;
+
+struct Ds18b20 {
+    uint8_t rom[8];
+    std::function<float(uint64_t)> celsius;
+    int16_t raw = POWER_ON_RAW;
+    uint8_t th = 0;
+    uint8_t tl = 0;
+    uint8_t config = 0x7F;  // 12 bits
+    bool converting = false;
+    uint64_t conversion_end = 0;
+    bool selected = false;
+
+    uint8_t resolution() { return ((config >> 5) & 0x03) + 9; }
+
+    void complete_conversion() {
+        if (!converting || fakes::now_us() < conversion_end) {
+            return;
+        }
+        converting = false;
+        raw = (int16_t)roundf(celsius(conversion_end) * 16);
+        // Bits below the resolution are undefined; keep them clear
+        raw &= ~((1 << (12 - resolution())) - 1);
+    }
+
+    void scratchpad(uint8_t* bytes) {
+        bytes[0] = raw & 0xFF;
+        bytes[1] = raw >> 8;
+        bytes[2] = th;
+        bytes[3] = tl;
+        bytes[4] = config;
+        bytes[5] = 0xFF;
+        bytes[6] = 0x0C;
+        bytes[7] = 0x10;
+        bytes[8] = OneWire::crc8(bytes, 8);
+    }
+};
+
+enum class State { kIdle, kRomCommand, kMatchRom, kFunction, kWriteScratchpad, kReadScratchpad };
+
+// The firmware has a single bus: the state lives here, not in the instances
+struct Bus {
+    std::vector<Ds18b20> devices;
+    State state = State::kIdle;
+    int index = 0;
+    uint8_t scratchpad[9];
+    uint64_t bus_us = 0;
+    uint32_t searches = 0;
+};
+
+Bus& bus() {
+    static Bus bus;
+    return bus;
+}
+
+void spend(uint32_t us) {
+    bus().bus_us += us;
+    fakes::advance_us(us);
+}
+
+}  // namespace
+
+uint8_t OneWire::reset() {
+    spend(RESET_US);
+    Bus& b = bus();
+    b.state = b.devices.empty() ? State::kIdle : State::kRomCommand;
+    for (auto& device : b.devices) {
+        device.selected = false;
+    }
+    return b.devices.empty() ? 0 : 1;
+}
+
+void OneWire::select(const uint8_t rom[8]) {
+    write(MATCH_ROM);
+    for (int i = 0; i < 8; i++) {
+        write(rom[i]);
+    }
+}
+
+void OneWire::skip() { write(SKIP_ROM); }
+
+void OneWire::write(uint8_t v, uint8_t power) {
+    slots(8);
+    Bus& b = bus();
+    switch (b.state) {
+        case State::kRomCommand:
+            if (v == SKIP_ROM) {
+                for (auto& device : b.devices) {
+                    device.selected = true;
+                }
+                b.state = State::kFunction;
+            } else if (v == MATCH_ROM) {
+                for (auto& device : b.devices) {
+                    device.selected = true;
+                }
+                b.index = 0;
+                b.state = State::kMatchRom;
+            } else {
+                b.state = State::kIdle;
+            }
+            break;
+        case State::kMatchRom:
+            for (auto& device : b.devices) {
+                device.selected = device.selected && device.rom[b.index] == v;
+            }
+            if (++b.index == 8) {
+                b.state = State::kFunction;
+            }
+            break;
+        case State::kFunction:
+            b.index = 0;
+            b.state = State::kIdle;
+            for (auto& device : b.devices) {
+                if (!device.selected) {
+                    continue;
+                }
+                device.complete_conversion();
+                if (v == CONVERT_T) {
+                    device.converting = true;
+                    device.conversion_end = fakes::now_us() + (750000 >> (12 - device.resolution()));
+                } else if (v == WRITE_SCRATCHPAD) {
+                    b.state = State::kWriteScratchpad;
+                } else if (v == READ_SCRATCHPAD && b.state != State::kReadScratchpad) {
+                    // With several sensors selected, the first one wins
+                    device.scratchpad(b.scratchpad);
+                    b.state = State::kReadScratchpad;
+                }
+            }
+            break;
+        case State::kWriteScratchpad:
+            for (auto& device : b.devices) {
+                if (device.selected) {
+                    uint8_t* registers[] = {&device.th, &device.tl, &device.config};
+                    *registers[b.index] = b.index == 2 ? (v & 0x60) | 0x1F : v;
+                }
+            }
+            if (++b.index == 3) {
+                b.state = State::kIdle;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+uint8_t OneWire::read() {
+    slots(8);
+    Bus& b = bus();
+    if (b.state != State::kReadScratchpad || b.index >= 9) {
+        return 0xFF;
+    }
+    return b.scratchpad[b.index++];
+}
+
+void OneWire::read_bytes(uint8_t* buf, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        buf[i] = read();
+    }
+}
+
+void OneWire::reset_search() { search_index_ = 0; }
+
+bool OneWire::search(uint8_t* newAddr, bool search_mode) {
+    Bus& b = bus();
+    if (search_index_ >= b.devices.size()) {
+        if (search_index_ == b.devices.size()) {
+            b.searches++;
+            search_index_++;
+        }
+        return false;
+    }
+    // Reset, search command, then two read slots and a write slot per ROM bit
+    reset();
+    slots(8 + 64 * 3);
+    b.state = State::kIdle;
+    memcpy(newAddr, b.devices[search_index_++].rom, 8);
+    return true;
+}
+
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t byte = *addr++;
+        for (int i = 0; i < 8; i++) {
+            uint8_t mix = (crc ^ byte) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
+
+void OneWire::ds18b20_rom(uint8_t serial, uint8_t rom[8]) {
+    uint8_t bytes[8] = {0x28, serial, 0x5A, 0x01, 0x00, 0x00, 0x00};
+    bytes[7] = crc8(bytes, 7);
+    memcpy(rom, bytes, 8);
+}
+
+void OneWire::add_ds18b20(const uint8_t rom[8], std::function<float(uint64_t us)> celsius) {
+    Ds18b20 device;
+    memcpy(device.rom, rom, 8);
+    device.celsius = celsius;
+    bus().devices.push_back(device);
+}
+
+void OneWire::remove_devices() { bus().devices.clear(); }
+
+uint64_t OneWire::bus_us() { return bus().bus_us; }
+
+uint32_t OneWire::searches() { return bus().searches; }
+
+void OneWire::reset_stats() {
+    bus().bus_us = 0;
+    bus().searches = 0;
+}
+
+void OneWire::slots(uint32_t count) { spend(count * SLOT_US); }
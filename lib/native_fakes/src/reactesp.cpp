@@ -0,0 +1,89 @@
+#include <ReactESP.h>
+
+#include <algorithm>
+
+#include "fakes/clock.h"
+
+namespace reactesp {
+
+ReactESP* ReactESP::app = nullptr;
+
+TimedReaction::TimedReaction(uint64_t interval_us, react_callback callback)
+    : Reaction(callback),
+      interval_us_{interval_us},
+      last_trigger_us_{fakes::now_us()} {}
+
+void DelayReaction::tick(ReactESP* app) {
+    callback_();
+    delete this;
+}
+
+void RepeatReaction::tick(ReactESP* app) {
+    last_trigger_us_ = fakes::now_us();
+    callback_();
+    app->timed_.push_back(this);
+}
+
+void ReactESP::tick() {
+    // Tick reactions may add more tick reactions
+    for (size_t i = 0; i < ticks_.size(); i++) {
+        ticks_[i]->tick(this);
+    }
+
+    // Only the reactions due now run, even if they reschedule at once
+    uint64_t now = fakes::now_us();
+    due_.clear();
+    for (size_t i = 0; i < timed_.size();) {
+        if (timed_[i]->trigger_time() <= now) {
+            due_.push_back(timed_[i]);
+            timed_[i] = timed_.back();
+            timed_.pop_back();
+        } else {
+            i++;
+        }
+    }
+    // Insertion sort: stable, and no temporary buffer to allocate
+    for (size_t i = 1; i < due_.size(); i++) {
+        for (size_t j = i; j > 0 && due_[j]->trigger_time() < due_[j - 1]->trigger_time(); j--) {
+            std::swap(due_[j], due_[j - 1]);
+        }
+    }
+    for (auto reaction : due_) {
+        reaction->tick(this);
+    }
+}
+
+DelayReaction* ReactESP::onDelay(uint32_t delay, react_callback callback) { return onDelayMicros(delay * 1000ull, callback); }
+
+DelayReaction* ReactESP::onDelayMicros(uint64_t delay, react_callback callback) {
+    auto reaction = new DelayReaction(delay, callback);
+    timed_.push_back(reaction);
+    return reaction;
+}
+
+RepeatReaction* ReactESP::onRepeat(uint32_t interval, react_callback callback) { return onRepeatMicros(interval * 1000ull, callback); }
+
+RepeatReaction* ReactESP::onRepeatMicros(uint64_t interval, react_callback callback) {
+    auto reaction = new RepeatReaction(interval, callback);
+    timed_.push_back(reaction);
+    return reaction;
+}
+
+TickReaction* ReactESP::onTick(react_callback callback) {
+    auto reaction = new TickReaction(callback);
+    ticks_.push_back(reaction);
+    return reaction;
+}
+
+}  // namespace reactesp
+
+namespace fakes {
+
+void run_ms(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        advance_ms(1);
+        reactesp::ReactESP::app->tick();
+    }
+}
+
+}  // namespace fakes
@@ -0,0 +1,237 @@
+#include <time.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fakes/clock.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+namespace {
+
+struct Task {
+    TaskFunction_t function;
+    void* parameters;
+    bool delayed;
+    uint64_t wake_us;
+    uint64_t resumed_us;
+};
+
+// Never destroyed: task threads may still be blocked on it at exit
+struct Scheduler {
+    std::mutex lock;
+    std::condition_variable changed;
+    std::atomic<uint64_t> virtual_us{0};
+    std::atomic<bool> real_time{false};
+    std::chrono::steady_clock::time_point real_start;
+    std::vector<Task*> tasks;
+    int running = 0;  // tasks not blocked in vTaskDelay()
+    uint64_t max_busy_us = 0;
+    bool wall_clock_set = false;
+    int64_t wall_clock_offset_us = 0;  // wall clock time at virtual time 0
+};
+
+Scheduler* scheduler() {
+    static Scheduler* scheduler = new Scheduler();
+    return scheduler;
+}
+
+thread_local Task* current_task = nullptr;
+
+void run_task(Task* task) {
+    current_task = task;
+    task->function(task->parameters);
+    // FreeRTOS tasks must not return, but don't hang the tests if one does
+    Scheduler* s = scheduler();
+    std::lock_guard<std::mutex> guard(s->lock);
+    if (!s->real_time) {
+        s->running--;
+    }
+    s->changed.notify_all();
+}
+
+void wait_for_tasks(Scheduler* s, std::unique_lock<std::mutex>& guard) {
+    s->changed.wait(guard, [s]() { return s->running == 0; });
+}
+
+}  // namespace
+
+namespace fakes {
+
+uint64_t now_us() {
+    Scheduler* s = scheduler();
+    if (s->real_time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s->real_start).count();
+    }
+    return s->virtual_us.load();
+}
+
+void advance_us(uint64_t us) {
+    Scheduler* s = scheduler();
+    if (s->real_time) {
+        // Real time passes on its own
+        return;
+    }
+    if (current_task != nullptr) {
+        s->virtual_us += us;
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(s->lock);
+    uint64_t target = s->virtual_us + us;
+    while (true) {
+        wait_for_tasks(s, guard);
+        // Resume the tasks in wake time order, each at its own wake time
+        Task* next = nullptr;
+        for (auto task : s->tasks) {
+            if (task->delayed && task->wake_us <= target && (next == nullptr || task->wake_us < next->wake_us)) {
+                next = task;
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+        if (next->wake_us > s->virtual_us) {
+            s->virtual_us = next->wake_us;
+        }
+        for (auto task : s->tasks) {
+            if (task->delayed && task->wake_us <= s->virtual_us) {
+                task->delayed = false;
+                task->resumed_us = s->virtual_us;
+                s->running++;
+            }
+        }
+        s->changed.notify_all();
+    }
+    if (s->virtual_us < target) {
+        s->virtual_us = target;
+    }
+}
+
+void set_wall_clock(uint32_t epoch_s) {
+    Scheduler* s = scheduler();
+    s->wall_clock_offset_us = epoch_s * 1000000ll - (int64_t)now_us();
+    s->wall_clock_set = true;
+}
+
+void use_real_time() {
+    Scheduler* s = scheduler();
+    std::lock_guard<std::mutex> guard(s->lock);
+    s->real_start = std::chrono::steady_clock::now() - std::chrono::microseconds(s->virtual_us.load());
+    s->real_time = true;
+    for (auto task : s->tasks) {
+        task->delayed = false;
+    }
+    s->changed.notify_all();
+}
+
+bool real_time() { return scheduler()->real_time; }
+
+uint64_t max_task_busy_us() {
+    Scheduler* s = scheduler();
+    std::lock_guard<std::mutex> guard(s->lock);
+    return s->max_busy_us;
+}
+
+void reset_task_stats() {
+    Scheduler* s = scheduler();
+    std::lock_guard<std::mutex> guard(s->lock);
+    s->max_busy_us = 0;
+}
+
+void retire_tasks() {
+    Scheduler* s = scheduler();
+    std::unique_lock<std::mutex> guard(s->lock);
+    wait_for_tasks(s, guard);
+    s->tasks.clear();
+    s->max_busy_us = 0;
+}
+
+}  // namespace fakes
+
+time_t time(time_t* t) noexcept {
+    Scheduler* s = scheduler();
+    time_t now = s->wall_clock_set ? (s->wall_clock_offset_us + (int64_t)fakes::now_us()) / 1000000 : 0;
+    if (t != nullptr) {
+        *t = now;
+    }
+    return now;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    Scheduler* s = scheduler();
+    Task* task = new Task{function, parameters, false, 0, 0};
+    std::unique_lock<std::mutex> guard(s->lock);
+    task->resumed_us = s->virtual_us;
+    s->tasks.push_back(task);
+    if (!s->real_time) {
+        s->running++;
+    }
+    std::thread(run_task, task).detach();
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    if (!s->real_time && current_task == nullptr) {
+        // The new task runs up to its first delay before the caller goes on
+        wait_for_tasks(s, guard);
+    }
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    Scheduler* s = scheduler();
+    if (s->real_time) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+        return;
+    }
+    Task* task = current_task;
+    if (task == nullptr) {
+        // Test thread: a delay is just time going by
+        fakes::advance_us(ticks * 1000ull);
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(s->lock);
+    uint64_t busy = s->virtual_us - task->resumed_us;
+    if (busy > s->max_busy_us) {
+        s->max_busy_us = busy;
+    }
+    task->wake_us = s->virtual_us + (ticks > 0 ? ticks * 1000ull : 1);
+    task->delayed = true;
+    s->running--;
+    s->changed.notify_all();
+    s->changed.wait(guard, [task]() { return !task->delayed; });
+}
+
+struct FakeSemaphore {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool available;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new FakeSemaphore{{}, {}, true}; }
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new FakeSemaphore{{}, {}, false}; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    std::unique_lock<std::mutex> guard(semaphore->mutex);
+    if (ticks == 0 && !semaphore->available) {
+        return pdFALSE;
+    }
+    semaphore->changed.wait(guard, [semaphore]() { return semaphore->available; });
+    semaphore->available = false;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    std::lock_guard<std::mutex> guard(semaphore->mutex);
+    semaphore->available = true;
+    semaphore->changed.notify_one();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
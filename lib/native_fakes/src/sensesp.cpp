@@ -0,0 +1,144 @@
+#include <SPIFFS.h>
+#include <stdarg.h>
+
+#include "sensesp.h"
+#include "sensesp/system/configurable.h"
+#include "sensesp/system/hash.h"
+#include "sensesp/transforms/curveinterpolator.h"
+
+namespace sensesp {
+
+void fake_log(char level, const char* format, ...) {
+    static bool verbose = getenv("FAKES_LOG") != nullptr;
+    if (!verbose && level != 'W' && level != 'E') {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "(%c) ", level);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+String Base64Sha1(String payload) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < payload.length(); i++) {
+        hash = (hash ^ (uint8_t)payload[i]) * 1099511628211ull;
+    }
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+    return String(name);
+}
+
+void Configurable::load_configuration() {
+    if (config_path_ == "") {
+        return;
+    }
+    String hash_path = "/" + Base64Sha1(config_path_);
+    String path;
+    if (SPIFFS.exists(hash_path)) {
+        path = hash_path;
+    } else if (SPIFFS.exists(config_path_)) {
+        path = config_path_;
+    } else {
+        return;
+    }
+
+    File file = SPIFFS.open(path, "r");
+    String json;
+    char buffer[64];
+    size_t length;
+    while ((length = file.read((uint8_t*)buffer, sizeof(buffer))) > 0) {
+        json.concat(buffer, length);
+    }
+    file.close();
+
+    DynamicJsonDocument doc(1024);
+    if (deserializeJson(doc, json)) {
+        debugW("Invalid configuration file %s", path.c_str());
+        return;
+    }
+    JsonObject config = doc.as<JsonObject>();
+    if (!set_configuration(config)) {
+        debugW("Could not apply the configuration of %s", config_path_.c_str());
+    }
+}
+
+void Configurable::save_configuration() {
+    if (config_path_ == "") {
+        return;
+    }
+    DynamicJsonDocument doc(1024);
+    JsonObject config = doc.to<JsonObject>();
+    get_configuration(config);
+    String json;
+    serializeJson(doc, json);
+    File file = SPIFFS.open("/" + Base64Sha1(config_path_), "w");
+    file.write((const uint8_t*)json.c_str(), json.length());
+    file.close();
+}
+
+CurveInterpolator::CurveInterpolator(std::set<Sample>* defaults, String config_path)
+    : FloatTransform(config_path) {
+    if (defaults != NULL) {
+        samples_ = *defaults;
+    }
+    load_configuration();
+}
+
+void CurveInterpolator::set_input(float input, uint8_t inputChannel) {
+    float x0 = 0.0;
+    float y0 = 0.0;
+
+    std::set<Sample>::iterator it = samples_.begin();
+    while (it != samples_.end()) {
+        auto& sample = *it;
+        if (input > sample.input) {
+            x0 = sample.input;
+            y0 = sample.output;
+            it++;
+        } else {
+            break;
+        }
+    }
+
+    if (it != samples_.end()) {
+        // Found the range: input is between x0 and it->input
+        const Sample& max = *it;
+        float x1 = max.input;
+        float y1 = max.output;
+        output = (y0 * (x1 - input) + y1 * (input - x0)) / (x1 - x0);
+    } else {
+        // Past the end of the table
+        output = 9999.9;
+    }
+    notify();
+}
+
+void CurveInterpolator::get_configuration(JsonObject& root) {
+    JsonArray json_samples = root.createNestedArray("samples");
+    for (auto& sample : samples_) {
+        JsonObject entry = json_samples.createNestedObject();
+        entry["input"] = sample.input;
+        entry["output"] = sample.output;
+    }
+}
+
+bool CurveInterpolator::set_configuration(const JsonObject& config) {
+    if (!config.containsKey("samples")) {
+        return false;
+    }
+    JsonArray arr = config["samples"];
+    if (arr.size() > 0) {
+        samples_.clear();
+        for (auto entry : arr) {
+            samples_.insert(Sample(entry["input"].as<float>(), entry["output"].as<float>()));
+        }
+    }
+    return true;
+}
+
+String CurveInterpolator::get_config_schema() { return "{}"; }
+
+}  // namespace sensesp
@@ -0,0 +1,206 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "SPIFFS.h"
+#include "fakes/flash.h"
+
+fs::SPIFFSFS SPIFFS;
+
+namespace fs {
+
+struct FileState {
+    std::vector<uint8_t> data;
+};
+
+}  // namespace fs
+
+namespace fakes {
+
+namespace {
+
+// SPIFFS object names are limited to 32 bytes including the terminator
+const size_t NAME_LIMIT = 31;
+const size_t TOTAL_PAGES = FLASH_BLOCKS * FLASH_PAGES_PER_BLOCK;
+
+std::map<std::string, std::shared_ptr<fs::FileState>> files;
+FlashStats stats = {};
+size_t erased_pages = TOTAL_PAGES;
+size_t obsolete_pages = 0;
+bool power = true;
+size_t power_budget = SIZE_MAX;
+
+size_t pages_of(size_t size) { return (size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE; }
+
+bool take_erased_page() {
+    if (erased_pages == 0) {
+        // Garbage collect the block with the most obsolete pages. With wear
+        // levelling the obsolete pages are spread evenly, so the victim
+        // holds its share of them and the rest has to be moved.
+        if (obsolete_pages == 0) {
+            return false;
+        }
+        size_t reclaimed =
+            (obsolete_pages * FLASH_PAGES_PER_BLOCK + TOTAL_PAGES - 1) / TOTAL_PAGES;
+        reclaimed = std::min(std::max(reclaimed, (size_t)1), obsolete_pages);
+        stats.block_erases++;
+        stats.page_programs += FLASH_PAGES_PER_BLOCK - reclaimed;
+        obsolete_pages -= reclaimed;
+        erased_pages += reclaimed;
+    }
+    erased_pages--;
+    stats.page_programs++;
+    return true;
+}
+
+// Programs `count` fresh pages that replace `replaced` live ones
+bool program(size_t count, size_t replaced) {
+    for (size_t i = 0; i < count; i++) {
+        if (!take_erased_page()) {
+            return false;
+        }
+    }
+    obsolete_pages += replaced;
+    return true;
+}
+
+}  // namespace
+
+void flash_format() {
+    files.clear();
+    stats = {};
+    erased_pages = TOTAL_PAGES;
+    obsolete_pages = 0;
+    power = true;
+    power_budget = SIZE_MAX;
+}
+
+FlashStats flash_stats() { return stats; }
+
+void reset_flash_stats() { stats = {}; }
+
+void cut_power_after(size_t bytes) { power_budget = bytes; }
+
+void power_on() {
+    power = true;
+    power_budget = SIZE_MAX;
+}
+
+bool powered() { return power; }
+
+}  // namespace fakes
+
+namespace fs {
+
+using namespace fakes;
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (state_ == nullptr || !power || position_ >= state_->data.size()) {
+        return 0;
+    }
+    size_t length = std::min(size, state_->data.size() - position_);
+    memcpy(buffer, state_->data.data() + position_, length);
+    position_ += length;
+    stats.bytes_read += length;
+    return length;
+}
+
+int File::read() {
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (state_ == nullptr || !writable_ || !power || size == 0) {
+        return 0;
+    }
+    size_t length = size;
+    if (length >= power_budget) {
+        length = power_budget;
+        power = false;
+    }
+    power_budget -= length;
+    if (length == 0) {
+        return 0;
+    }
+
+    std::vector<uint8_t>& data = state_->data;
+    size_t old_size = data.size();
+    size_t first_page = position_ / FLASH_PAGE_SIZE;
+    size_t end_page = pages_of(position_ + length);
+    size_t replaced = std::min(end_page, pages_of(old_size)) - std::min(first_page, pages_of(old_size));
+    // The touched data pages and the updated index page
+    if (!program(end_page - first_page + 1, replaced + 1)) {
+        return 0;
+    }
+
+    if (position_ + length > old_size) {
+        data.resize(position_ + length);
+    }
+    memcpy(data.data() + position_, buffer, length);
+    position_ += length;
+    stats.bytes_written += length;
+    return length;
+}
+
+bool File::seek(uint32_t position) {
+    if (state_ == nullptr || position > state_->data.size()) {
+        return false;
+    }
+    position_ = position;
+    return true;
+}
+
+size_t File::size() const { return state_ == nullptr ? 0 : state_->data.size(); }
+
+File FS::open(const char* path, const char* mode) {
+    if (!power) {
+        return File();
+    }
+    auto it = files.find(path);
+    bool write = strchr(mode, 'w') != nullptr || strchr(mode, 'a') != nullptr;
+    bool update = strchr(mode, '+') != nullptr;
+
+    if (it == files.end()) {
+        if (!write) {
+            return File();
+        }
+        if (strlen(path) > NAME_LIMIT) {
+            fprintf(stderr, "(W) SPIFFS name too long: %s\n", path);
+            return File();
+        }
+        // A new object needs its index page
+        if (!program(1, 0)) {
+            return File();
+        }
+        auto state = std::make_shared<FileState>();
+        files[path] = state;
+        return File(state, true, 0);
+    }
+
+    std::shared_ptr<FileState> state = it->second;
+    if (mode[0] == 'w') {
+        program(1, pages_of(state->data.size()) + 1);
+        state->data.clear();
+    }
+    size_t position = mode[0] == 'a' ? state->data.size() : 0;
+    return File(state, write || update, position);
+}
+
+bool FS::exists(const char* path) { return power && files.count(path) > 0; }
+
+bool FS::remove(const char* path) {
+    auto it = files.find(path);
+    if (!power || it == files.end()) {
+        return false;
+    }
+    obsolete_pages += pages_of(it->second->data.size()) + 1;
+    files.erase(it);
+    return true;
+}
+
+}  // namespace fs
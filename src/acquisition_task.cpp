@@ -0,0 +1,88 @@
+#include "acquisition_task.h"
+
+#include "reaction_profiler.h"
+
+namespace sensesp {
+
+// Interval between jitter reports on the debug log (ms)
+static const uint JITTER_REPORT_INTERVAL = 60000;
+
+AcquisitionTask::AcquisitionTask(BaseType_t core, UBaseType_t priority)
+    : core_{core},
+      priority_{priority} {}
+
+uint8_t AcquisitionTask::add_source(String name, uint interval, std::function<void(float)> consumer) {
+    sources_.push_back({name, interval, consumer, 0, 0, 0});
+    return sources_.size() - 1;
+}
+
+void AcquisitionTask::publish(uint8_t source, float value) {
+    uint32_t now = micros();
+
+    Source& stats = sources_[source];
+    if (stats.count > 0) {
+        // Deviation of the actual sample interval from the nominal one
+        int32_t jitter = abs((int32_t)(now - stats.last_timestamp) - (int32_t)stats.interval * 1000);
+        stats.max_jitter = max(stats.max_jitter, jitter);
+    }
+    stats.last_timestamp = now;
+    stats.count++;
+
+    if (!queue_.push({now, source, value})) {
+        dropped_++;
+    }
+}
+
+void AcquisitionTask::set_source_interval(uint8_t source, uint interval) {
+    sources_[source].interval = interval;
+    // Don't count the switch itself as jitter
+    sources_[source].count = 0;
+}
+
+void AcquisitionTask::post(std::function<void()> action) {
+    if (!actions_.push(action)) {
+        debugE("Acquisition action queue full");
+    }
+}
+
+void AcquisitionTask::start() {
+    reactor_.onRepeat(JITTER_REPORT_INTERVAL, [this]() { this->report_jitter(); });
+    reactor_.onTick([this]() {
+        std::function<void()> action;
+        while (actions_.pop(&action)) {
+            action();
+        }
+    });
+    xTaskCreatePinnedToCore(run, "acquisition", 4096, this, priority_, NULL, core_);
+    ReactESP::app->onTick(PROFILED("acquisition_drain", 0, [this]() { this->drain(); }));
+}
+
+void AcquisitionTask::run(void* task) {
+    auto acquisition = static_cast<AcquisitionTask*>(task);
+    while (true) {
+        acquisition->reactor_.tick();
+        vTaskDelay(1);
+    }
+}
+
+void AcquisitionTask::drain() {
+    Sample sample;
+    while (queue_.pop(&sample)) {
+        sample_timestamp_ = sample.timestamp;
+        sources_[sample.source].consumer(sample.value);
+    }
+}
+
+void AcquisitionTask::report_jitter() {
+    for (auto& source : sources_) {
+        debugI("Acquisition %s: %u samples, max jitter %d us", source.name.c_str(), source.count, source.max_jitter);
+        source.count = 0;
+        source.max_jitter = 0;
+    }
+    if (dropped_ > 0) {
+        debugW("Acquisition queue full, %u samples dropped", dropped_);
+        dropped_ = 0;
+    }
+}
+
+}  // namespace sensesp
@@ -0,0 +1,81 @@
+#ifndef __SRC_ACQUISITION_TASK_H__
+#define __SRC_ACQUISITION_TASK_H__
+
+#include <functional>
+#include <vector>
+
+#include "sample_queue.h"
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief Runs the sensor drivers in their own task, pinned to one core
+ *
+ * Drivers schedule their work on reactor(), which is ticked by the
+ * acquisition task instead of the main loop. Their results are published
+ * as timestamped samples through a lock-free queue and handed to the
+ * consumers (transforms, Nmea, Signal K output) from the main loop, so a
+ * slow network send can no longer delay sampling and the other way round.
+ *
+ * Drivers must register their reactions and sources before start().
+ */
+class AcquisitionTask {
+   public:
+    AcquisitionTask(BaseType_t core = 0, UBaseType_t priority = 5);
+
+    ReactESP* reactor() { return &reactor_; }
+
+    // Registers a sample source published every `interval` ms; `consumer`
+    // is called from the main loop with each published value
+    uint8_t add_source(String name, uint interval, std::function<void(float)> consumer);
+
+    // Acquisition task side: queues a value for the source's consumer
+    void publish(uint8_t source, float value);
+    // Acquisition task side: changes the nominal interval of a source
+    void set_source_interval(uint8_t source, uint interval);
+
+    // Main loop side: runs `action` in the acquisition task, e.g. to change
+    // the reactions of a driver once the task is running
+    void post(std::function<void()> action);
+
+    // Main loop side: micros() at which the sample being handed to a
+    // consumer was published, to measure the latency down the pipeline
+    uint32_t sample_timestamp() { return sample_timestamp_; }
+
+    void start();
+
+   private:
+    struct Sample {
+        uint32_t timestamp;  // micros() at publication
+        uint8_t source;
+        float value;
+    };
+
+    struct Source {
+        String name;
+        uint interval;
+        std::function<void(float)> consumer;
+        // Jitter statistics, updated by the acquisition task
+        uint32_t last_timestamp;
+        uint32_t count;
+        int32_t max_jitter;
+    };
+
+    static void run(void* task);
+    void drain();
+    void report_jitter();
+
+    BaseType_t core_;
+    UBaseType_t priority_;
+    ReactESP reactor_{false};
+    SampleQueue<Sample, 256> queue_;
+    SampleQueue<std::function<void()>, 16> actions_;
+    std::vector<Source> sources_;
+    uint32_t dropped_ = 0;
+    uint32_t sample_timestamp_ = 0;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef __SRC_ADC_CHANNEL_H__
+#define __SRC_ADC_CHANNEL_H__
+
+#include <Adafruit_ADS1X15.h>
+
+#include "configuration.h"
+
+namespace sensesp {
+
+// Full scale range in volts of the ADS1115 for each programmable gain
+constexpr float ads1115_full_scale(adsGain_t gain) {
+    return gain == GAIN_TWOTHIRDS ? 6.144f
+           : gain == GAIN_ONE     ? 4.096f
+           : gain == GAIN_TWO     ? 2.048f
+           : gain == GAIN_FOUR    ? 1.024f
+           : gain == GAIN_EIGHT   ? 0.512f
+                                  : 0.256f;
+}
+
+// Engine hat input divider: volts at the connector per volt at the ADS1115
+struct EngineHatInputScale {
+    static constexpr float factor = ADS1115INPUTSCALE;
+};
+
+// Output the voltage at the engine hat input
+struct VoltageConversion {
+    static constexpr float factor = 1.0f;
+};
+
+// Output the sender resistance, driven by the engine hat constant current source
+struct ResistanceConversion {
+    static constexpr float factor = 1.0f / ADS1115MEASUREMENTCURRENT;
+};
+
+/**
+ * @brief Compile-time conversion from raw ADS1115 counts to a physical value
+ *
+ * Gain, input scale and conversion factors are folded by the compiler into a
+ * single constant, so each sample costs one multiply.
+ */
+template <adsGain_t Gain, typename Scale, typename Conversion>
+struct AdcChannel {
+    static constexpr float counts_to_output = ads1115_full_scale(Gain) / 32768.0f * Scale::factor * Conversion::factor;
+
+    static float convert(float counts) { return counts * counts_to_output; }
+};
+
+using VoltageChannel = AdcChannel<ADS1115GAIN, EngineHatInputScale, VoltageConversion>;
+using ResistanceChannel = AdcChannel<ADS1115GAIN, EngineHatInputScale, ResistanceConversion>;
+
+}  // namespace sensesp
+
+#endif
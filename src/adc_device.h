@@ -0,0 +1,46 @@
+#ifndef __SRC_ADC_DEVICE_H__
+#define __SRC_ADC_DEVICE_H__
+
+#include <Adafruit_ADS1X15.h>
+
+namespace sensesp {
+
+// Minimal ADC interface used by Ads1115Scheduler, so it can drive either the
+// real chip or a fake one
+class AdcDevice {
+   public:
+    virtual ~AdcDevice() {}
+    virtual void set_data_rate(uint16_t data_rate) = 0;
+    // Starts a single-shot conversion
+    virtual void start_conversion(int channel) = 0;
+    virtual bool conversion_complete() = 0;
+    virtual int16_t last_conversion() = 0;
+};
+
+// AdcDevice backed by an Adafruit_ADS1115 on the I2C bus
+class Ads1115Device : public AdcDevice {
+   public:
+    Ads1115Device(Adafruit_ADS1115* ads1115) : ads1115_{ads1115} {}
+
+    void set_data_rate(uint16_t data_rate) override { ads1115_->setDataRate(data_rate); }
+
+    void start_conversion(int channel) override {
+        static const uint16_t MUX_BY_CHANNEL[] = {
+            ADS1X15_REG_CONFIG_MUX_SINGLE_0,
+            ADS1X15_REG_CONFIG_MUX_SINGLE_1,
+            ADS1X15_REG_CONFIG_MUX_SINGLE_2,
+            ADS1X15_REG_CONFIG_MUX_SINGLE_3,
+        };
+        ads1115_->startADCReading(MUX_BY_CHANNEL[channel], false);
+    }
+
+    bool conversion_complete() override { return ads1115_->conversionComplete(); }
+    int16_t last_conversion() override { return ads1115_->getLastConversionResults(); }
+
+   private:
+    Adafruit_ADS1115* ads1115_;
+};
+
+}  // namespace sensesp
+
+#endif
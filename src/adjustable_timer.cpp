@@ -0,0 +1,28 @@
+#include "adjustable_timer.h"
+
+namespace sensesp {
+
+void AdjustableTimer::start() {
+    due_ = millis() + period_;
+    reactor_->onTick([this]() { this->tick(); });
+}
+
+void AdjustableTimer::set_period(uint period) {
+    period_ = period;
+    due_ = millis();
+}
+
+void AdjustableTimer::tick() {
+    uint32_t now = millis();
+    if ((int32_t)(now - due_) < 0) {
+        return;
+    }
+    due_ += period_;
+    if ((int32_t)(now - due_) >= 0) {
+        // More than a period late: restart the schedule from now
+        due_ = now + period_;
+    }
+    callback_();
+}
+
+}  // namespace sensesp
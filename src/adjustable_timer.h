@@ -0,0 +1,43 @@
+#ifndef __SRC_ADJUSTABLE_TIMER_H__
+#define __SRC_ADJUSTABLE_TIMER_H__
+
+#include <functional>
+
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief Repeating timer whose period can be changed while it runs
+ *
+ * A single onTick reaction, created by start(), compares millis() with the
+ * next due time, so neither a period nor a period change allocates a new
+ * reaction. Periods missed while the task was busy are not caught up.
+ *
+ * All calls must come from the task ticking `reactor`.
+ */
+class AdjustableTimer {
+   public:
+    AdjustableTimer(ReactESP* reactor, uint period, std::function<void()> callback)
+        : reactor_{reactor},
+          period_{period},
+          callback_{callback} {}
+
+    // Runs the callback every period ms, the first time after one period
+    void start();
+    // Runs the callback now and then every `period` ms
+    void set_period(uint period);
+    uint period() { return period_; }
+
+   private:
+    void tick();
+
+    ReactESP* reactor_;
+    uint period_;
+    std::function<void()> callback_;
+    uint32_t due_;
+};
+
+}  // namespace sensesp
+
+#endif
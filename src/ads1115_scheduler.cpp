@@ -0,0 +1,137 @@
+#include "ads1115_scheduler.h"
+
+namespace sensesp {
+
+// Samples per second for each ADS1115 data rate setting (bits 7:5 of the config register)
+static const uint16_t SPS_BY_DATA_RATE[] = {8, 16, 32, 64, 128, 250, 475, 860};
+
+// Conversion time at 860 SPS, rounded up (us)
+static const uint32_t BURST_CONVERSION_US = 1000000 / 860 + 1;
+
+Ads1115Scheduler::Ads1115Scheduler(AdcDevice* ads1115, AcquisitionTask* acquisition, uint16_t data_rate)
+    : ads1115_{ads1115},
+      acquisition_{acquisition},
+      data_rate_{data_rate} {
+    ads1115_->set_data_rate(data_rate);
+    uint16_t sps = SPS_BY_DATA_RATE[(data_rate >> 5) & 0x07];
+    // Round the conversion time up and leave one extra ms of margin
+    conversion_delay_ = (1000 + sps - 1) / sps + 1;
+
+    // A single reaction polls for results, instead of one reaction per conversion
+    acquisition_->reactor()->onTick([this]() { this->poll(); });
+}
+
+size_t Ads1115Scheduler::add_channel(int channel, uint read_delay, std::function<void(float)> callback) {
+    uint8_t source = acquisition_->add_source("ADS1115 channel " + String(channel), read_delay, callback);
+    return add({channel, source, false, 0, nullptr, nullptr, nullptr}, read_delay);
+}
+
+size_t Ads1115Scheduler::add_burst_channel(int channel, uint read_delay, uint window,
+                                           std::function<void(int16_t)> sample, std::function<float()> window_done,
+                                           std::function<void(float)> callback) {
+    uint8_t source = acquisition_->add_source("ADS1115 burst channel " + String(channel), read_delay, callback);
+    return add({channel, source, false, window, sample, window_done, nullptr}, read_delay);
+}
+
+size_t Ads1115Scheduler::add(Channel channel, uint read_delay) {
+    size_t index = channels_.size();
+    channel.timer = new AdjustableTimer(acquisition_->reactor(), read_delay, [this, index]() { this->request(index); });
+    channel.timer->start();
+    channels_.push_back(channel);
+    return index;
+}
+
+void Ads1115Scheduler::set_period(size_t index, uint read_delay) {
+    acquisition_->post([this, index, read_delay]() {
+        Channel& channel = channels_[index];
+        acquisition_->set_source_interval(channel.source, read_delay);
+        channel.timer->set_period(read_delay);
+    });
+}
+
+void Ads1115Scheduler::request(size_t index) {
+    channels_[index].pending = true;
+    if (active_index_ < 0) {
+        start_next();
+    }
+}
+
+void Ads1115Scheduler::start_next() {
+    for (size_t i = 0; i < channels_.size(); i++) {
+        size_t index = (next_index_ + i) % channels_.size();
+        if (channels_[index].pending) {
+            channels_[index].pending = false;
+            active_index_ = index;
+            next_index_ = (index + 1) % channels_.size();
+            if (channels_[index].window > 0) {
+                start_burst(channels_[index]);
+                return;
+            }
+            start_conversion(channels_[index].channel, conversion_delay_ * 1000);
+            return;
+        }
+    }
+    active_index_ = -1;
+}
+
+void Ads1115Scheduler::start_conversion(int channel, uint32_t conversion_time) {
+    ads1115_->start_conversion(channel);
+    collect_due_ = micros() + conversion_time;
+}
+
+void Ads1115Scheduler::poll() {
+    if (active_index_ < 0 || (int32_t)(micros() - collect_due_) < 0) {
+        return;
+    }
+    if (channels_[active_index_].window > 0) {
+        run_burst(channels_[active_index_]);
+    } else {
+        collect();
+    }
+}
+
+void Ads1115Scheduler::collect() {
+    if (!ads1115_->conversion_complete()) {
+        // Still converting (e.g. clock drift on the chip); check again on the next tick
+        return;
+    }
+    int16_t counts = ads1115_->last_conversion();
+    Channel& channel = channels_[active_index_];
+    start_next();
+    acquisition_->publish(channel.source, counts);
+}
+
+void Ads1115Scheduler::start_burst(Channel& channel) {
+    ads1115_->set_data_rate(RATE_ADS1115_860SPS);
+    burst_end_ = millis() + channel.window;
+    start_conversion(channel.channel, BURST_CONVERSION_US);
+}
+
+void Ads1115Scheduler::run_burst(Channel& channel) {
+    while (true) {
+        while (!ads1115_->conversion_complete()) {
+        }
+        bool done = (int32_t)(millis() - burst_end_) >= 0;
+        if (!done) {
+            // The conversion register keeps the result until the next
+            // conversion completes: read it while the next one converts
+            start_conversion(channel.channel, BURST_CONVERSION_US);
+        }
+        channel.sample(ads1115_->last_conversion());
+        if (done) {
+            break;
+        }
+        int32_t remaining = collect_due_ - micros();
+        if (remaining > 0) {
+            delayMicroseconds(remaining);
+        }
+    }
+    ads1115_->set_data_rate(data_rate_);
+    start_next();
+    float result = channel.window_done();
+    if (!isnan(result)) {
+        acquisition_->publish(channel.source, result);
+    }
+}
+
+}  // namespace sensesp
@@ -0,0 +1,86 @@
+#ifndef __SRC_ADS1115_SCHEDULER_H__
+#define __SRC_ADS1115_SCHEDULER_H__
+
+#include <functional>
+#include <vector>
+
+#include "acquisition_task.h"
+#include "adc_device.h"
+#include "adjustable_timer.h"
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief Owns the ADS1115 and shares it between all analog channels
+ *
+ * Channels are sampled round-robin using single-shot conversions. A
+ * conversion is started and the result is collected once the conversion
+ * time for the configured data rate has elapsed, so the event loop is never
+ * blocked waiting for the chip.
+ *
+ * Burst channels take the chip for a whole window instead: it is switched to
+ * 860 SPS and converts the channel back to back, each conversion being read
+ * only once the chip reports it complete, before the round-robin carries on
+ * with the other channels. Once the first conversion is due, the burst
+ * polls the chip without returning to the event loop until the window is
+ * over: waiting for the next acquisition tick between conversions would
+ * halve the rate. The other acquisition reactions wait for the window.
+ * Each conversion is started as soon as the previous one is complete, and
+ * the previous one is read while it converts, so the rate is only short of
+ * 860 SPS by the start and the completion poll.
+ *
+ * All the chip I/O runs in the acquisition task; results are delivered to
+ * the channel callbacks from the main loop.
+ */
+class Ads1115Scheduler {
+   public:
+    Ads1115Scheduler(AdcDevice* ads1115, AcquisitionTask* acquisition, uint16_t data_rate = RATE_ADS1115_128SPS);
+
+    // Sample `channel` every `read_delay` ms and hand the raw counts to
+    // `callback`; returns the index to pass to set_period()
+    size_t add_channel(int channel, uint read_delay, std::function<void(float)> callback);
+    // Every `read_delay` ms, sample `channel` back to back for `window` ms.
+    // `sample` (acquisition task) gets each conversion and `window_done`
+    // (acquisition task) reduces them to the value handed to `callback`;
+    // return NAN from `window_done` to skip the window.
+    size_t add_burst_channel(int channel, uint read_delay, uint window,
+                             std::function<void(int16_t)> sample, std::function<float()> window_done,
+                             std::function<void(float)> callback);
+    // Main loop side: changes the read delay of a channel, sampling it right away
+    void set_period(size_t index, uint read_delay);
+
+   private:
+    struct Channel {
+        int channel;
+        uint8_t source;
+        bool pending;
+        uint window;
+        std::function<void(int16_t)> sample;
+        std::function<float()> window_done;
+        AdjustableTimer* timer;
+    };
+
+    size_t add(Channel channel, uint read_delay);
+    void request(size_t index);
+    void start_next();
+    void start_conversion(int channel, uint32_t conversion_time);
+    void poll();
+    void collect();
+    void start_burst(Channel& channel);
+    void run_burst(Channel& channel);
+
+    AdcDevice* ads1115_;
+    AcquisitionTask* acquisition_;
+    uint16_t data_rate_;
+    uint conversion_delay_;
+    uint32_t collect_due_;  // micros() after which the conversion should be complete
+    uint32_t burst_end_;
+    std::vector<Channel> channels_;
+    size_t next_index_ = 0;
+    int active_index_ = -1;
+};
+
+}  // namespace sensesp
+
+#endif
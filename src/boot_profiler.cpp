@@ -0,0 +1,54 @@
+#include "boot_profiler.h"
+
+namespace sensesp {
+
+BootProfiler* BootProfiler::instance() {
+    static BootProfiler* profiler = new BootProfiler();
+    return profiler;
+}
+
+void BootProfiler::mark(const char* phase) {
+    uint32_t now = micros();
+    uint32_t previous = 0;
+    bool recorded = false;
+    portENTER_CRITICAL(&lock_);
+    if (count_ > 0) {
+        previous = phases_[count_ - 1].time;
+    }
+    if (count_ < MAX_PHASES) {
+        phases_[count_++] = {phase, now};
+        recorded = true;
+    }
+    portEXIT_CRITICAL(&lock_);
+
+    if (recorded) {
+        debugI("Boot: %s at %u ms (+%u ms)", phase, now / 1000, (now - previous) / 1000);
+    }
+}
+
+void BootProfiler::add_handler(DiagnosticsServer* server) {
+    server->add_handler("/boot", [this](httpd_req_t* req) { return this->handle(req); });
+}
+
+esp_err_t BootProfiler::handle(httpd_req_t* req) {
+    Phase phases[MAX_PHASES];
+    portENTER_CRITICAL(&lock_);
+    size_t count = count_;
+    memcpy(phases, phases_, count * sizeof(Phase));
+    portEXIT_CRITICAL(&lock_);
+
+    httpd_resp_set_type(req, "text/csv");
+    char line[96];
+    snprintf(line, sizeof(line), "phase,time_ms,duration_ms\n");
+    httpd_resp_send_chunk(req, line, HTTPD_RESP_USE_STRLEN);
+    uint32_t previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        snprintf(line, sizeof(line), "%s,%.1f,%.1f\n", phases[i].name,
+                 phases[i].time / 1000.0f, (phases[i].time - previous) / 1000.0f);
+        httpd_resp_send_chunk(req, line, HTTPD_RESP_USE_STRLEN);
+        previous = phases[i].time;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+}  // namespace sensesp
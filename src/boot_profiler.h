@@ -0,0 +1,42 @@
+#ifndef __SRC_BOOT_PROFILER_H__
+#define __SRC_BOOT_PROFILER_H__
+
+#include "diagnostics_server.h"
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief Records when each startup phase finishes
+ *
+ * Each phase is logged as it is marked and the whole table is served at
+ * /boot by the diagnostics server. Phases may be marked from any task, so
+ * the ones finishing in the background show up too.
+ */
+class BootProfiler {
+   public:
+    static BootProfiler* instance();
+
+    // Records that `phase` has just finished; `phase` must outlive the profiler
+    void mark(const char* phase);
+    void add_handler(DiagnosticsServer* server);
+
+   private:
+    static const size_t MAX_PHASES = 24;
+
+    struct Phase {
+        const char* name;
+        uint32_t time;  // micros() at the mark
+    };
+
+    BootProfiler() {}
+    esp_err_t handle(httpd_req_t* req);
+
+    Phase phases_[MAX_PHASES];
+    size_t count_ = 0;
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+};
+
+}  // namespace sensesp
+
+#endif
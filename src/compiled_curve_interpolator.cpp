@@ -0,0 +1,64 @@
+#include "compiled_curve_interpolator.h"
+
+namespace sensesp {
+
+void CompiledCurveInterpolator::set_input(float input, uint8_t inputChannel) {
+    // Samples may be added after construction, so compile on first use
+    if (!compiled_) {
+        compile();
+    }
+
+    if (segments_.empty() || input <= input_min_) {
+        output = output_min_;
+    } else if (input >= input_max_) {
+        output = output_max_;
+    } else {
+        int cell = min((int)((input - input_min_) * inverse_step_), TABLE_SIZE - 1);
+        const Segment* segment = &segments_[cells_[cell]];
+        while (input > segment->input_end) {
+            segment++;
+        }
+        output = segment->output_begin + segment->slope * (input - segment->input_begin);
+    }
+    notify();
+}
+
+bool CompiledCurveInterpolator::set_configuration(const JsonObject& config) {
+    compiled_ = false;
+    return CurveInterpolator::set_configuration(config);
+}
+
+void CompiledCurveInterpolator::compile() {
+    segments_.clear();
+    input_min_ = input_max_ = output_min_ = output_max_ = 0;
+    inverse_step_ = 0;
+    compiled_ = true;
+    if (samples_.empty()) {
+        return;
+    }
+
+    input_min_ = samples_.begin()->input;
+    output_min_ = samples_.begin()->output;
+    input_max_ = samples_.rbegin()->input;
+    output_max_ = samples_.rbegin()->output;
+    for (auto previous = samples_.begin(), next = std::next(previous); next != samples_.end(); previous++, next++) {
+        float slope = (next->output - previous->output) / (next->input - previous->input);
+        segments_.push_back({next->input, previous->input, previous->output, slope});
+    }
+    if (segments_.empty()) {
+        return;
+    }
+
+    float step = (input_max_ - input_min_) / TABLE_SIZE;
+    inverse_step_ = 1 / step;
+    size_t segment = 0;
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        float cell_begin = input_min_ + i * step;
+        while (segment + 1 < segments_.size() && segments_[segment].input_end <= cell_begin) {
+            segment++;
+        }
+        cells_[i] = segment;
+    }
+}
+
+}  // namespace sensesp
@@ -0,0 +1,55 @@
+#ifndef __SRC_COMPILED_CURVE_INTERPOLATOR_H__
+#define __SRC_COMPILED_CURVE_INTERPOLATOR_H__
+
+#include <vector>
+
+#include "sensesp/transforms/curveinterpolator.h"
+
+namespace sensesp {
+
+/**
+ * @brief CurveInterpolator that finds the curve segment of an input by index
+ *
+ * The user-editable sample list is kept as is, but whenever it changes the
+ * curve is compiled into its segments, and the range from the first to the
+ * last sample is cut into TABLE_SIZE uniform cells that each record the
+ * first segment they overlap. Each input then costs one index computation,
+ * a compare per sample within its cell, and one multiply-add instead of a
+ * walk over the sample set. The output is the same as CurveInterpolator's,
+ * to float rounding. Inputs outside the curve are clamped to its ends, where
+ * CurveInterpolator ramps from (0, 0) up to the first sample.
+ */
+class CompiledCurveInterpolator : public CurveInterpolator {
+   public:
+    static const int TABLE_SIZE = 256;
+
+    CompiledCurveInterpolator(std::set<Sample>* defaults = NULL, String config_path = "")
+        : CurveInterpolator(defaults, config_path) {}
+
+    void set_input(float input, uint8_t inputChannel = 0) override;
+    virtual bool set_configuration(const JsonObject& config) override;
+
+   private:
+    // The curve between the previous sample and `input_end`
+    struct Segment {
+        float input_end;
+        float input_begin;
+        float output_begin;
+        float slope;
+    };
+
+    void compile();
+
+    bool compiled_ = false;
+    std::vector<Segment> segments_;
+    uint16_t cells_[TABLE_SIZE];
+    float input_min_;
+    float input_max_;
+    float output_min_;
+    float output_max_;
+    float inverse_step_;
+};
+
+}  // namespace sensesp
+
+#endif
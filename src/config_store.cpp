@@ -0,0 +1,227 @@
+#include "config_store.h"
+
+#include <SPIFFS.h>
+#include <esp32/rom/crc.h>
+
+#include <algorithm>
+
+#include "sensesp/system/hash.h"
+
+namespace sensesp {
+
+static const uint32_t MAGIC = 0x47464345;  // "ECFG"
+static const uint16_t VERSION = 2;
+static const char* BLOB_PATHS[] = {"/config.a", "/config.b"};
+
+struct __attribute__((packed)) BlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t sequence;
+    uint32_t size;  // payload bytes
+    uint32_t crc;   // CRC32 of the payload
+};
+
+// Payload entry header, followed by `path_length` bytes of config path and
+// `length` bytes of JSON
+struct __attribute__((packed)) BlobEntry {
+    uint32_t hash;
+    uint16_t path_length;
+    uint16_t length;
+};
+
+// FNV-1a
+static uint32_t path_hash(const String& path) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < path.length(); i++) {
+        hash = (hash ^ (uint8_t)path[i]) * 16777619u;
+    }
+    return hash;
+}
+
+ConfigStore* ConfigStore::instance() {
+    static ConfigStore* store = new ConfigStore();
+    return store;
+}
+
+ConfigStore::ConfigStore() { reload(); }
+
+void ConfigStore::reload() {
+    uint32_t start = micros();
+    entries_.clear();
+    sequence_ = 0;
+    write_scheduled_ = false;
+    migrated_files_.clear();
+    // Use the newest valid blob
+    for (int i = 0; i < 2; i++) {
+        uint32_t sequence;
+        std::vector<Entry> entries;
+        if (read(BLOB_PATHS[i], &sequence, &entries) && sequence > sequence_) {
+            sequence_ = sequence;
+            entries_ = entries;
+        }
+    }
+    debugI("Loaded %u configurations in %u us", entries_.size(), micros() - start);
+}
+
+bool ConfigStore::read(const char* path, uint32_t* sequence, std::vector<Entry>* entries) {
+    File file = SPIFFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+    BlobHeader header;
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || header.magic != MAGIC ||
+        header.version != VERSION) {
+        file.close();
+        return false;
+    }
+    uint8_t* payload = new uint8_t[header.size];
+    bool complete = file.read(payload, header.size) == header.size;
+    file.close();
+    if (!complete || crc32_le(0, payload, header.size) != header.crc) {
+        debugW("Ignoring corrupt configuration blob %s", path);
+        delete[] payload;
+        return false;
+    }
+
+    size_t offset = 0;
+    for (uint16_t i = 0; i < header.count && offset + sizeof(BlobEntry) <= header.size; i++) {
+        BlobEntry entry;
+        memcpy(&entry, payload + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (offset + entry.path_length + entry.length > header.size) {
+            break;
+        }
+        String path;
+        path.concat((const char*)payload + offset, entry.path_length);
+        offset += entry.path_length;
+        String json;
+        json.concat((const char*)payload + offset, entry.length);
+        offset += entry.length;
+        entries->push_back({entry.hash, path, json});
+    }
+    delete[] payload;
+    *sequence = header.sequence;
+    return true;
+}
+
+ConfigStore::Entry* ConfigStore::find(const String& path) {
+    uint32_t hash = path_hash(path);
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), hash,
+                               [](const Entry& entry, uint32_t hash) { return entry.hash < hash; });
+    for (; it != entries_.end() && it->hash == hash; it++) {
+        if (it->path == path) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+String ConfigStore::take_deferred_path() {
+    String path = deferred_path_;
+    deferred_path_ = "";
+    return path;
+}
+
+void ConfigStore::load(Configurable* configurable) {
+    if (configurable->config_path_ == "") {
+        return;
+    }
+    Entry* entry = find(configurable->config_path_);
+    if (entry == nullptr) {
+        // Not in the blob yet: load the SensESP file, if any, and migrate it
+        configurable->Configurable::load_configuration();
+        put(configurable);
+        migrated_files_.push_back("/" + Base64Sha1(configurable->config_path_));
+        migrated_files_.push_back(configurable->config_path_);
+        schedule_write();
+        return;
+    }
+
+    if (deserializeJson(doc_, entry->json)) {
+        debugW("Invalid stored configuration for %s", configurable->config_path_.c_str());
+        return;
+    }
+    JsonObject config = doc_.as<JsonObject>();
+    configurable->set_configuration(config);
+}
+
+void ConfigStore::save(Configurable* configurable) {
+    if (configurable->config_path_ == "") {
+        return;
+    }
+    put(configurable);
+    write();
+}
+
+void ConfigStore::put(Configurable* configurable) {
+    JsonObject config = doc_.to<JsonObject>();
+    configurable->get_configuration(config);
+    String json;
+    serializeJson(doc_, json);
+
+    const String& path = configurable->config_path_;
+    Entry* entry = find(path);
+    if (entry != nullptr) {
+        entry->json = json;
+        return;
+    }
+    uint32_t hash = path_hash(path);
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), hash,
+                               [](const Entry& entry, uint32_t hash) { return entry.hash < hash; });
+    entries_.insert(it, {hash, path, json});
+}
+
+// Migrations happen for many paths in a row at boot; write the blob once
+void ConfigStore::schedule_write() {
+    if (write_scheduled_) {
+        return;
+    }
+    write_scheduled_ = true;
+    ReactESP::app->onDelay(0, [this]() {
+        write_scheduled_ = false;
+        this->write();
+    });
+}
+
+void ConfigStore::write() {
+    BlobHeader header = {MAGIC, VERSION, (uint16_t)entries_.size(), sequence_ + 1, 0, 0};
+    for (auto& entry : entries_) {
+        header.size += sizeof(BlobEntry) + entry.path.length() + entry.json.length();
+    }
+    uint8_t* payload = new uint8_t[header.size];
+    size_t offset = 0;
+    for (auto& entry : entries_) {
+        BlobEntry blob_entry = {entry.hash, (uint16_t)entry.path.length(), (uint16_t)entry.json.length()};
+        memcpy(payload + offset, &blob_entry, sizeof(blob_entry));
+        offset += sizeof(blob_entry);
+        memcpy(payload + offset, entry.path.c_str(), blob_entry.path_length);
+        offset += blob_entry.path_length;
+        memcpy(payload + offset, entry.json.c_str(), blob_entry.length);
+        offset += blob_entry.length;
+    }
+    header.crc = crc32_le(0, payload, header.size);
+
+    // Overwrite the older of the two blobs
+    const char* path = BLOB_PATHS[header.sequence % 2];
+    File file = SPIFFS.open(path, "w");
+    bool written = file &&
+                   file.write((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                   file.write(payload, header.size) == header.size;
+    file.close();
+    delete[] payload;
+    if (!written) {
+        debugE("Unable to write configuration blob %s", path);
+        return;
+    }
+    sequence_ = header.sequence;
+
+    for (auto& migrated : migrated_files_) {
+        if (SPIFFS.exists(migrated)) {
+            SPIFFS.remove(migrated);
+        }
+    }
+    migrated_files_.clear();
+}
+
+}  // namespace sensesp
@@ -0,0 +1,131 @@
+#ifndef __SRC_CONFIG_STORE_H__
+#define __SRC_CONFIG_STORE_H__
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sensesp.h"
+#include "sensesp/system/configurable.h"
+
+namespace sensesp {
+
+/**
+ * @brief All the Configurable settings in a single flash blob
+ *
+ * Instead of one JSON file per config path, every configuration is kept as
+ * a JSON string in one versioned, CRC-checked blob, indexed by a hash of
+ * its config path. Each entry also keeps the path itself, so two paths
+ * with the same hash never share a configuration. The blob is read once,
+ * on first use, and lookups are a binary search in RAM. Writes alternate
+ * between two files and carry a sequence number, so a write torn by a power
+ * loss falls back to the previous blob.
+ *
+ * A config path missing from the blob is migrated from its SensESP file:
+ * the file is loaded the usual way, its configuration is added to the blob
+ * and the file is removed once the blob has been written.
+ */
+class ConfigStore {
+   public:
+    static ConfigStore* instance();
+
+    // Applies the stored configuration of `configurable`, migrating it if needed
+    void load(Configurable* configurable);
+    // Stores the current configuration of `configurable` and writes the blob
+    void save(Configurable* configurable);
+    // Drops the entries in RAM and reads the newest valid blob again, as at boot
+    void reload();
+
+    // Used while a Stored<T> is built: a config path argument, i.e. a string
+    // starting with '/', is replaced by an empty one and kept until
+    // take_deferred_path(). Other arguments are passed through.
+    template <typename A>
+    typename std::enable_if<!std::is_convertible<A, String>::value, A&&>::type defer_path(A&& arg) {
+        return std::forward<A>(arg);
+    }
+    template <typename A>
+    typename std::enable_if<std::is_convertible<A, String>::value, String>::type defer_path(A&& arg) {
+        String value = arg;
+        if (!value.startsWith("/")) {
+            return value;
+        }
+        deferred_path_ = value;
+        return String();
+    }
+    String take_deferred_path();
+
+   private:
+    struct Entry {
+        uint32_t hash;
+        String path;
+        String json;
+    };
+
+    ConfigStore();
+    static bool read(const char* path, uint32_t* sequence, std::vector<Entry>* entries);
+    void put(Configurable* configurable);
+    void write();
+    void schedule_write();
+    Entry* find(const String& path);
+
+    std::vector<Entry> entries_;  // sorted by hash
+    // Reused for every configuration instead of a fresh heap document
+    DynamicJsonDocument doc_{1024};
+    uint32_t sequence_ = 0;
+    bool write_scheduled_ = false;
+    // SensESP files migrated into the blob, removed after the next write
+    std::vector<String> migrated_files_;
+    String deferred_path_;
+};
+
+/**
+ * @brief The configuration of a Stored object, under its config path
+ *
+ * Registered with SensESP in place of the wrapped object, so the
+ * configuration UI reads and writes it through the ConfigStore.
+ */
+class StoredConfiguration : public Configurable {
+   public:
+    StoredConfiguration(Configurable* target, String config_path)
+        : Configurable(config_path),
+          target_{target} {}
+
+    void get_configuration(JsonObject& config) override { target_->get_configuration(config); }
+    bool set_configuration(const JsonObject& config) override { return target_->set_configuration(config); }
+    String get_config_schema() override { return target_->get_config_schema(); }
+    void load_configuration() override { ConfigStore::instance()->load(this); }
+    void save_configuration() override { ConfigStore::instance()->save(this); }
+
+   private:
+    Configurable* target_;
+};
+
+/**
+ * @brief Keeps the configuration of a Configurable in the ConfigStore
+ *
+ * Wraps any Configurable, e.g. `new Stored<Linear>(1.0, 0, "/path")`. The
+ * wrapped class is built with an empty config path, so the load in its
+ * constructor returns without probing the file system for SensESP files;
+ * the path goes to a StoredConfiguration instead. Files are only looked
+ * for when the path is missing from the blob, i.e. once, to migrate them.
+ */
+template <typename T>
+class Stored : public T {
+   public:
+    template <typename... Args>
+    Stored(Args&&... args)
+        : T(ConfigStore::instance()->defer_path(std::forward<Args>(args))...),
+          configuration_{this, ConfigStore::instance()->take_deferred_path()} {
+        configuration_.load_configuration();
+    }
+
+    void load_configuration() override { configuration_.load_configuration(); }
+    void save_configuration() override { configuration_.save_configuration(); }
+
+   private:
+    StoredConfiguration configuration_;
+};
+
+}  // namespace sensesp
+
+#endif
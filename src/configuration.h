@@ -1,47 +1,65 @@
 #ifndef __SRC_CONFIGURATION_H__
 #define __SRC_CONFIGURATION_H__
 
-#include "sensesp/transforms/curveinterpolator.h"
+#include "compiled_curve_interpolator.h"
+
+// Core running the sensor acquisition task; the main loop (Signal K, NMEA 2000) runs on core 1
+#define ACQUISITION_CORE 0
 
 // 1-Wire data pin on SH-ESP32
 #define ONEWIRE_PIN 4
 
 // Alternator W-terminal pin on SH-ESP32
 #define RPM_PIN 15  // Digital input 1 in the engine top hat (connector pin 2)
-#define RPM_MULTIPLIER 1.0 / 1.0
+#define RPM_MULTIPLIER (1.0f / 1.0f)
+// W-terminal pulses shorter than this are ignored by the pulse counter
+#define RPM_GLITCH_FILTER_NS 10000
+// Period mode timestamps every Nth W-terminal pulse, for N times fewer
+// capture interrupts
+#define RPM_CAPTURE_PRESCALE 4
 
 // I2C (SDA and SCL) pins on SH-ESP32
 #define SDA_PIN 16
 #define SCL_PIN 17
+// I2C fast mode, which the ADS1115 supports: a register access takes a
+// quarter of the time it takes at the default 100 kHz
+#define I2C_FREQUENCY 400000
 
 // ADS1115 I2C address
 #define ADS1115ADDR 0x4b
 
+// ADS1115 programmable gain; 1x gain +/- 4.096V 1 bit = 0.125mV
+#define ADS1115GAIN GAIN_ONE
+
 // ADS1115 input hardware scale factor (input voltage vs voltage at ADS1115)
-#define ADS1115INPUTSCALE 29. / 2.048
+#define ADS1115INPUTSCALE (29.0f / 2.048f)
 
 // Engine Hat constant measurement current (A)
-#define ADS1115MEASUREMENTCURRENT 0.01
+#define ADS1115MEASUREMENTCURRENT 0.01f
 
 // CAN bus (NMEA 2000) pins on SH-ESP32
 #define CAN_RX_PIN GPIO_NUM_34
 #define CAN_TX_PIN GPIO_NUM_32
 
+// Battery whose PGN 127508 voltage is read from the bus
+#define N2K_BATTERY_INSTANCE 0
+
 #define SERIAL1_RX_PIN GPIO_NUM_21
 #define SERIAL1_TX_PIN GPIO_NUM_23
 
-#define PZCT02_BURDEN_RESISTANCE 18
-#define PZCT02_MULTIPLIER 1 / 1000
+#define PZCT02_BURDEN_RESISTANCE 18.0f
+// PZCT-02 turns ratio (100A primary : 100mA secondary)
+#define PZCT02_MULTIPLIER 1000.0f
 
 // Default capacity value for the fuel tank, in cubic meters (m3)
-#define FUEL_TANK_CAPACITY 140. / 1000
+#define FUEL_TANK_CAPACITY (140.0f / 1000)
 // Milimeters reading of the ultrasonic sensor that represents full tank
 #define FUEL_TANK_FULL_MM 200
 // Milimeters reading of the ultrasonic sensor that represents empty tank
 #define FUEL_TANK_EMPTY_MM 0
 
 // Default capacity value for the fresh water tank, in cubic meters (m3)
-#define FRESH_WATER_TANK_CAPACITY 300. / 1000
+#define FRESH_WATER_TANK_CAPACITY (300.0f / 1000)
 
 // Channel numbers for the ADS1115 pins (analog pins in the engine hat)
 #define FRESH_WATER_TANK_SENSOR_CHANNEL 0     // A
@@ -49,15 +67,22 @@
 #define ENGINE_COOLANT_TEMP_SENSOR_CHANNEL 2  // C (connector pin 3)
 #define ALTERNATOR_OUTPUT_SENSOR_CHANNEL 3    // D
 
-#define ctok(c) c + 273.15
-#define bartopa(bar) bar * 100000
+// Bytes reserved at build time for the sensor pipeline objects; the boot log
+// and the heap telemetry report how much is used
+#ifndef PIPELINE_ARENA_SIZE
+#define PIPELINE_ARENA_SIZE 16384
+#endif
+
+// Unit conversions; single precision, the ESP32 FPU has no double support
+#define ctok(c) ((c) + 273.15f)
+#define bartopa(bar) ((bar) * 100000.0f)
 
 namespace sensesp {
 
-class OilPressureSender : public CurveInterpolator {
+class OilPressureSender : public CompiledCurveInterpolator {
    public:
     OilPressureSender(String config_path = "")
-        : CurveInterpolator(NULL, config_path) {
+        : CompiledCurveInterpolator(NULL, config_path) {
         // Populate a lookup table tp translate the ohm values returned by
         // our pressure sender to Pa
         clear_samples();
@@ -75,49 +100,49 @@ class OilPressureSender : public CurveInterpolator {
     }
 };
 
-class CoolantTempSender : public CurveInterpolator {
+class CoolantTempSender : public CompiledCurveInterpolator {
    public:
     CoolantTempSender(String config_path = "")
-        : CurveInterpolator(NULL, config_path) {
+        : CompiledCurveInterpolator(NULL, config_path) {
         // Populate a lookup table tp translate the ohm values returned by
         // our temperatures sender to degrees kelvin
         clear_samples();
         // addSample(CurveInterpolator::Sample(knownOhmValue, knownKelvin));
-        add_sample(CurveInterpolator::Sample(356.64, ctok(35)));
-        add_sample(CurveInterpolator::Sample(291.46, ctok(40)));
-        add_sample(CurveInterpolator::Sample(239.56, ctok(45)));
-        add_sample(CurveInterpolator::Sample(197.29, ctok(50)));
-        add_sample(CurveInterpolator::Sample(161.46, ctok(55)));
-        add_sample(CurveInterpolator::Sample(134.03, ctok(60)));
-        add_sample(CurveInterpolator::Sample(113.96, ctok(65)));
-        add_sample(CurveInterpolator::Sample(97.05, ctok(70)));
-        add_sample(CurveInterpolator::Sample(82.36, ctok(75)));
-        add_sample(CurveInterpolator::Sample(70.12, ctok(80)));
-        add_sample(CurveInterpolator::Sample(59.73, ctok(85)));
-        add_sample(CurveInterpolator::Sample(51.21, ctok(90)));
-        add_sample(CurveInterpolator::Sample(44.32, ctok(95)));
-        add_sample(CurveInterpolator::Sample(38.47, ctok(100)));
-        add_sample(CurveInterpolator::Sample(33.40, ctok(105)));
-        add_sample(CurveInterpolator::Sample(29.12, ctok(110)));
-        add_sample(CurveInterpolator::Sample(25.53, ctok(115)));
-        add_sample(CurveInterpolator::Sample(22.44, ctok(120)));
+        add_sample(CurveInterpolator::Sample(356.64f, ctok(35)));
+        add_sample(CurveInterpolator::Sample(291.46f, ctok(40)));
+        add_sample(CurveInterpolator::Sample(239.56f, ctok(45)));
+        add_sample(CurveInterpolator::Sample(197.29f, ctok(50)));
+        add_sample(CurveInterpolator::Sample(161.46f, ctok(55)));
+        add_sample(CurveInterpolator::Sample(134.03f, ctok(60)));
+        add_sample(CurveInterpolator::Sample(113.96f, ctok(65)));
+        add_sample(CurveInterpolator::Sample(97.05f, ctok(70)));
+        add_sample(CurveInterpolator::Sample(82.36f, ctok(75)));
+        add_sample(CurveInterpolator::Sample(70.12f, ctok(80)));
+        add_sample(CurveInterpolator::Sample(59.73f, ctok(85)));
+        add_sample(CurveInterpolator::Sample(51.21f, ctok(90)));
+        add_sample(CurveInterpolator::Sample(44.32f, ctok(95)));
+        add_sample(CurveInterpolator::Sample(38.47f, ctok(100)));
+        add_sample(CurveInterpolator::Sample(33.40f, ctok(105)));
+        add_sample(CurveInterpolator::Sample(29.12f, ctok(110)));
+        add_sample(CurveInterpolator::Sample(25.53f, ctok(115)));
+        add_sample(CurveInterpolator::Sample(22.44f, ctok(120)));
 
         set_input_title("Sender Resistance (ohms)");
         set_output_title("Temperature (kelvin)");
     }
 };
 
-class TankLevelSender : public CurveInterpolator {
+class TankLevelSender : public CompiledCurveInterpolator {
    public:
     TankLevelSender(String config_path = "")
-        : CurveInterpolator(NULL, config_path) {
+        : CompiledCurveInterpolator(NULL, config_path) {
         // Populate a lookup table tp translate the ohm values returned by
         // our water float sender to a ratio level
         clear_samples();
         // addSample(CurveInterpolator::Sample(knownOhmValue, knownLevel));
         add_sample(CurveInterpolator::Sample(0, 0));
-        add_sample(CurveInterpolator::Sample(180., 1));
-        add_sample(CurveInterpolator::Sample(300., 1));
+        add_sample(CurveInterpolator::Sample(180.0f, 1));
+        add_sample(CurveInterpolator::Sample(300.0f, 1));
 
         set_input_title("Sender Resistance (ohms)");
         set_output_title("Water level (ratio)");
@@ -0,0 +1,62 @@
+#include "deadband.h"
+
+namespace sensesp {
+
+Deadband::Deadband(float threshold, bool relative, uint max_silence, String config_path)
+    : FloatTransform(config_path),
+      threshold_{threshold},
+      relative_{relative},
+      max_silence_{max_silence} {
+    load_configuration();
+}
+
+void Deadband::set_input(float input, uint8_t inputChannel) {
+    uint32_t now = millis();
+    if (emitted_ && isnan(input) == isnan(last_emitted_) && now - last_emit_time_ < max_silence_) {
+        float limit = relative_ ? threshold_ * fabsf(last_emitted_) : threshold_;
+        if (isnan(input) || fabsf(input - last_emitted_) <= limit) {
+            suppressed_++;
+            return;
+        }
+    }
+    emitted_ = true;
+    last_emitted_ = input;
+    last_emit_time_ = now;
+    this->emit(input);
+    if (suppressed_ != reported_suppressed_) {
+        reported_suppressed_ = suppressed_;
+        suppressed_output_.set(suppressed_);
+    }
+}
+
+void Deadband::get_configuration(JsonObject& root) {
+    root["threshold"] = threshold_;
+    root["relative"] = relative_;
+    root["max_silence"] = max_silence_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "threshold": { "title": "Threshold", "type": "number", "description": "Minimum change since the last value sent for a new value to be sent" },
+        "relative": { "title": "Relative threshold", "type": "boolean", "description": "Treat the threshold as a fraction of the last value sent" },
+        "max_silence": { "title": "Maximum silence", "type": "number", "description": "Number of milliseconds after which a value is sent even if it did not change" }
+    }
+  })###";
+
+String Deadband::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool Deadband::set_configuration(const JsonObject& config) {
+    String expected[] = {"threshold", "relative", "max_silence"};
+    for (auto str : expected) {
+        if (!config.containsKey(str)) {
+            return false;
+        }
+    }
+    threshold_ = config["threshold"];
+    relative_ = config["relative"];
+    max_silence_ = config["max_silence"];
+    return true;
+}
+
+}  // namespace sensesp
@@ -0,0 +1,45 @@
+#ifndef __SRC_DEADBAND_H__
+#define __SRC_DEADBAND_H__
+
+#include "sensesp.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+/**
+ * @brief Report-by-exception filter
+ *
+ * Passes a value on only when it moved by more than `threshold` since the
+ * last value passed on (or by more than `threshold` times that value, if
+ * `relative`), or when nothing was passed on for `max_silence` ms. Values
+ * held back since the last restart are counted; the count is a runtime
+ * status, so it is emitted by `suppressed()` instead of being part of the
+ * configuration.
+ */
+class Deadband : public FloatTransform {
+   public:
+    Deadband(float threshold, bool relative = false, uint max_silence = 60000, String config_path = "");
+    void set_input(float input, uint8_t inputChannel = 0) override;
+    // Number of values held back, updated whenever a value is passed on
+    ValueProducer<float>* suppressed() { return &suppressed_output_; }
+
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    float threshold_;
+    bool relative_;
+    uint max_silence_;
+    bool emitted_ = false;
+    float last_emitted_;
+    uint32_t last_emit_time_;
+    uint32_t suppressed_ = 0;
+    uint32_t reported_suppressed_ = 0;
+    ObservableValue<float> suppressed_output_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,57 @@
+#include "deferred_log.h"
+
+#include "sensesp/system/lambda_consumer.h"
+
+namespace sensesp {
+
+// How long the drain task sleeps when there is nothing to write (ms)
+static const uint32_t IDLE_DELAY = 20;
+
+void DeferredLog::tap(ValueProducer<float>* producer, const char* format) {
+    uint8_t tap = formats_.size();
+    formats_.push_back(format);
+    producer->connect_to(new LambdaConsumer<float>([this, tap](float value) { this->log(tap, value); }));
+}
+
+void DeferredLog::log(uint8_t tap, float value) {
+    if (!queue_.push({(uint32_t)millis(), tap, value})) {
+        dropped_++;
+    }
+}
+
+void DeferredLog::start() {
+    xTaskCreatePinnedToCore(run, "deferred_log", 3072, this, tskIDLE_PRIORITY + 1, NULL, core_);
+}
+
+void DeferredLog::run(void* log) {
+    auto deferred_log = static_cast<DeferredLog*>(log);
+    while (true) {
+        deferred_log->drain();
+        vTaskDelay(pdMS_TO_TICKS(IDLE_DELAY));
+    }
+}
+
+void DeferredLog::drain() {
+    char line[128];
+    Record record;
+    while (queue_.pop(&record)) {
+        int length = snprintf(line, sizeof(line), "(D) %u ", record.timestamp);
+        length += snprintf(line + length, sizeof(line) - length, formats_[record.tap], record.value);
+        length = min(length, (int)sizeof(line) - 2);
+        line[length++] = '\n';
+
+        // Wait for room instead of blocking in Serial.write()
+        while (Serial.availableForWrite() < length) {
+            vTaskDelay(1);
+        }
+        Serial.write(line, length);
+    }
+
+    uint32_t dropped = dropped_.load();
+    if (dropped != reported_dropped_) {
+        Serial.printf("(W) %u deferred log records dropped\n", dropped - reported_dropped_);
+        reported_dropped_ = dropped;
+    }
+}
+
+}  // namespace sensesp
@@ -0,0 +1,52 @@
+#ifndef __SRC_DEFERRED_LOG_H__
+#define __SRC_DEFERRED_LOG_H__
+
+#include <atomic>
+#include <vector>
+
+#include "sample_queue.h"
+#include "sensesp.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+/**
+ * @brief Logs producer values without formatting them in the main loop
+ *
+ * A tap only queues a binary {timestamp, tap, value} record. A low priority
+ * task formats the records and writes them to Serial when its transmit
+ * buffer has room, so a slow serial port never stalls the main loop. When
+ * the queue is full records are dropped and the number dropped is logged.
+ *
+ * Tap formats must be string literals (or otherwise outlive the log) and
+ * take a single float.
+ */
+class DeferredLog {
+   public:
+    DeferredLog(BaseType_t core = 0) : core_{core} {}
+
+    // Logs every value emitted by `producer` with `format`; call before start()
+    void tap(ValueProducer<float>* producer, const char* format);
+    void log(uint8_t tap, float value);
+    void start();
+
+   private:
+    struct Record {
+        uint32_t timestamp;  // millis()
+        uint8_t tap;
+        float value;
+    };
+
+    static void run(void* log);
+    void drain();
+
+    BaseType_t core_;
+    std::vector<const char*> formats_;
+    SampleQueue<Record, 256> queue_;
+    std::atomic<uint32_t> dropped_{0};
+    uint32_t reported_dropped_ = 0;
+};
+
+}  // namespace sensesp
+
+#endif
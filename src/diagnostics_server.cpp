@@ -0,0 +1,46 @@
+#include "diagnostics_server.h"
+
+namespace sensesp {
+
+DiagnosticsServer::DiagnosticsServer(uint16_t port) : port_{port} {}
+
+void DiagnosticsServer::add_handler(const char* uri, Handler handler) {
+    handlers_.push_back({uri, new Handler(handler)});
+}
+
+void DiagnosticsServer::start() {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = port_;
+    // The SensESP web server already uses the default control port
+    config.ctrl_port = HTTPD_DEFAULT_CONFIG().ctrl_port + 1;
+    config.max_uri_handlers = handlers_.size();
+    if (httpd_start(&server_, &config) != ESP_OK) {
+        debugE("Unable to start the diagnostics server on port %u", port_);
+        return;
+    }
+
+    for (auto& handler : handlers_) {
+        httpd_uri_t uri = {};
+        uri.uri = handler.first;
+        uri.method = HTTP_GET;
+        uri.handler = dispatch;
+        uri.user_ctx = handler.second;
+        httpd_register_uri_handler(server_, &uri);
+    }
+}
+
+esp_err_t DiagnosticsServer::dispatch(httpd_req_t* req) {
+    return (*static_cast<Handler*>(req->user_ctx))(req);
+}
+
+String DiagnosticsServer::query_param(httpd_req_t* req, const char* key, String fallback) {
+    char query[128];
+    char value[64];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return fallback;
+    }
+    return String(value);
+}
+
+}  // namespace sensesp
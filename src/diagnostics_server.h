@@ -0,0 +1,40 @@
+#ifndef __SRC_DIAGNOSTICS_SERVER_H__
+#define __SRC_DIAGNOSTICS_SERVER_H__
+
+#include <esp_http_server.h>
+
+#include <functional>
+#include <vector>
+
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief Small HTTP server for diagnostics pages and data dumps
+ *
+ * Runs next to the SensESP web UI on its own port. Handlers can be added
+ * until start() is called.
+ */
+class DiagnosticsServer {
+   public:
+    typedef std::function<esp_err_t(httpd_req_t*)> Handler;
+
+    DiagnosticsServer(uint16_t port = 81);
+    void add_handler(const char* uri, Handler handler);
+    void start();
+
+    // Reads the query parameter `key` of the request; `fallback` if missing
+    static String query_param(httpd_req_t* req, const char* key, String fallback = "");
+
+   private:
+    static esp_err_t dispatch(httpd_req_t* req);
+
+    uint16_t port_;
+    httpd_handle_t server_ = nullptr;
+    std::vector<std::pair<const char*, Handler*>> handlers_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __SRC_EDGE_CAPTURE_H__
+#define __SRC_EDGE_CAPTURE_H__
+
+#include <stdint.h>
+
+namespace sensesp {
+
+// Source of edge timestamps, e.g. a hardware capture unit or a simulated edge stream
+class EdgeCapture {
+   public:
+    virtual ~EdgeCapture() {}
+    virtual void begin() = 0;
+    // Pops the oldest captured edge timestamp; false if there is none
+    virtual bool next_edge(uint32_t* timestamp) = 0;
+    // Once next_edge() returned false: true if edges were lost after the
+    // last one returned, so the next edge does not follow it. Clears the flag.
+    virtual bool take_overflow() = 0;
+    // Edges between two timestamps: with a prescaler, only every Nth edge
+    // is timestamped
+    virtual uint32_t edges_per_timestamp() = 0;
+    virtual uint32_t ticks_per_second() = 0;
+};
+
+}  // namespace sensesp
+
+#endif
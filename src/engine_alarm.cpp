@@ -0,0 +1,94 @@
+#include "engine_alarm.h"
+
+#include "sensesp/system/lambda_consumer.h"
+
+namespace sensesp {
+
+EngineAlarm::EngineAlarm(AcquisitionTask* acquisition, bool low, float threshold, float hysteresis, uint debounce, String config_path)
+    : Transform<float, bool>(config_path),
+      acquisition_{acquisition},
+      low_{low},
+      threshold_{threshold},
+      hysteresis_{hysteresis},
+      debounce_{debounce} {
+    load_configuration();
+}
+
+void EngineAlarm::require_running(ValueProducer<float>* rpms) {
+    enabled_ = false;
+    rpms->connect_to(new LambdaConsumer<float>([this](float value) {
+        enabled_ = value > 0;
+        if (!enabled_) {
+            pending_ = false;
+            if (active_) {
+                this->set_active(false, micros());
+            }
+        }
+    }));
+}
+
+void EngineAlarm::set_input(float input, uint8_t inputChannel) {
+    if (!enabled_ || isnan(input)) {
+        return;
+    }
+
+    // Condition for the opposite of the current state
+    bool flip;
+    if (!active_) {
+        flip = low_ ? input < threshold_ : input > threshold_;
+    } else {
+        flip = low_ ? input > threshold_ + hysteresis_ : input < threshold_ - hysteresis_;
+    }
+    if (!flip) {
+        pending_ = false;
+        return;
+    }
+
+    uint32_t now = millis();
+    if (!pending_) {
+        pending_ = true;
+        pending_since_ = now;
+    }
+    if (now - pending_since_ >= debounce_) {
+        pending_ = false;
+        this->set_active(!active_, acquisition_->sample_timestamp());
+    }
+}
+
+void EngineAlarm::set_active(bool active, uint32_t sample_timestamp) {
+    active_ = active;
+    sample_timestamp_ = sample_timestamp;
+    this->emit(active);
+}
+
+void EngineAlarm::get_configuration(JsonObject& root) {
+    root["threshold"] = threshold_;
+    root["hysteresis"] = hysteresis_;
+    root["debounce"] = debounce_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "threshold": { "title": "Threshold", "type": "number", "description": "Value at which the alarm is raised" },
+        "hysteresis": { "title": "Hysteresis", "type": "number", "description": "How far back past the threshold the value must go for the alarm to clear" },
+        "debounce": { "title": "Debounce", "type": "number", "description": "Number of milliseconds the value must stay past the threshold before the alarm is raised or cleared" }
+    }
+  })###";
+
+String EngineAlarm::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool EngineAlarm::set_configuration(const JsonObject& config) {
+    String expected[] = {"threshold", "hysteresis", "debounce"};
+    for (auto str : expected) {
+        if (!config.containsKey(str)) {
+            return false;
+        }
+    }
+    threshold_ = config["threshold"];
+    hysteresis_ = config["hysteresis"];
+    debounce_ = config["debounce"];
+    return true;
+}
+
+}  // namespace sensesp
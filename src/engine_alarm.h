@@ -0,0 +1,52 @@
+#ifndef __SRC_ENGINE_ALARM_H__
+#define __SRC_ENGINE_ALARM_H__
+
+#include "acquisition_task.h"
+#include "sensesp.h"
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+/**
+ * @brief Threshold alarm on a raw engine value
+ *
+ * Raises when the value goes above (or, for a low alarm, below) `threshold`
+ * and clears once it is back by more than `hysteresis`. Either transition
+ * only happens after the condition held for `debounce` ms. Emits the new
+ * alarm state on every transition, from the same call that delivered the
+ * triggering sample, so the output can go straight to the bus.
+ *
+ * Meant to be fed from the sensor conversion, before any averaging.
+ */
+class EngineAlarm : public Transform<float, bool> {
+   public:
+    EngineAlarm(AcquisitionTask* acquisition, bool low, float threshold, float hysteresis, uint debounce = 2000, String config_path = "");
+    void set_input(float input, uint8_t inputChannel = 0) override;
+    // Only evaluate the alarm while `rpms` is above zero, e.g. for oil pressure
+    void require_running(ValueProducer<float>* rpms);
+    bool active() { return active_; }
+    // micros() at which the sample behind the last transition was acquired
+    uint32_t sample_timestamp() { return sample_timestamp_; }
+
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    void set_active(bool active, uint32_t sample_timestamp);
+
+    AcquisitionTask* acquisition_;
+    bool low_;
+    float threshold_;
+    float hysteresis_;
+    uint debounce_;
+    bool enabled_ = true;
+    bool active_ = false;
+    bool pending_ = false;
+    uint32_t pending_since_;
+    uint32_t sample_timestamp_ = 0;
+};
+
+}  // namespace sensesp
+
+#endif
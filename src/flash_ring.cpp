@@ -0,0 +1,151 @@
+#include "flash_ring.h"
+
+#include <SPIFFS.h>
+#include <esp32/rom/crc.h>
+
+#include "sensesp.h"
+
+namespace sensesp {
+
+// Holds a FreeRTOS mutex for the lifetime of the guard
+class MutexGuard {
+   public:
+    MutexGuard(SemaphoreHandle_t mutex) : mutex_{mutex} { xSemaphoreTake(mutex_, portMAX_DELAY); }
+    ~MutexGuard() { xSemaphoreGive(mutex_); }
+
+   private:
+    SemaphoreHandle_t mutex_;
+};
+
+FlashRing::FlashRing(String path, size_t record_size, size_t capacity)
+    : path_{path},
+      record_size_{record_size},
+      capacity_{capacity} {
+    slot_buffer_ = new uint8_t[slot_size()];
+    mutex_ = xSemaphoreCreateMutex();
+}
+
+FlashRing::~FlashRing() {
+    delete[] slot_buffer_;
+    vSemaphoreDelete(mutex_);
+}
+
+bool FlashRing::begin() {
+    if (SPIFFS.exists(path_)) {
+        File file = SPIFFS.open(path_, "r");
+        bool matches = file && file.size() == capacity_ * slot_size();
+        file.close();
+        if (!matches) {
+            // Left over from a different record layout; start over
+            debugW("Recreating %s", path_.c_str());
+            SPIFFS.remove(path_);
+        }
+    }
+    if (!SPIFFS.exists(path_)) {
+        // Preallocate the whole ring with erased (0xFF) slots, which never pass the CRC check
+        File file = SPIFFS.open(path_, "w");
+        if (!file) {
+            debugE("Unable to create %s", path_.c_str());
+            return false;
+        }
+        memset(slot_buffer_, 0xFF, slot_size());
+        for (size_t slot = 0; slot < capacity_; slot++) {
+            file.write(slot_buffer_, slot_size());
+        }
+        file.close();
+        return true;
+    }
+
+    File file = SPIFFS.open(path_, "r");
+    if (!file) {
+        return false;
+    }
+    uint32_t sequence;
+    for (size_t slot = 0; slot < capacity_; slot++) {
+        if (read_slot(file, slot, &sequence, nullptr) && sequence > sequence_) {
+            sequence_ = sequence;
+            newest_slot_ = slot;
+        }
+    }
+    file.close();
+    return true;
+}
+
+bool FlashRing::append(const void* record) {
+    MutexGuard guard(mutex_);
+    uint32_t sequence = sequence_ + 1;
+    size_t slot = empty() ? 0 : (newest_slot_ + 1) % capacity_;
+
+    memcpy(slot_buffer_, &sequence, sizeof(sequence));
+    memcpy(slot_buffer_ + sizeof(sequence), record, record_size_);
+    uint32_t crc = crc32_le(0, slot_buffer_, sizeof(sequence) + record_size_);
+    memcpy(slot_buffer_ + sizeof(sequence) + record_size_, &crc, sizeof(crc));
+
+    File file = SPIFFS.open(path_, "r+");
+    if (!file) {
+        return false;
+    }
+    bool written = file.seek(slot * slot_size()) &&
+                   file.write(slot_buffer_, slot_size()) == slot_size();
+    file.close();
+    if (!written) {
+        return false;
+    }
+
+    sequence_ = sequence;
+    newest_slot_ = slot;
+    return true;
+}
+
+bool FlashRing::read_latest(void* record) {
+    MutexGuard guard(mutex_);
+    if (empty()) {
+        return false;
+    }
+    File file = SPIFFS.open(path_, "r");
+    if (!file) {
+        return false;
+    }
+    uint32_t sequence;
+    bool read = read_slot(file, newest_slot_, &sequence, record);
+    file.close();
+    return read;
+}
+
+bool FlashRing::read(size_t index, void* record) {
+    MutexGuard guard(mutex_);
+    if (index >= size()) {
+        return false;
+    }
+    // Once the ring has wrapped, the oldest record is the one after the newest
+    size_t oldest_slot = size() < capacity_ ? 0 : (newest_slot_ + 1) % capacity_;
+    File file = SPIFFS.open(path_, "r");
+    if (!file) {
+        return false;
+    }
+    uint32_t sequence;
+    bool read = read_slot(file, (oldest_slot + index) % capacity_, &sequence, record);
+    file.close();
+    return read;
+}
+
+bool FlashRing::read_slot(File& file, size_t slot, uint32_t* sequence, void* record) {
+    if (!file.seek(slot * slot_size()) ||
+        file.read(slot_buffer_, slot_size()) != slot_size()) {
+        return false;
+    }
+
+    uint32_t crc;
+    memcpy(&crc, slot_buffer_ + sizeof(uint32_t) + record_size_, sizeof(crc));
+    if (crc != crc32_le(0, slot_buffer_, sizeof(uint32_t) + record_size_)) {
+        return false;
+    }
+
+    memcpy(sequence, slot_buffer_, sizeof(uint32_t));
+    if (record != nullptr) {
+        memcpy(record, slot_buffer_ + sizeof(uint32_t), record_size_);
+    }
+    return true;
+}
+
+}  // namespace sensesp
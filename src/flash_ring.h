@@ -0,0 +1,56 @@
+#ifndef __SRC_FLASH_RING_H__
+#define __SRC_FLASH_RING_H__
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/semphr.h>
+
+namespace sensesp {
+
+/**
+ * @brief Append-only ring of fixed-size records in a preallocated SPIFFS file
+ *
+ * Each slot holds a sequence number, the record payload and a CRC32 of both.
+ * Appends go to the slot after the newest one, so writes rotate over the whole
+ * file. On begin() every slot is scanned once and the newest record with a
+ * valid CRC is recovered; a write torn by a power loss fails the CRC and the
+ * previous record is used instead.
+ *
+ * Appends and reads may come from different tasks.
+ */
+class FlashRing {
+   public:
+    FlashRing(String path, size_t record_size, size_t capacity);
+    ~FlashRing();
+
+    // Creates the file if needed (or if it does not match the record size and
+    // capacity) and recovers the newest valid record
+    bool begin();
+    bool append(const void* record);
+    // Copies the newest valid record into `record`; false if the ring is empty
+    bool read_latest(void* record);
+    // Number of records written and still held in the ring
+    size_t size() { return min((size_t)sequence_, capacity_); }
+    // Copies the `index`th oldest record into `record`; false if it is
+    // missing or fails the CRC check
+    bool read(size_t index, void* record);
+
+    uint32_t sequence() { return sequence_; }
+    bool empty() { return sequence_ == 0; }
+
+   private:
+    size_t slot_size() { return sizeof(uint32_t) + record_size_ + sizeof(uint32_t); }
+    bool read_slot(File& file, size_t slot, uint32_t* sequence, void* record);
+
+    String path_;
+    size_t record_size_;
+    size_t capacity_;
+    uint8_t* slot_buffer_;
+    SemaphoreHandle_t mutex_;
+    size_t newest_slot_ = 0;
+    uint32_t sequence_ = 0;
+};
+
+}  // namespace sensesp
+
+#endif
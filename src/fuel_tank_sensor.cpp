@@ -1,5 +1,7 @@
 #include "fuel_tank_sensor.h"
 
+#include "reaction_profiler.h"
+
 namespace sensesp {
 
 FuelTankSensor::FuelTankSensor(int8_t empty_mm, int8_t full_mm, uint read_delay, String config_path) : FloatSensor(config_path),
@@ -14,7 +16,8 @@ void FuelTankSensor::start() {
     Serial1.begin(9600, SERIAL_8N1, SERIAL1_RX_PIN, SERIAL1_TX_PIN);
     ds1603l_->begin();  // Initialise the sensor library.
 
-    ReactESP::app->onRepeat(read_delay_, [this]() {
+    // Run time only: the period follows the sampling policy
+    timer_ = new AdjustableTimer(ReactESP::app, read_delay_, PROFILED("fuel_tank", 0, [this]() {
         long last_time = micros();
         while (micros() - last_time < 100) {
             yield();
@@ -22,13 +25,25 @@ void FuelTankSensor::start() {
 
         int16_t reading = this->getSensorReading();
         if (reading > -1) {
-            const float range = full_mm_ - empty_mm_;
-            const float divisor = range / 100.0;
-            const float multiplier = 1.0 / divisor;              //  (1 / 4.5 = 0.0222222)
-            const float offset = 100.0 - full_mm_ * multiplier;  // (100 - (500 x 0.0222222) = 38.8889)
-            this->emit(multiplier * reading + offset);
+            this->emit(reading);
         }
-    });
+    }));
+    timer_->start();
+}
+
+void FuelTankLevel::set_input(float input, uint8_t inputChannel) {
+    const float range = sensor_->full_mm_ - sensor_->empty_mm_;
+    const float divisor = range / 100.0f;
+    const float multiplier = 1.0f / divisor;                       //  (1 / 4.5 = 0.0222222)
+    const float offset = 100.0f - sensor_->full_mm_ * multiplier;  // (100 - (500 x 0.0222222) = 38.8889)
+    this->emit(multiplier * input + offset);
+}
+
+void FuelTankSensor::set_sample_period(uint period) {
+    read_delay_ = period;
+    if (timer_ != nullptr) {
+        timer_->set_period(period);
+    }
 }
 
 void FuelTankSensor::get_configuration(JsonObject& root) {
@@ -40,7 +55,7 @@ void FuelTankSensor::get_configuration(JsonObject& root) {
 static const char SCHEMA[] PROGMEM = R"###({
     "type": "object",
     "properties": {
-        "read_delay": { "title": "Read delay", "type": "number", "description": "Number of milliseconds between each read" },
+        "read_delay": { "title": "Read delay", "type": "number", "description": "Number of milliseconds between each read. Set by the sampling policy (/system/sampling_policy) for the engine running state" },
         "full_mm": { "title": "Full tank mm value", "type": "number", "description": "Milimeters reading of the ultrasonic sensor that represents full tank" },
         "empty_mm": { "title": "Empty tank mm value", "type": "number", "description": "Milimeters reading of the ultrasonic sensor that represents empty tank" }
     }
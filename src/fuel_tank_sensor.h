@@ -4,13 +4,29 @@
 #include <DS1603L.h>
 #include <HardwareSerial.h>
 
+#include "adjustable_timer.h"
 #include "configuration.h"
+#include "sampling_policy.h"
 #include "sensesp.h"
 #include "sensesp/sensors/sensor.h"
+#include "sensesp/transforms/transform.h"
 
 namespace sensesp {
 
-class FuelTankSensor : public FloatSensor {
+class FuelTankSensor;
+
+// Converts the level in mm to a percentage with the sensor's calibration
+class FuelTankLevel : public FloatTransform {
+   public:
+    FuelTankLevel(FuelTankSensor* sensor) : FloatTransform(""), sensor_{sensor} {}
+    void set_input(float input, uint8_t inputChannel = 0) override;
+
+   private:
+    FuelTankSensor* sensor_;
+};
+
+// Emits the raw DS1603L level in mm; level() turns it into a percentage
+class FuelTankSensor : public FloatSensor, public SamplingTarget {
    public:
     FuelTankSensor(int8_t empty_mm, int8_t full_mm, uint read_delay = 500, String config_path = "");
     void start() override final;
@@ -18,12 +34,18 @@ class FuelTankSensor : public FloatSensor {
     virtual bool set_configuration(const JsonObject& config) override final;
     virtual String get_config_schema() override;
     float getSensorReading();
+    void set_sample_period(uint period) override;
+    FuelTankLevel* level() { return &level_; }
 
    private:
+    friend class FuelTankLevel;
+
     DS1603L* ds1603l_;
     int8_t empty_mm_;
     int8_t full_mm_;
     uint read_delay_;
+    AdjustableTimer* timer_ = nullptr;
+    FuelTankLevel level_{this};
 };
 
 }  // namespace sensesp
@@ -0,0 +1,190 @@
+#include "gorilla_codec.h"
+
+#include <string.h>
+
+namespace sensesp {
+
+static const uint8_t SOURCE_BITS = 5;
+// No previous XOR window for this stream yet
+static const uint8_t NO_WINDOW = 0xFF;
+// Source, '1111' + 32 bit delta-of-delta and '11' + 5 bit leading zeros +
+// 5 bit length + 32 meaningful bits
+static const uint16_t MAX_SAMPLE_BITS = SOURCE_BITS + 36 + 44;
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void GorillaEncoder::reset() {
+    block_->count = 0;
+    block_->bits = 0;
+    memset(block_->data, 0, sizeof(block_->data));
+    memset(streams_, 0, sizeof(streams_));
+}
+
+void GorillaEncoder::write(uint32_t value, uint8_t bits) {
+    while (bits > 0) {
+        uint16_t byte = block_->bits / 8;
+        uint8_t free_bits = 8 - block_->bits % 8;
+        uint8_t chunk = bits < free_bits ? bits : free_bits;
+        uint8_t part = (value >> (bits - chunk)) & ((1u << chunk) - 1);
+        block_->data[byte] |= part << (free_bits - chunk);
+        block_->bits += chunk;
+        bits -= chunk;
+    }
+}
+
+bool GorillaEncoder::append(uint8_t source, uint32_t timestamp, float value) {
+    if (source >= GorillaBlock::MAX_SOURCES ||
+        (size_t)block_->bits + MAX_SAMPLE_BITS > GorillaBlock::DATA_SIZE * 8) {
+        return false;
+    }
+    GorillaStream& stream = streams_[source];
+    uint32_t bits = float_bits(value);
+    write(source, SOURCE_BITS);
+
+    if (!stream.seen) {
+        write(timestamp, 32);
+        write(bits, 32);
+        stream = {true, timestamp, 0, bits, NO_WINDOW, 0};
+        block_->count++;
+        return true;
+    }
+
+    // Timestamp: delta-of-delta, zero for a stream sampled at a steady rate
+    int32_t delta = timestamp - stream.timestamp;
+    int32_t dod = delta - stream.delta;
+    if (dod == 0) {
+        write(0b0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        write(0b10, 2);
+        write(dod + 63, 7);
+    } else if (dod >= -255 && dod <= 256) {
+        write(0b110, 3);
+        write(dod + 255, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        write(0b1110, 4);
+        write(dod + 2047, 12);
+    } else {
+        write(0b1111, 4);
+        write(dod, 32);
+    }
+    stream.timestamp = timestamp;
+    stream.delta = delta;
+
+    // Value: XOR with the previous one, keeping only the meaningful bits
+    uint32_t xored = bits ^ stream.value;
+    if (xored == 0) {
+        write(0b0, 1);
+    } else {
+        uint8_t leading = __builtin_clz(xored);
+        uint8_t trailing = __builtin_ctz(xored);
+        if (stream.leading != NO_WINDOW && leading >= stream.leading && trailing >= stream.trailing) {
+            // Fits in the previous window
+            write(0b10, 2);
+            write(xored >> stream.trailing, 32 - stream.leading - stream.trailing);
+        } else {
+            uint8_t length = 32 - leading - trailing;
+            write(0b11, 2);
+            write(leading, 5);
+            write(length - 1, 5);
+            write(xored >> trailing, length);
+            stream.leading = leading;
+            stream.trailing = trailing;
+        }
+    }
+    stream.value = bits;
+    block_->count++;
+    return true;
+}
+
+void GorillaDecoder::reset() {
+    decoded_ = 0;
+    position_ = 0;
+    memset(streams_, 0, sizeof(streams_));
+}
+
+uint32_t GorillaDecoder::read(uint8_t bits) {
+    uint32_t value = 0;
+    while (bits > 0) {
+        uint16_t byte = position_ / 8;
+        if (byte >= GorillaBlock::DATA_SIZE) {
+            // Past the end of the block; next() reports it as corrupt
+            position_ += bits;
+            return 0;
+        }
+        uint8_t available = 8 - position_ % 8;
+        uint8_t chunk = bits < available ? bits : available;
+        uint8_t part = (block_->data[byte] >> (available - chunk)) & ((1u << chunk) - 1);
+        // Two shifts: a single shift by 32 is undefined
+        value = (value << (chunk - 1) << 1) | part;
+        position_ += chunk;
+        bits -= chunk;
+    }
+    return value;
+}
+
+bool GorillaDecoder::next(uint8_t* source, uint32_t* timestamp, float* value) {
+    if (done() || block_->bits > GorillaBlock::DATA_SIZE * 8) {
+        return false;
+    }
+    *source = read(SOURCE_BITS);
+    GorillaStream& stream = streams_[*source];
+
+    if (!stream.seen) {
+        uint32_t first_timestamp = read(32);
+        stream = {true, first_timestamp, 0, read(32), NO_WINDOW, 0};
+    } else {
+        int32_t dod;
+        if (read(1) == 0) {
+            dod = 0;
+        } else if (read(1) == 0) {
+            dod = (int32_t)read(7) - 63;
+        } else if (read(1) == 0) {
+            dod = (int32_t)read(9) - 255;
+        } else if (read(1) == 0) {
+            dod = (int32_t)read(12) - 2047;
+        } else {
+            dod = read(32);
+        }
+        stream.delta += dod;
+        stream.timestamp += stream.delta;
+
+        if (read(1) == 1) {
+            if (read(1) == 1) {
+                stream.leading = read(5);
+                uint8_t length = read(5) + 1;
+                if (stream.leading + length > 32) {
+                    decoded_ = block_->count;
+                    return false;
+                }
+                stream.trailing = 32 - stream.leading - length;
+            } else if (stream.leading == NO_WINDOW) {
+                decoded_ = block_->count;
+                return false;
+            }
+            uint8_t length = 32 - stream.leading - stream.trailing;
+            stream.value ^= read(length) << stream.trailing;
+        }
+    }
+
+    if (position_ > block_->bits) {
+        // Ran past the encoded data: the block is corrupt
+        decoded_ = block_->count;
+        return false;
+    }
+    *timestamp = stream.timestamp;
+    *value = bits_float(stream.value);
+    decoded_++;
+    return true;
+}
+
+}  // namespace sensesp
@@ -0,0 +1,87 @@
+#ifndef __SRC_GORILLA_CODEC_H__
+#define __SRC_GORILLA_CODEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace sensesp {
+
+/**
+ * @brief Fixed-size block of Gorilla-compressed (source, timestamp, value) samples
+ *
+ * Several interleaved streams share a block; each sample is tagged with its
+ * source. Per source, timestamps are stored as delta-of-delta and values as
+ * the XOR with the previous value (as in Facebook's Gorilla TSDB). Every
+ * block starts from a clean state, so blocks decode independently.
+ */
+struct GorillaBlock {
+    static const size_t DATA_SIZE = 250;
+    static const uint8_t MAX_SOURCES = 32;
+
+    uint16_t count;  // samples in the block
+    uint16_t bits;   // bits of `data` used
+    uint16_t boot;   // boot the timestamps were taken in; not touched by the codec
+    uint8_t data[DATA_SIZE];
+};
+
+// Compression state of one stream within a block
+struct GorillaStream {
+    bool seen;
+    uint32_t timestamp;
+    int32_t delta;
+    uint32_t value;
+    uint8_t leading;
+    uint8_t trailing;
+};
+
+/**
+ * @brief Appends samples to a GorillaBlock
+ *
+ * The encoder state is one GorillaStream per source, so appending costs a
+ * few shifts and never touches the samples already encoded.
+ */
+class GorillaEncoder {
+   public:
+    GorillaEncoder(GorillaBlock* block) : block_{block} { reset(); }
+
+    // Empties the block and forgets all the stream state
+    void reset();
+    // Encodes one sample; false if the block is full (the sample is not
+    // encoded) or `source` is out of range
+    bool append(uint8_t source, uint32_t timestamp, float value);
+
+   private:
+    void write(uint32_t value, uint8_t bits);
+
+    GorillaBlock* block_;
+    GorillaStream streams_[GorillaBlock::MAX_SOURCES];
+};
+
+/**
+ * @brief Streams the samples back out of a GorillaBlock
+ *
+ * Samples are decoded one at a time straight from the packed bits; the
+ * block is never expanded.
+ */
+class GorillaDecoder {
+   public:
+    GorillaDecoder(const GorillaBlock* block) : block_{block} { reset(); }
+
+    // Rewinds to the first sample
+    void reset();
+    // Decodes the next sample; false at the end of the block or on corrupt data
+    bool next(uint8_t* source, uint32_t* timestamp, float* value);
+    bool done() { return decoded_ >= block_->count; }
+
+   private:
+    uint32_t read(uint8_t bits);
+
+    const GorillaBlock* block_;
+    GorillaStream streams_[GorillaBlock::MAX_SOURCES];
+    uint16_t decoded_;
+    uint16_t position_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,37 @@
+#include "heap_telemetry.h"
+
+#include <esp_heap_caps.h>
+
+#include "pipeline_arena.h"
+#include "reaction_profiler.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp_base_app.h"
+
+namespace sensesp {
+
+HeapTelemetry::HeapTelemetry(uint interval) : interval_{interval} {
+    String prefix = "sensorDevice." + SensESPBaseApp::get_hostname() + ".heap.";
+    free_.connect_to(new SKOutputFloat(prefix + "free"));
+    largest_free_block_.connect_to(new SKOutputFloat(prefix + "largestFreeBlock"));
+    allocated_blocks_.connect_to(new SKOutputFloat(prefix + "allocatedBlocks"));
+    arena_used_.connect_to(new SKOutputFloat(prefix + "pipelineArenaUsed"));
+}
+
+void HeapTelemetry::start() {
+    PipelineArena* arena = PipelineArena::instance();
+    debugI("Pipeline arena: %u of %u bytes used, %u heap fallbacks",
+           arena->used(), arena->capacity(), arena->overflows());
+    ReactESP::app->onRepeat(interval_, PROFILED("heap_telemetry", interval_, [this]() { this->update(); }));
+    update();
+}
+
+void HeapTelemetry::update() {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    free_.set(info.total_free_bytes);
+    largest_free_block_.set(info.largest_free_block);
+    allocated_blocks_.set(info.allocated_blocks);
+    arena_used_.set(PipelineArena::instance()->used());
+}
+
+}  // namespace sensesp
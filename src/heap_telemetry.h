@@ -0,0 +1,35 @@
+#ifndef __SRC_HEAP_TELEMETRY_H__
+#define __SRC_HEAP_TELEMETRY_H__
+
+#include "sensesp.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/system/startable.h"
+
+namespace sensesp {
+
+/**
+ * @brief Reports heap fragmentation to Signal K
+ *
+ * Free heap alone hides fragmentation; the largest free block shrinking
+ * while the free heap stays flat is the sign of it. Every `interval` ms the
+ * free heap, largest free block, number of allocated blocks and pipeline
+ * arena usage are published under sensorDevice.<hostname>.heap.
+ */
+class HeapTelemetry : public Startable {
+   public:
+    HeapTelemetry(uint interval = 60000);
+    void start() override final;
+
+   private:
+    void update();
+
+    uint interval_;
+    ObservableValue<float> free_;
+    ObservableValue<float> largest_free_block_;
+    ObservableValue<float> allocated_blocks_;
+    ObservableValue<float> arena_used_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,234 @@
+#include "history_store.h"
+
+#include <time.h>
+
+#include "reaction_profiler.h"
+#include "sensesp/system/lambda_consumer.h"
+
+namespace sensesp {
+
+static const size_t SECONDS_POINTS = 600;  // 10 minutes
+static const uint32_t MINUTES_PERIOD = 60;
+static const size_t MINUTES_POINTS_PER_BLOCK = 10;
+static const size_t MINUTES_BLOCKS = 144;  // 24 hours
+static const uint32_t QUARTERS_PERIOD = 15 * 60;
+static const size_t QUARTERS_POINTS_PER_BLOCK = 8;
+static const size_t QUARTERS_BLOCKS = 360;  // 30 days
+
+// Quantized value of a point without samples
+static const int16_t POINT_NA = INT16_MIN;
+
+// Earlier wall clock times mean SNTP has not set the clock yet (2020-09-13)
+static const time_t MIN_VALID_TIME = 1600000000;
+
+HistoryStore::HistoryStore(DiagnosticsServer* server) : server_{server} {
+    lock_ = xSemaphoreCreateMutex();
+    size_t block = block_size(max(MINUTES_POINTS_PER_BLOCK, QUARTERS_POINTS_PER_BLOCK));
+    request_points_ = new Point[SECONDS_POINTS];
+    request_block_ = new uint8_t[block];
+    request_filling_ = new uint8_t[block];
+}
+
+bool HistoryStore::track(ValueProducer<float>* producer, String path, float resolution, float offset) {
+    // FlashRing slots add a sequence number and a CRC to each block
+    size_t ram = sizeof(Series) + SECONDS_POINTS * sizeof(Point) +
+                 block_size(MINUTES_POINTS_PER_BLOCK) + block_size(QUARTERS_POINTS_PER_BLOCK);
+    size_t flash = MINUTES_BLOCKS * (block_size(MINUTES_POINTS_PER_BLOCK) + 8) +
+                   QUARTERS_BLOCKS * (block_size(QUARTERS_POINTS_PER_BLOCK) + 8);
+    if (ram_used_ + ram > RAM_BUDGET || flash_used_ + flash > FLASH_BUDGET) {
+        debugE("History budget exceeded, not tracking %s", path.c_str());
+        return false;
+    }
+    ram_used_ += ram;
+    flash_used_ += flash;
+
+    auto series = new Series();
+    series->path = path;
+    series->resolution = resolution;
+    series->offset = offset;
+    for (auto& accumulator : series->accumulators) {
+        accumulator = {0, 0, 0, 0};
+    }
+    series->seconds = new Point[SECONDS_POINTS];
+    series->seconds_count = 0;
+    series->seconds_head = 0;
+
+    // Flash ring files are named after the path index to stay within the SPIFFS name limit
+    String prefix = "/history" + String(series_.size());
+    series->tiers[0] = {MINUTES_PERIOD, MINUTES_POINTS_PER_BLOCK,
+                        new FlashRing(prefix + "m", block_size(MINUTES_POINTS_PER_BLOCK), MINUTES_BLOCKS),
+                        new uint8_t[block_size(MINUTES_POINTS_PER_BLOCK)], 0};
+    series->tiers[1] = {QUARTERS_PERIOD, QUARTERS_POINTS_PER_BLOCK,
+                        new FlashRing(prefix + "q", block_size(QUARTERS_POINTS_PER_BLOCK), QUARTERS_BLOCKS),
+                        new uint8_t[block_size(QUARTERS_POINTS_PER_BLOCK)], 0};
+    series_.push_back(series);
+
+    producer->connect_to(new LambdaConsumer<float>([this, series](float value) {
+        this->add(*series, value);
+    }));
+    return true;
+}
+
+void HistoryStore::start() {
+    for (auto series : series_) {
+        for (auto& tier : series->tiers) {
+            tier.ring->begin();
+        }
+    }
+    ReactESP::app->onRepeat(1000, PROFILED("history_tick", 1000, [this]() { this->tick(); }));
+    server_->add_handler("/history", [this](httpd_req_t* req) { return this->handle_request(req); });
+}
+
+void HistoryStore::add(Series& series, float value) {
+    for (auto& accumulator : series.accumulators) {
+        if (accumulator.count == 0) {
+            accumulator.min = value;
+            accumulator.max = value;
+            accumulator.sum = 0;
+        }
+        accumulator.min = min(accumulator.min, value);
+        accumulator.max = max(accumulator.max, value);
+        accumulator.sum += value;
+        accumulator.count++;
+    }
+}
+
+void HistoryStore::tick() {
+    time_t now = time(nullptr);
+    if (now < MIN_VALID_TIME) {
+        // Points can't be timestamped yet: drop the samples
+        for (auto series : series_) {
+            for (auto& accumulator : series->accumulators) {
+                accumulator.count = 0;
+            }
+        }
+        return;
+    }
+
+    ticks_++;
+    xSemaphoreTake(lock_, portMAX_DELAY);
+    last_tick_time_ = now;
+    for (auto series : series_) {
+        series->seconds[series->seconds_head] = close(*series, series->accumulators[0]);
+        series->seconds_head = (series->seconds_head + 1) % SECONDS_POINTS;
+        series->seconds_count = min(series->seconds_count + 1, SECONDS_POINTS);
+
+        for (int i = 0; i < 2; i++) {
+            FlashTier& tier = series->tiers[i];
+            if (ticks_ % tier.period == 0) {
+                append(tier, close(*series, series->accumulators[i + 1]), now);
+            }
+        }
+    }
+    xSemaphoreGive(lock_);
+}
+
+HistoryStore::Point HistoryStore::close(Series& series, Accumulator& accumulator) {
+    auto quantize = [&series](float value) {
+        float quantized = roundf((value - series.offset) / series.resolution);
+        return (int16_t)constrain(quantized, -32767.0f, 32767.0f);
+    };
+    Point point = {POINT_NA, POINT_NA, POINT_NA};
+    if (accumulator.count > 0) {
+        point = {quantize(accumulator.min), quantize(accumulator.max), quantize(accumulator.sum / accumulator.count)};
+    }
+    accumulator.count = 0;
+    return point;
+}
+
+void HistoryStore::append(FlashTier& tier, Point point, uint32_t now) {
+    if (tier.block_points == 0) {
+        uint32_t start = now - tier.period;
+        memcpy(tier.block, &start, sizeof(start));
+    }
+    memcpy(tier.block + block_size(tier.block_points), &point, sizeof(point));
+    tier.block_points++;
+    if (tier.block_points == tier.points_per_block) {
+        tier.ring->append(tier.block);
+        tier.block_points = 0;
+    }
+}
+
+esp_err_t HistoryStore::handle_request(httpd_req_t* req) {
+    String path = DiagnosticsServer::query_param(req, "path");
+    int tier = DiagnosticsServer::query_param(req, "tier", "0").toInt();
+    uint32_t from = DiagnosticsServer::query_param(req, "from", "0").toInt();
+    uint32_t to = DiagnosticsServer::query_param(req, "to", "4294967295").toInt();
+
+    Series* series = nullptr;
+    for (auto candidate : series_) {
+        if (candidate->path == path) {
+            series = candidate;
+        }
+    }
+    if (series == nullptr || tier < 0 || tier > 2) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown path or tier");
+    }
+
+    httpd_resp_set_type(req, "text/csv");
+    char chunk[512];
+    size_t length = snprintf(chunk, sizeof(chunk), "time,min,max,mean\n");
+
+    auto write_point = [&](uint32_t timestamp, const Point& point) {
+        if (timestamp < from || timestamp > to || point.mean == POINT_NA) {
+            return;
+        }
+        if (length > sizeof(chunk) - 64) {
+            httpd_resp_send_chunk(req, chunk, length);
+            length = 0;
+        }
+        length += snprintf(chunk + length, sizeof(chunk) - length, "%u,%g,%g,%g\n", timestamp,
+                           series->offset + point.min * series->resolution,
+                           series->offset + point.max * series->resolution,
+                           series->offset + point.mean * series->resolution);
+    };
+
+    if (tier == 0) {
+        // Copy the 1 s points, oldest first, so the main loop isn't held up
+        // while they are sent
+        Point* points = request_points_;
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        uint32_t newest = last_tick_time_;
+        size_t count = series->seconds_count;
+        size_t oldest = (series->seconds_head + SECONDS_POINTS - count) % SECONDS_POINTS;
+        for (size_t i = 0; i < count; i++) {
+            points[i] = series->seconds[(oldest + i) % SECONDS_POINTS];
+        }
+        xSemaphoreGive(lock_);
+        for (size_t i = 0; i < count; i++) {
+            write_point(newest - (count - 1 - i), points[i]);
+        }
+    } else {
+        FlashTier& flash_tier = series->tiers[tier - 1];
+        // Blocks are streamed one at a time, oldest first, then a copy of
+        // the block being filled. The ring has a lock of its own.
+        uint8_t* block = request_block_;
+        uint8_t* filling = request_filling_;
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        size_t blocks = flash_tier.ring->size();
+        size_t filling_points = flash_tier.block_points;
+        memcpy(filling, flash_tier.block, block_size(filling_points));
+        xSemaphoreGive(lock_);
+        for (size_t b = 0; b <= blocks; b++) {
+            size_t points = flash_tier.points_per_block;
+            if (b == blocks) {
+                memcpy(block, filling, block_size(filling_points));
+                points = filling_points;
+            } else if (!flash_tier.ring->read(b, block)) {
+                continue;
+            }
+            uint32_t start;
+            memcpy(&start, block, sizeof(start));
+            for (size_t i = 0; i < points; i++) {
+                Point point;
+                memcpy(&point, block + block_size(i), sizeof(point));
+                write_point(start + (i + 1) * flash_tier.period, point);
+            }
+        }
+    }
+
+    httpd_resp_send_chunk(req, chunk, length);
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+}  // namespace sensesp
@@ -0,0 +1,108 @@
+#ifndef __SRC_HISTORY_STORE_H__
+#define __SRC_HISTORY_STORE_H__
+
+#include <freertos/semphr.h>
+
+#include <vector>
+
+#include "diagnostics_server.h"
+#include "flash_ring.h"
+#include "sensesp.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+/**
+ * @brief Round-robin history of sensor values at three resolutions
+ *
+ * Every tracked path keeps min/max/mean points in three tiers:
+ * - 1 s points for the last 10 minutes, in RAM
+ * - 1 min points for the last 24 hours, in a flash ring
+ * - 15 min points for the last 30 days, in a flash ring
+ *
+ * Points are quantized to int16 with a per-path resolution and offset (6
+ * bytes per point) and all the buffers are allocated when a path is tracked,
+ * so adding a sample never allocates. Flash tiers are written in blocks of
+ * several points: one write every 10 minutes and every 2 hours per path.
+ *
+ * Each path costs about 3.8 KB of RAM and 31 KB of flash. Paths that would
+ * exceed RAM_BUDGET or FLASH_BUDGET are refused. The request buffers below
+ * take another 3.7 KB, whatever the number of paths.
+ *
+ * Points are timestamped with the wall clock, so nothing is recorded until
+ * SNTP has set it.
+ *
+ * GET /history?path=<path>&tier=<0|1|2>[&from=<epoch s>][&to=<epoch s>] on
+ * the diagnostics server streams the points as CSV straight from storage.
+ * The request runs in the HTTP server task; it copies the RAM buffers under
+ * `lock_`, which the main loop holds while it updates them, into request
+ * buffers allocated with the store. The HTTP server handles one request at
+ * a time, so they are never shared.
+ */
+class HistoryStore {
+   public:
+    static const size_t RAM_BUDGET = 16 * 1024;
+    static const size_t FLASH_BUDGET = 96 * 1024;
+
+    HistoryStore(DiagnosticsServer* server);
+    // Tracks `producer` under `path`; false if it would exceed the budgets
+    bool track(ValueProducer<float>* producer, String path, float resolution, float offset = 0);
+    void start();
+
+   private:
+    struct __attribute__((packed)) Point {
+        int16_t min;
+        int16_t max;
+        int16_t mean;
+    };
+
+    struct Accumulator {
+        float min;
+        float max;
+        float sum;
+        uint32_t count;
+    };
+
+    struct FlashTier {
+        uint32_t period;  // seconds per point
+        size_t points_per_block;
+        FlashRing* ring;
+        uint8_t* block;  // uint32_t start time followed by the points
+        size_t block_points;
+    };
+
+    struct Series {
+        String path;
+        float resolution;
+        float offset;
+        Accumulator accumulators[3];
+        Point* seconds;
+        size_t seconds_count;
+        size_t seconds_head;
+        FlashTier tiers[2];
+    };
+
+    static size_t block_size(size_t points) { return sizeof(uint32_t) + points * sizeof(Point); }
+
+    void add(Series& series, float value);
+    void tick();
+    Point close(Series& series, Accumulator& accumulator);
+    void append(FlashTier& tier, Point point, uint32_t now);
+    esp_err_t handle_request(httpd_req_t* req);
+
+    DiagnosticsServer* server_;
+    SemaphoreHandle_t lock_;
+    // Request buffers: the 1 s points, a flash block and the block being filled
+    Point* request_points_;
+    uint8_t* request_block_;
+    uint8_t* request_filling_;
+    std::vector<Series*> series_;
+    size_t ram_used_ = 0;
+    size_t flash_used_ = 0;
+    uint32_t ticks_ = 0;
+    uint32_t last_tick_time_ = 0;  // wall clock time of the newest 1 s point
+};
+
+}  // namespace sensesp
+
+#endif
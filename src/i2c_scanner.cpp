@@ -0,0 +1,56 @@
+#include "i2c_scanner.h"
+
+namespace sensesp {
+
+// Longest wait for the acquisition task to finish a scan (ms)
+static const uint32_t SCAN_TIMEOUT = 2000;
+
+I2cScanner::I2cScanner(TwoWire* i2c, AcquisitionTask* acquisition, DiagnosticsServer* server)
+    : i2c_{i2c} {
+    busy_ = xSemaphoreCreateMutex();
+    done_ = xSemaphoreCreateBinary();
+    acquisition->reactor()->onRepeat(POLL_INTERVAL, [this]() {
+        if (requested_) {
+            this->scan();
+            requested_ = false;
+            xSemaphoreGive(done_);
+        }
+    });
+    server->add_handler("/i2c", [this](httpd_req_t* req) { return this->handle(req); });
+}
+
+void I2cScanner::scan() {
+    result_ = "";
+    for (uint8_t address = 1; address < 127; address++) {
+        i2c_->beginTransmission(address);
+        uint8_t error = i2c_->endTransmission();
+
+        char line[48];
+        if (error == 0) {
+            snprintf(line, sizeof(line), "I2C device found at address 0x%02X\n", address);
+            result_ += line;
+        } else if (error == 4) {
+            snprintf(line, sizeof(line), "Unknown error at address 0x%02X\n", address);
+            result_ += line;
+        }
+    }
+    result_ += "done\n";
+}
+
+esp_err_t I2cScanner::handle(httpd_req_t* req) {
+    // One scan at a time; a stale completion from a timed out scan is dropped
+    xSemaphoreTake(busy_, portMAX_DELAY);
+    xSemaphoreTake(done_, 0);
+    requested_ = true;
+    if (xSemaphoreTake(done_, pdMS_TO_TICKS(SCAN_TIMEOUT)) != pdTRUE) {
+        xSemaphoreGive(busy_);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "I2C scan timed out");
+    }
+    String result = result_;
+    xSemaphoreGive(busy_);
+
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_send(req, result.c_str(), result.length());
+}
+
+}  // namespace sensesp
@@ -0,0 +1,40 @@
+#ifndef __SRC_I2C_SCANNER_H__
+#define __SRC_I2C_SCANNER_H__
+
+#include <Wire.h>
+#include <freertos/semphr.h>
+
+#include "acquisition_task.h"
+#include "diagnostics_server.h"
+#include "sensesp.h"
+
+namespace sensesp {
+
+/**
+ * @brief On-demand scan of the I2C bus, served at /i2c
+ *
+ * The bus is shared with the ADS1115, so the scan runs in the acquisition
+ * task between two ADC reactions rather than in the HTTP server task. Must
+ * be created before the acquisition task starts.
+ */
+class I2cScanner {
+   public:
+    I2cScanner(TwoWire* i2c, AcquisitionTask* acquisition, DiagnosticsServer* server);
+
+   private:
+    // How often the acquisition task checks for a scan request (ms)
+    static const uint POLL_INTERVAL = 100;
+
+    void scan();
+    esp_err_t handle(httpd_req_t* req);
+
+    TwoWire* i2c_;
+    String result_;
+    volatile bool requested_ = false;
+    SemaphoreHandle_t busy_;
+    SemaphoreHandle_t done_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,54 @@
+#include "mcpwm_edge_capture.h"
+
+namespace sensesp {
+
+McpwmEdgeCapture::McpwmEdgeCapture(int pin, uint8_t prescale, mcpwm_unit_t unit)
+    : pin_{pin},
+      prescale_{prescale},
+      unit_{unit} {}
+
+void McpwmEdgeCapture::begin() {
+    mcpwm_gpio_init(unit_, MCPWM_CAP_0, pin_);
+
+    mcpwm_capture_config_t config = {};
+    config.cap_edge = MCPWM_POS_EDGE;
+    config.cap_prescale = prescale_;
+    config.capture_cb = on_capture;
+    config.user_data = this;
+    mcpwm_capture_enable_channel(unit_, MCPWM_SELECT_CAP0, &config);
+}
+
+bool IRAM_ATTR McpwmEdgeCapture::on_capture(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel,
+                                            const cap_event_data_t* event, void* user_data) {
+    auto capture = static_cast<McpwmEdgeCapture*>(user_data);
+    uint32_t head = capture->head_;
+    // Once an edge is dropped, drop the following ones too until the event
+    // loop has seen the overflow, so every gap is at the end of the buffer
+    if (capture->overflow_ || head - capture->tail_ >= BUFFER_SIZE) {
+        capture->overflow_ = true;
+        return false;
+    }
+    capture->buffer_[head & (BUFFER_SIZE - 1)] = event->cap_value;
+    capture->head_ = head + 1;
+    return false;
+}
+
+bool McpwmEdgeCapture::next_edge(uint32_t* timestamp) {
+    uint32_t tail = tail_;
+    if (tail == head_) {
+        return false;
+    }
+    *timestamp = buffer_[tail & (BUFFER_SIZE - 1)];
+    tail_ = tail + 1;
+    return true;
+}
+
+bool McpwmEdgeCapture::take_overflow() {
+    if (!overflow_) {
+        return false;
+    }
+    overflow_ = false;
+    return true;
+}
+
+}  // namespace sensesp
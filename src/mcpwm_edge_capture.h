@@ -0,0 +1,47 @@
+#ifndef __SRC_MCPWM_EDGE_CAPTURE_H__
+#define __SRC_MCPWM_EDGE_CAPTURE_H__
+
+#include <Arduino.h>
+#include <driver/mcpwm.h>
+
+#include "edge_capture.h"
+
+namespace sensesp {
+
+/**
+ * @brief Timestamps rising edges with the ESP32 MCPWM capture unit
+ *
+ * The capture unit latches the APB clock (80 MHz) on every `prescale`th
+ * rising edge, so the interrupt rate is the pulse rate divided by
+ * `prescale`. The capture interrupt only pushes the timestamp into a ring
+ * buffer that is drained from the event loop. If the event loop falls a
+ * full buffer behind, edges are dropped until it has drained the buffer
+ * and seen the overflow.
+ */
+class McpwmEdgeCapture : public EdgeCapture {
+   public:
+    McpwmEdgeCapture(int pin, uint8_t prescale = 1, mcpwm_unit_t unit = MCPWM_UNIT_0);
+    void begin() override;
+    bool next_edge(uint32_t* timestamp) override;
+    bool take_overflow() override;
+    uint32_t edges_per_timestamp() override { return prescale_; }
+    uint32_t ticks_per_second() override { return APB_CLK_FREQ; }
+
+   private:
+    static const size_t BUFFER_SIZE = 64;  // Must be a power of two
+
+    static bool IRAM_ATTR on_capture(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel,
+                                     const cap_event_data_t* event, void* user_data);
+
+    int pin_;
+    uint8_t prescale_;
+    mcpwm_unit_t unit_;
+    uint32_t buffer_[BUFFER_SIZE];
+    volatile uint32_t head_ = 0;
+    volatile uint32_t tail_ = 0;
+    volatile bool overflow_ = false;
+};
+
+}  // namespace sensesp
+
+#endif
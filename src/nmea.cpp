@@ -1,11 +1,25 @@
 #include "nmea.h"
 
+#include "boot_profiler.h"
+#include "reaction_profiler.h"
 #include "sensesp/system/valueproducer.h"
 
 namespace sensesp {
 
+// Longest time between ParseMessages() calls on a quiet bus, for address
+// claiming, heartbeats and frames waiting to be sent (ms)
+static const uint32_t PARSE_INTERVAL = 50;
+
+// Received PGNs and their handlers. Must be sorted by PGN.
+const Nmea::ReceiveHandler Nmea::RECEIVE_HANDLERS[] = {
+    {127508L, &Nmea::handleBatteryStatus},
+    {130312L, &Nmea::handleTemperature},
+    {130316L, &Nmea::handleTemperatureExtendedRange},
+};
+const size_t Nmea::RECEIVE_HANDLER_COUNT = sizeof(RECEIVE_HANDLERS) / sizeof(RECEIVE_HANDLERS[0]);
+
 Nmea::Nmea() {
-    nmea2000_ = new tNMEA2000_esp32(CAN_TX_PIN, CAN_RX_PIN);
+    nmea2000_ = new QueueAwareNmea2000(CAN_TX_PIN, CAN_RX_PIN);
 
     // Reserve enough buffer for sending all messages. This does not work on small
     // memory devices like Uno or Mega
@@ -34,80 +48,232 @@ Nmea::Nmea() {
     nmea2000_->SetMode(tNMEA2000::N2km_NodeOnly, 22);
     // Disable all msg forwarding to USB (=Serial)
     nmea2000_->EnableForward(false);
+    nmea2000_->AttachMsgHandler(new Dispatcher(this));
     nmea2000_->Open();
 
-    // No need to parse the messages at every single loop iteration; 1 ms will do
-    ReactESP::app->onRepeat(1, [&]() { nmea2000_->ParseMessages(); });
+    ReactESP::app->onTick(PROFILED("nmea_parse", 0, [this]() { this->parseMessages(); }));
+
+    // Incoming values only mark their PGN dirty; each PGN is then sent at most
+    // once per period with the latest values. Steady values are repeated
+    // after the heartbeat, as receivers time a PGN out when it stops
+    // arriving. PGNs without any value yet are not sent at all.
+    for (int slot = 0; slot < kTransmitSlotCount; slot++) {
+        uint period = schedule_[slot].period;
+        ReactESP::app->onRepeat(period, PROFILED(schedule_[slot].name, period, [this, slot, period]() {
+            TransmitSchedule &schedule = schedule_[slot];
+            // Half a period of slack for the jitter of the repeat reaction
+            bool heartbeat_due = millis() - schedule.last_sent + period / 2 >= schedule.heartbeat;
+            if (schedule.has_value && (schedule.dirty || heartbeat_due)) {
+                this->transmit((TransmitSlot)slot);
+            }
+        }));
+    }
+}
+
+void Nmea::markDirty(TransmitSlot slot) {
+    schedule_[slot].dirty = true;
+    schedule_[slot].has_value = true;
+}
+
+void Nmea::transmit(TransmitSlot slot) {
+    TransmitSchedule &schedule = schedule_[slot];
+    schedule.dirty = false;
+    schedule.last_sent = millis();
+    (this->*schedule.send)();
+}
+
+/**
+ * @brief Run the NMEA 2000 stack when there is something to do
+ *
+ * The CAN interrupt queues received frames; checking that queue is cheap,
+ * so messages are parsed as soon as a frame arrives. On a quiet bus the
+ * stack still runs every PARSE_INTERVAL ms for its own housekeeping.
+ */
+void Nmea::parseMessages() {
+    uint32_t now = millis();
+    if (nmea2000_->frames_pending() || now - last_parse_ >= PARSE_INTERVAL) {
+        last_parse_ = now;
+        nmea2000_->ParseMessages();
+    }
+}
+
+void Nmea::dispatch(const tN2kMsg &msg) {
+    // Binary search of the dispatch table
+    size_t low = 0;
+    size_t high = RECEIVE_HANDLER_COUNT;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (RECEIVE_HANDLERS[middle].pgn < msg.PGN) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low < RECEIVE_HANDLER_COUNT && RECEIVE_HANDLERS[low].pgn == msg.PGN) {
+        (this->*RECEIVE_HANDLERS[low].handle)(msg);
+    }
+}
+
+void Nmea::handleBatteryStatus(const tN2kMsg &msg) {
+    unsigned char instance;
+    double voltage;
+    double current;
+    double temperature;
+    unsigned char sid;
+    if (ParseN2kPGN127508(msg, instance, voltage, current, temperature, sid) &&
+        instance == N2K_BATTERY_INSTANCE && !N2kIsNA(voltage)) {
+        // The N2k API works in double; values are kept in float from here on
+        battery_voltage_.set(voltage);
+    }
+}
+
+void Nmea::handleTemperature(const tN2kMsg &msg) {
+    unsigned char sid;
+    unsigned char instance;
+    tN2kTempSource source;
+    double actual;
+    double set;
+    if (ParseN2kPGN130312(msg, sid, instance, source, actual, set)) {
+        receiveTemperature(source, actual);
+    }
+}
+
+void Nmea::handleTemperatureExtendedRange(const tN2kMsg &msg) {
+    unsigned char sid;
+    unsigned char instance;
+    tN2kTempSource source;
+    double actual;
+    double set;
+    if (ParseN2kPGN130316(msg, sid, instance, source, actual, set)) {
+        receiveTemperature(source, actual);
+    }
+}
+
+void Nmea::receiveTemperature(tN2kTempSource source, float temperature) {
+    if (source == N2kts_OutsideTemperature && temperature != N2kFloatNA) {
+        ambient_temperature_.set(temperature);
+    }
 }
 
 void Nmea::connect_oil_temperature(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
         oil_temperature_ = value;
-        this->sendEngineData();
+        this->markDirty(kEngineDataSlot);
     }));
 }
 
 void Nmea::connect_oil_pressure(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
         oil_pressure_ = value;
-        this->sendEngineData();
+        this->markDirty(kEngineDataSlot);
     }));
 }
 
 void Nmea::connect_coolant_temperature(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
         coolant_temperature_ = value;
-        this->sendEngineData();
+        this->markDirty(kEngineDataSlot);
     }));
 }
 
 void Nmea::connect_exhaust_temperature(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
-        this->sendExhaustTemperature(value);
+        exhaust_temperature_ = value;
+        this->markDirty(kExhaustTemperatureSlot);
     }));
 }
 
 void Nmea::connect_engine_rpms(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
-        this->sendEngineRpms(value);
+        engine_rpms_ = value;
+        this->markDirty(kEngineRpmsSlot);
     }));
 }
 
 void Nmea::connect_engine_run_time(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
-        engine_hours_ = round(value / 60 / 60);
-        this->sendEngineData();
+        engine_hours_ = roundf(value / 3600.0f);
+        this->markDirty(kEngineDataSlot);
     }));
 }
 
 void Nmea::connect_water_level(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
         water_level_ = value;
-        this->sendWaterTankData();
+        this->markDirty(kWaterTankSlot);
     }));
 }
 
 void Nmea::connect_water_capacity(ValueProducer<float> *p) {
-    p->connect_to(new LambdaConsumer<float>([&](float value) {
-        water_capacity_ = value;
-        this->sendWaterTankData();
-    }));
+    // Sent with the next level update rather than in a PGN of its own
+    p->connect_to(new LambdaConsumer<float>([&](float value) { water_capacity_ = value; }));
 }
 
 void Nmea::connect_fuel_level(ValueProducer<float> *p) {
     p->connect_to(new LambdaConsumer<float>([&](float value) {
         fuel_level_ = value;
-        this->sendFuelTankData();
+        this->markDirty(kFuelTankSlot);
     }));
 }
 
 void Nmea::connect_fuel_capacity(ValueProducer<float> *p) {
-    p->connect_to(new LambdaConsumer<float>([&](float value) {
-        fuel_capacity_ = value;
-        this->sendFuelTankData();
+    // Sent with the next level update rather than in a PGN of its own
+    p->connect_to(new LambdaConsumer<float>([&](float value) { fuel_capacity_ = value; }));
+}
+
+void Nmea::connect_over_temperature_alarm(EngineAlarm *alarm) {
+    connect_alarm(alarm, [this](bool active) { engine_status1_.Bits.OverTemperature = active; });
+}
+
+void Nmea::connect_low_oil_pressure_alarm(EngineAlarm *alarm) {
+    connect_alarm(alarm, [this](bool active) { engine_status1_.Bits.LowOilPressure = active; });
+}
+
+// Wet exhaust overheating means the raw water flow has failed
+void Nmea::connect_water_flow_alarm(EngineAlarm *alarm) {
+    connect_alarm(alarm, [this](bool active) { engine_status1_.Bits.WaterFlow = active; });
+}
+
+void Nmea::connect_alarm(EngineAlarm *alarm, std::function<void(bool)> set_status) {
+    alarm->connect_to(new LambdaConsumer<bool>([this, alarm, set_status](bool active) {
+        set_status(active);
+        this->sendEngineAlarm(alarm);
     }));
 }
 
+/**
+ * @brief Send an alarm transition right away
+ *
+ * Sends the Engine Dynamic Parameter PGN outside of the transmit schedule,
+ * and logs the time from the acquisition of the sample that caused the
+ * transition to the frame being queued for the bus.
+ */
+void Nmea::sendEngineAlarm(EngineAlarm *alarm) {
+    // Any active alarm also raises the check engine and warning lights
+    bool any_alarm = engine_status1_.Bits.OverTemperature ||
+                     engine_status1_.Bits.LowOilPressure ||
+                     engine_status1_.Bits.WaterFlow;
+    engine_status1_.Bits.CheckEngine = any_alarm;
+    engine_status2_.Bits.WarningLevel1 = any_alarm;
+
+    // Also restarts the heartbeat of the scheduled PGN 127489
+    markDirty(kEngineDataSlot);
+    transmit(kEngineDataSlot);
+
+    uint32_t latency = micros() - alarm->sample_timestamp();
+    max_alarm_latency_ = max(max_alarm_latency_, latency);
+    debugI("Engine alarm sent %u us after its sample (worst %u us)", latency, max_alarm_latency_);
+}
+
+void Nmea::send(const tN2kMsg &msg) {
+    nmea2000_->SendMsg(msg);
+    if (!first_frame_sent_) {
+        // Boot time metric: how long until the engine data reaches the bus
+        first_frame_sent_ = true;
+        BootProfiler::instance()->mark("First NMEA 2000 frame sent");
+    }
+}
+
 void Nmea::sendWaterTankData() {
     tN2kMsg N2kMsg;
     SetN2kFluidLevel(
@@ -116,7 +282,7 @@ void Nmea::sendWaterTankData() {
         N2kft_Water,
         water_level_,
         water_capacity_);
-    nmea2000_->SendMsg(N2kMsg);
+    send(N2kMsg);
 }
 
 void Nmea::sendFuelTankData() {
@@ -127,16 +293,15 @@ void Nmea::sendFuelTankData() {
         N2kft_Fuel,
         fuel_level_,
         fuel_capacity_);
-    nmea2000_->SendMsg(N2kMsg);
+    send(N2kMsg);
 }
 
 /**
  * @brief Send Engine Dynamic Parameter data
  *
  * Send engine  data using the Engine Dynamic Parameter PGN.
- * All unused fields that are sent with undefined value except the status
- * bit fields are sent as zero. Hopefully we're not resetting anybody's engine
- * warnings...
+ * All unused fields are sent with undefined value; the status bit fields
+ * carry the engine alarms.
  */
 void Nmea::sendEngineData() {
     tN2kMsg N2kMsg;
@@ -152,31 +317,33 @@ void Nmea::sendEngineData() {
                              N2kDoubleNA,           // engine fuel pressure
                              N2kInt8NA,             // engine load
                              N2kInt8NA,             // engine torque
-                             (tN2kEngineDiscreteStatus1)0,
-                             (tN2kEngineDiscreteStatus2)0);
-    nmea2000_->SendMsg(N2kMsg);
+                             engine_status1_,
+                             engine_status2_);
+    send(N2kMsg);
 }
 
-void Nmea::sendExhaustTemperature(float temperature) {
+void Nmea::sendExhaustTemperature() {
     tN2kMsg N2kMsg;
     // hijack the exhaust gas temperature for wet exhaust temperature measurement
     SetN2kTemperature(N2kMsg,
-                      1,                            // SID
+                      sid_,                         // SID
                       2,                            // TempInstance
                       N2kts_ExhaustGasTemperature,  // TempSource
-                      temperature                   // actual temperature
+                      exhaust_temperature_          // actual temperature
     );
-    nmea2000_->SendMsg(N2kMsg);
+    // SIDs 253-255 are reserved
+    sid_ = (sid_ + 1) % 253;
+    send(N2kMsg);
 }
 
-void Nmea::sendEngineRpms(float rpms) {
+void Nmea::sendEngineRpms() {
     tN2kMsg N2kMsg;
     SetN2kPGN127488(
         N2kMsg,
-        1,    // SID
-        rpms  // RPMs
+        0,            // instance of a single engine is always 0
+        engine_rpms_  // RPMs
     );
-    nmea2000_->SendMsg(N2kMsg);
+    send(N2kMsg);
 }
 
 }  // namespace sensesp
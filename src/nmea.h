@@ -5,15 +5,28 @@
 #include <NMEA2000_esp32.h>
 
 #include "configuration.h"
+#include "engine_alarm.h"
 #include "sensesp.h"
 #include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
 
 namespace sensesp {
 
+// tNMEA2000_esp32 that can tell whether the CAN interrupt queued any frames
+class QueueAwareNmea2000 : public tNMEA2000_esp32 {
+   public:
+    using tNMEA2000_esp32::tNMEA2000_esp32;
+    bool frames_pending() { return !RxQueue->isEmpty(); }
+};
+
 class Nmea {
    public:
     Nmea();
 
+    // Values received from other devices on the bus
+    ValueProducer<float> *battery_voltage() { return &battery_voltage_; }
+    ValueProducer<float> *ambient_temperature() { return &ambient_temperature_; }
+
     void connect_oil_temperature(ValueProducer<float> *p);
     void connect_oil_pressure(ValueProducer<float> *p);
     void connect_coolant_temperature(ValueProducer<float> *p);
@@ -24,24 +37,93 @@ class Nmea {
     void connect_water_capacity(ValueProducer<float> *p);
     void connect_fuel_level(ValueProducer<float> *p);
     void connect_fuel_capacity(ValueProducer<float> *p);
+    void connect_over_temperature_alarm(EngineAlarm *alarm);
+    void connect_low_oil_pressure_alarm(EngineAlarm *alarm);
+    void connect_water_flow_alarm(EngineAlarm *alarm);
 
    private:
-    void
-    sendEngineData();
-    void sendExhaustTemperature(float temperature);
-    void sendEngineRpms(float rpms);
+    // PGNs sent by the transmit scheduler, each on its own period
+    enum TransmitSlot {
+        kEngineRpmsSlot,
+        kEngineDataSlot,
+        kExhaustTemperatureSlot,
+        kWaterTankSlot,
+        kFuelTankSlot,
+        kTransmitSlotCount
+    };
+
+    struct TransmitSchedule {
+        const char *name;
+        uint period;
+        uint heartbeat;  // longest silence while the values are steady (ms)
+        void (Nmea::*send)();
+        bool dirty = false;
+        bool has_value = false;
+        uint32_t last_sent = 0;
+    };
+
+    struct ReceiveHandler {
+        unsigned long pgn;
+        void (Nmea::*handle)(const tN2kMsg &msg);
+    };
+
+    // Hands every received message to the dispatch table
+    class Dispatcher : public tNMEA2000::tMsgHandler {
+       public:
+        Dispatcher(Nmea *nmea) : tMsgHandler(0), nmea_{nmea} {}
+        void HandleMsg(const tN2kMsg &msg) override { nmea_->dispatch(msg); }
+
+       private:
+        Nmea *nmea_;
+    };
+
+    static const ReceiveHandler RECEIVE_HANDLERS[];
+    static const size_t RECEIVE_HANDLER_COUNT;
+
+    void parseMessages();
+    void dispatch(const tN2kMsg &msg);
+    void handleBatteryStatus(const tN2kMsg &msg);
+    void handleTemperature(const tN2kMsg &msg);
+    void handleTemperatureExtendedRange(const tN2kMsg &msg);
+    void receiveTemperature(tN2kTempSource source, float temperature);
+
+    void markDirty(TransmitSlot slot);
+    void transmit(TransmitSlot slot);
+    void send(const tN2kMsg &msg);
+    void connect_alarm(EngineAlarm *alarm, std::function<void(bool)> set_status);
+    void sendEngineAlarm(EngineAlarm *alarm);
+    void sendEngineData();
+    void sendExhaustTemperature();
+    void sendEngineRpms();
     void sendWaterTankData();
     void sendFuelTankData();
 
-    tNMEA2000 *nmea2000_;
-    double oil_temperature_ = N2kDoubleNA;
-    double coolant_temperature_ = N2kDoubleNA;
-    double oil_pressure_ = N2kDoubleNA;
-    double engine_hours_ = N2kDoubleNA;
-    double water_level_ = N2kDoubleNA;
-    double water_capacity_ = N2kDoubleNA;
-    double fuel_level_ = N2kDoubleNA;
-    double fuel_capacity_ = N2kDoubleNA;
+    QueueAwareNmea2000 *nmea2000_;
+    uint32_t last_parse_ = 0;
+    bool first_frame_sent_ = false;
+    ObservableValue<float> battery_voltage_;
+    ObservableValue<float> ambient_temperature_;
+    TransmitSchedule schedule_[kTransmitSlotCount] = {
+        {"nmea_engine_rpms", 100, 1000, &Nmea::sendEngineRpms},       // PGN 127488, rapid update
+        {"nmea_engine_data", 500, 2500, &Nmea::sendEngineData},       // PGN 127489
+        {"nmea_exhaust", 2000, 2000, &Nmea::sendExhaustTemperature},  // PGN 130312
+        {"nmea_water_tank", 2500, 2500, &Nmea::sendWaterTankData},    // PGN 127505
+        {"nmea_fuel_tank", 2500, 2500, &Nmea::sendFuelTankData},      // PGN 127505
+    };
+    uint8_t sid_ = 0;
+    float engine_rpms_ = N2kFloatNA;
+    float exhaust_temperature_ = N2kFloatNA;
+    float oil_temperature_ = N2kFloatNA;
+    float coolant_temperature_ = N2kFloatNA;
+    float oil_pressure_ = N2kFloatNA;
+    float engine_hours_ = N2kFloatNA;
+    float water_level_ = N2kFloatNA;
+    float water_capacity_ = N2kFloatNA;
+    float fuel_level_ = N2kFloatNA;
+    float fuel_capacity_ = N2kFloatNA;
+    tN2kEngineDiscreteStatus1 engine_status1_;
+    tN2kEngineDiscreteStatus2 engine_status2_;
+    uint32_t max_alarm_latency_ = 0;
 };
 
 }  // namespace sensesp
@@ -0,0 +1,224 @@
+#include "onewire_bus.h"
+
+#include "boot_profiler.h"
+#include "reaction_profiler.h"
+
+namespace sensesp {
+
+// How often the main loop checks for newly found sensor addresses to save (ms)
+static const uint SAVE_CHECK_INTERVAL = 1000;
+
+// DS18B20 function commands
+static const uint8_t CONVERT_T = 0x44;
+static const uint8_t WRITE_SCRATCHPAD = 0x4E;
+static const uint8_t READ_SCRATCHPAD = 0xBE;
+static const uint8_t DS18B20_FAMILY = 0x28;
+
+OneWireBus::OneWireBus(uint8_t pin, AcquisitionTask* acquisition, uint read_delay)
+    : onewire_{new OneWire(pin)},
+      acquisition_{acquisition},
+      read_delay_{read_delay} {}
+
+void OneWireBus::add_sensor(OneWireBusTemperature* sensor) {
+    String name = "1-Wire sensor " + String(sensors_.size());
+    sensor->source_ = acquisition_->add_source(name, read_delay_, [sensor](float value) {
+        sensor->emit(value);
+    });
+    sensors_.push_back(sensor);
+}
+
+void OneWireBus::start() {
+    timer_ = new AdjustableTimer(acquisition_->reactor(), read_delay_, [this]() { this->convert(); });
+
+    // The bus search takes a while per device; run it in the acquisition
+    // task so it does not hold up the rest of the startup
+    acquisition_->post([this]() {
+        this->assign_addresses();
+        this->configure_resolutions();
+        timer_->start();
+        BootProfiler::instance()->mark("1-Wire bus ready");
+    });
+
+    // Configurations are written from the main loop only
+    ReactESP::app->onRepeat(SAVE_CHECK_INTERVAL, PROFILED("onewire_save", SAVE_CHECK_INTERVAL, [this]() {
+        if (!addresses_found_.exchange(false)) {
+            return;
+        }
+        for (auto sensor : sensors_) {
+            if (sensor->address_found_) {
+                sensor->address_found_ = false;
+                sensor->save_configuration();
+            }
+        }
+    }));
+}
+
+void OneWireBus::configure_resolutions() {
+    // Set each sensor's resolution in its configuration register
+    for (auto sensor : sensors_) {
+        if (!sensor->has_address_ || !onewire_->reset()) {
+            continue;
+        }
+        onewire_->select(sensor->address_);
+        onewire_->write(WRITE_SCRATCHPAD);
+        onewire_->write(0);  // TH alarm register, unused
+        onewire_->write(0);  // TL alarm register, unused
+        onewire_->write(((sensor->resolution_ - 9) << 5) | 0x1F);
+    }
+}
+
+void OneWireBus::set_sample_period(uint period) {
+    read_delay_ = period;
+    if (timer_ == nullptr) {
+        return;
+    }
+    acquisition_->post([this, period]() {
+        for (auto sensor : sensors_) {
+            acquisition_->set_source_interval(sensor->source_, period);
+        }
+        timer_->set_period(period);
+    });
+}
+
+void OneWireBus::assign_addresses() {
+    bool missing_address = false;
+    for (auto sensor : sensors_) {
+        missing_address = missing_address || !sensor->has_address_;
+    }
+    if (!missing_address) {
+        return;
+    }
+
+    // Hand out the ROM addresses not configured in any sensor yet, in search order
+    uint8_t address[8];
+    onewire_->reset_search();
+    while (onewire_->search(address)) {
+        if (address[0] != DS18B20_FAMILY || OneWire::crc8(address, 7) != address[7]) {
+            continue;
+        }
+        OneWireBusTemperature* unassigned = nullptr;
+        bool known = false;
+        for (auto sensor : sensors_) {
+            if (sensor->has_address_) {
+                known = known || memcmp(sensor->address_, address, 8) == 0;
+            } else if (unassigned == nullptr) {
+                unassigned = sensor;
+            }
+        }
+        if (!known && unassigned != nullptr) {
+            memcpy(unassigned->address_, address, 8);
+            unassigned->has_address_ = true;
+            unassigned->address_found_ = true;
+            addresses_found_ = true;
+        }
+    }
+}
+
+void OneWireBus::convert() {
+    if (!onewire_->reset()) {
+        debugW("No 1-Wire devices present");
+        return;
+    }
+    onewire_->skip();
+    onewire_->write(CONVERT_T);
+    convert_millis_ = millis();
+
+    for (auto sensor : sensors_) {
+        sensor->converting_ = sensor->has_address_;
+    }
+    read_ready();
+}
+
+void OneWireBus::read_ready() {
+    // Read every sensor whose conversion is done in one pass, then wait
+    // for the next one to be done
+    uint next = 0;
+    for (auto sensor : sensors_) {
+        if (!sensor->converting_) {
+            continue;
+        }
+        if (sensor->conversion_time() <= millis() - convert_millis_) {
+            sensor->converting_ = false;
+            read(sensor);
+        } else if (next == 0 || sensor->conversion_time() < next) {
+            next = sensor->conversion_time();
+        }
+    }
+    // A wait scheduled before the latest convert T checks again itself
+    if (next > 0 && !read_scheduled_) {
+        read_scheduled_ = true;
+        acquisition_->reactor()->onDelay(next - (millis() - convert_millis_), [this]() {
+            read_scheduled_ = false;
+            this->read_ready();
+        });
+    }
+}
+
+void OneWireBus::read(OneWireBusTemperature* sensor) {
+    uint8_t scratchpad[9];
+    if (!onewire_->reset()) {
+        return;
+    }
+    onewire_->select(sensor->address_);
+    onewire_->write(READ_SCRATCHPAD);
+    onewire_->read_bytes(scratchpad, sizeof(scratchpad));
+    if (OneWire::crc8(scratchpad, 8) != scratchpad[8]) {
+        debugW("1-Wire scratchpad CRC error");
+        return;
+    }
+
+    int16_t raw = (scratchpad[1] << 8) | scratchpad[0];
+    // Bits below the configured resolution are undefined
+    raw &= ~((1 << (12 - sensor->resolution_)) - 1);
+    acquisition_->publish(sensor->source_, raw / 16.0f + 273.15f);
+}
+
+OneWireBusTemperature::OneWireBusTemperature(OneWireBus* bus, uint8_t resolution, String config_path)
+    : FloatSensor(config_path),
+      resolution_{resolution} {
+    load_configuration();
+    bus->add_sensor(this);
+}
+
+void OneWireBusTemperature::get_configuration(JsonObject& root) {
+    char address[24] = "";
+    if (has_address_) {
+        sprintf(address, "%02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x",
+                address_[0], address_[1], address_[2], address_[3],
+                address_[4], address_[5], address_[6], address_[7]);
+    }
+    root["address"] = address;
+    root["resolution"] = resolution_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "address": { "title": "ROM address", "type": "string", "description": "1-Wire ROM address of the sensor. Leave empty to assign a new sensor found on the bus at the next restart" },
+        "resolution": { "title": "Resolution", "type": "number", "enum": [9, 10, 11, 12], "description": "Resolution in bits; 9 bits converts in 94 ms, 12 bits in 750 ms" }
+    }
+  })###";
+
+String OneWireBusTemperature::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool OneWireBusTemperature::set_configuration(const JsonObject& config) {
+    // The resolution is optional: the configurations saved before it was
+    // configurable only have the address
+    if (!config.containsKey("address")) {
+        return false;
+    }
+    String address = config["address"];
+    unsigned int bytes[8];
+    has_address_ = sscanf(address.c_str(), "%x:%x:%x:%x:%x:%x:%x:%x",
+                          &bytes[0], &bytes[1], &bytes[2], &bytes[3],
+                          &bytes[4], &bytes[5], &bytes[6], &bytes[7]) == 8;
+    for (int i = 0; i < 8; i++) {
+        address_[i] = has_address_ ? bytes[i] : 0;
+    }
+    if (config.containsKey("resolution")) {
+        resolution_ = constrain((int)config["resolution"], 9, 12);
+    }
+    return true;
+}
+
+}  // namespace sensesp
@@ -0,0 +1,82 @@
+#ifndef __SRC_ONEWIRE_BUS_H__
+#define __SRC_ONEWIRE_BUS_H__
+
+#include <OneWire.h>
+
+#include <atomic>
+#include <vector>
+
+#include "acquisition_task.h"
+#include "adjustable_timer.h"
+#include "sampling_policy.h"
+#include "sensesp.h"
+#include "sensesp/sensors/sensor.h"
+
+namespace sensesp {
+
+class OneWireBusTemperature;
+
+/**
+ * @brief Coordinates all the DS18B20 sensors on a 1-Wire bus
+ *
+ * Every read_delay ms a single Skip ROM "convert T" starts the conversion on
+ * all the sensors at once, and each scratchpad is read as soon as the
+ * conversion time for that sensor's resolution has passed. A single delay
+ * per bus waits for the next conversion to be done, and reads all the
+ * sensors done by then. The bus is only
+ * searched when a sensor has no ROM address in its configuration yet.
+ *
+ * All the bus I/O, including the search, runs in the acquisition task once
+ * it has started.
+ */
+class OneWireBus : public Startable, public SamplingTarget {
+   public:
+    OneWireBus(uint8_t pin, AcquisitionTask* acquisition, uint read_delay = 1000);
+    void start() override final;
+    void add_sensor(OneWireBusTemperature* sensor);
+    void set_sample_period(uint period) override;
+
+   private:
+    void assign_addresses();
+    void configure_resolutions();
+    void convert();
+    void read_ready();
+    void read(OneWireBusTemperature* sensor);
+
+    OneWire* onewire_;
+    AcquisitionTask* acquisition_;
+    uint read_delay_;
+    uint32_t convert_millis_ = 0;
+    bool read_scheduled_ = false;
+    AdjustableTimer* timer_ = nullptr;
+    std::vector<OneWireBusTemperature*> sensors_;
+    // Set by the search when sensor addresses need saving
+    std::atomic<bool> addresses_found_{false};
+};
+
+// Temperature (K) of a single DS18B20 on a OneWireBus
+class OneWireBusTemperature : public FloatSensor {
+   public:
+    OneWireBusTemperature(OneWireBus* bus, uint8_t resolution = 12, String config_path = "");
+    void start() override final {}
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+    // Conversion time of the sensor at its configured resolution (ms)
+    uint conversion_time() { return 750 >> (12 - resolution_); }
+
+   private:
+    friend class OneWireBus;
+
+    uint8_t source_;
+    uint8_t address_[8] = {};
+    bool has_address_ = false;
+    bool address_found_ = false;
+    bool converting_ = false;
+    uint8_t resolution_;
+};
+
+}  // namespace sensesp
+
+#endif
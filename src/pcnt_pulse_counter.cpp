@@ -0,0 +1,51 @@
+#include "pcnt_pulse_counter.h"
+
+namespace sensesp {
+
+// The PCNT glitch filter is counted in APB clock cycles (80 MHz) and is 10 bits wide
+static const uint32_t APB_CYCLES_PER_US = 80;
+static const uint16_t MAX_FILTER_CYCLES = 1023;
+
+PcntPulseCounter::PcntPulseCounter(int pin, uint16_t glitch_filter_ns, pcnt_unit_t unit)
+    : pin_{pin},
+      glitch_filter_ns_{glitch_filter_ns},
+      unit_{unit} {}
+
+void PcntPulseCounter::begin() {
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = pin_;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.pos_mode = PCNT_COUNT_INC;  // Count rising edges only
+    config.neg_mode = PCNT_COUNT_DIS;
+    config.counter_h_lim = COUNTER_LIMIT;
+    config.counter_l_lim = 0;
+    config.unit = unit_;
+    config.channel = PCNT_CHANNEL_0;
+    pcnt_unit_config(&config);
+
+    uint32_t filter_cycles = glitch_filter_ns_ * APB_CYCLES_PER_US / 1000;
+    pcnt_set_filter_value(unit_, min(filter_cycles, (uint32_t)MAX_FILTER_CYCLES));
+    pcnt_filter_enable(unit_);
+
+    pcnt_counter_pause(unit_);
+    pcnt_counter_clear(unit_);
+    pcnt_counter_resume(unit_);
+    last_count_ = 0;
+}
+
+uint32_t PcntPulseCounter::take_count() {
+    // Never clear the counter, so no pulse is lost between reading and
+    // clearing; the counter resets to zero when it reaches the high limit
+    int16_t count;
+    pcnt_get_counter_value(unit_, &count);
+    int32_t pulses = count - last_count_;
+    if (pulses < 0) {
+        pulses += COUNTER_LIMIT;
+    }
+    last_count_ = count;
+    return pulses;
+}
+
+}  // namespace sensesp
@@ -0,0 +1,35 @@
+#ifndef __SRC_PCNT_PULSE_COUNTER_H__
+#define __SRC_PCNT_PULSE_COUNTER_H__
+
+#include <Arduino.h>
+#include <driver/pcnt.h>
+
+#include "pulse_counter.h"
+
+namespace sensesp {
+
+/**
+ * @brief Counts rising edges with the ESP32 PCNT peripheral
+ *
+ * The counter runs in hardware, so no CPU interrupt is taken per pulse. Pulses
+ * shorter than the glitch filter are ignored. The 16-bit counter wraps at
+ * COUNTER_LIMIT, so it must be read at least once per COUNTER_LIMIT pulses.
+ */
+class PcntPulseCounter : public PulseCounter {
+   public:
+    static const int16_t COUNTER_LIMIT = 32767;
+
+    PcntPulseCounter(int pin, uint16_t glitch_filter_ns = 10000, pcnt_unit_t unit = PCNT_UNIT_0);
+    void begin() override;
+    uint32_t take_count() override;
+
+   private:
+    int pin_;
+    uint16_t glitch_filter_ns_;
+    pcnt_unit_t unit_;
+    int16_t last_count_ = 0;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,23 @@
+#include "pipeline_arena.h"
+
+#include "sensesp.h"
+
+namespace sensesp {
+
+PipelineArena* PipelineArena::instance() {
+    static PipelineArena arena;
+    return &arena;
+}
+
+void* PipelineArena::allocate(size_t size, size_t alignment) {
+    size_t start = (used_ + alignment - 1) & ~(alignment - 1);
+    if (start + size > PIPELINE_ARENA_SIZE) {
+        overflows_++;
+        debugW("Pipeline arena full, %u bytes allocated on the heap", size);
+        return ::operator new(size);
+    }
+    used_ = start + size;
+    return buffer_ + start;
+}
+
+}  // namespace sensesp
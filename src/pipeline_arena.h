@@ -0,0 +1,51 @@
+#ifndef __SRC_PIPELINE_ARENA_H__
+#define __SRC_PIPELINE_ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <new>
+#include <utility>
+
+#include "configuration.h"
+
+namespace sensesp {
+
+/**
+ * @brief Bump allocator for the objects of the sensor pipelines
+ *
+ * The sensors, transforms and outputs are created once at boot and live
+ * until the next reboot, so they are carved out of a buffer sized at build
+ * time (PIPELINE_ARENA_SIZE) instead of the heap, where they would be
+ * scattered between the allocations that come and go. Nothing is ever
+ * freed. When the arena is full, allocations fall back to the heap.
+ */
+class PipelineArena {
+   public:
+    static PipelineArena* instance();
+
+    void* allocate(size_t size, size_t alignment);
+    size_t used() { return used_; }
+    size_t capacity() { return PIPELINE_ARENA_SIZE; }
+    // Allocations that did not fit and went to the heap
+    size_t overflows() { return overflows_; }
+
+   private:
+    PipelineArena() {}
+
+    alignas(8) uint8_t buffer_[PIPELINE_ARENA_SIZE];
+    size_t used_ = 0;
+    size_t overflows_ = 0;
+};
+
+// Creates a pipeline object in the PipelineArena, e.g.
+// `arena_new<Stored<Linear>>(1.0, 0, "/path")`
+template <typename T, typename... Args>
+T* arena_new(Args&&... args) {
+    void* memory = PipelineArena::instance()->allocate(sizeof(T), alignof(T));
+    return new (memory) T(std::forward<Args>(args)...);
+}
+
+}  // namespace sensesp
+
+#endif
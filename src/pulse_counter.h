@@ -0,0 +1,19 @@
+#ifndef __SRC_PULSE_COUNTER_H__
+#define __SRC_PULSE_COUNTER_H__
+
+#include <stdint.h>
+
+namespace sensesp {
+
+// Source of pulse counts, e.g. a hardware counter or a simulated pulse train
+class PulseCounter {
+   public:
+    virtual ~PulseCounter() {}
+    virtual void begin() = 0;
+    // Pulses counted since the previous call
+    virtual uint32_t take_count() = 0;
+};
+
+}  // namespace sensesp
+
+#endif
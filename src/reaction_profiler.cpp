@@ -0,0 +1,136 @@
+#include "reaction_profiler.h"
+
+#ifndef REACTION_PROFILING_DISABLED
+
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp_base_app.h"
+
+namespace sensesp {
+
+ReactionProfiler* ReactionProfiler::instance() {
+    static ReactionProfiler* profiler = new ReactionProfiler();
+    return profiler;
+}
+
+ReactionProfiler::ReactionProfiler()
+    : cycles_per_us_{ESP.getCpuFreqMHz()},
+      window_start_{(uint32_t)micros()} {}
+
+std::function<void()> ReactionProfiler::wrap(const char* name, uint period, std::function<void()> callback) {
+    if (count_ >= MAX_REACTIONS) {
+        debugW("No profiler slot left for reaction %s", name);
+        return callback;
+    }
+    Reaction* reaction = &reactions_[count_++];
+    reaction->name = name;
+    reaction->period = period * 1000;
+    reaction->due = micros() + reaction->period;
+
+    return [this, reaction, callback]() {
+        if (reaction->period != 0) {
+            uint32_t now = micros();
+            int32_t lateness = max((int32_t)(now - reaction->due), (int32_t)0);
+            reaction->lateness_histogram[bucket(lateness)]++;
+            reaction->max_lateness = max(reaction->max_lateness, (uint32_t)lateness);
+            reaction->due = now + reaction->period;
+        }
+        uint32_t start_cycles = ESP.getCycleCount();
+        callback();
+        this->record(reaction, start_cycles);
+    };
+}
+
+void ReactionProfiler::record(Reaction* reaction, uint32_t start_cycles) {
+    uint32_t run_time = (ESP.getCycleCount() - start_cycles) / cycles_per_us_;
+    reaction->count++;
+    reaction->run_time += run_time;
+    reaction->max_run_time = max(reaction->max_run_time, run_time);
+    reaction->window_run_time += run_time;
+    reaction->window_max_run_time = max(reaction->window_max_run_time, run_time);
+    reaction->run_time_histogram[bucket(run_time)]++;
+}
+
+void ReactionProfiler::add_handler(DiagnosticsServer* server) {
+    server->add_handler("/reactions", [this](httpd_req_t* req) { return this->handle(req); });
+}
+
+void ReactionProfiler::start() {
+    String prefix = "sensorDevice." + SensESPBaseApp::get_hostname() + ".eventLoop.";
+    load_.connect_to(new SKOutputFloat(prefix + "load", "", "ratio"));
+    for (size_t rank = 0; rank < TOP_COUNT; rank++) {
+        String top_prefix = prefix + "top" + (rank + 1) + ".";
+        top_[rank].name.connect_to(new SKOutputString(top_prefix + "name"));
+        top_[rank].run_time.connect_to(new SKOutputFloat(top_prefix + "load", "", "ratio"));
+        top_[rank].max_run_time.connect_to(new SKOutputFloat(top_prefix + "maxRunTime", "", "s"));
+    }
+    window_start_ = micros();
+    ReactESP::app->onRepeat(PUBLISH_INTERVAL, [this]() { this->publish(); });
+}
+
+void ReactionProfiler::publish() {
+    uint32_t now = micros();
+    float window = now - window_start_;
+    window_start_ = now;
+
+    // Pick the reactions with the most run time in the window
+    Reaction* top[TOP_COUNT] = {};
+    uint64_t total = 0;
+    for (size_t i = 0; i < count_; i++) {
+        Reaction* reaction = &reactions_[i];
+        total += reaction->window_run_time;
+        for (size_t rank = 0; rank < TOP_COUNT; rank++) {
+            if (top[rank] == nullptr || reaction->window_run_time > top[rank]->window_run_time) {
+                memmove(&top[rank + 1], &top[rank], (TOP_COUNT - rank - 1) * sizeof(top[0]));
+                top[rank] = reaction;
+                break;
+            }
+        }
+    }
+
+    load_.set(total / window);
+    for (size_t rank = 0; rank < TOP_COUNT && top[rank] != nullptr; rank++) {
+        top_[rank].name.set(top[rank]->name);
+        top_[rank].run_time.set(top[rank]->window_run_time / window);
+        top_[rank].max_run_time.set(top[rank]->window_max_run_time / 1e6f);
+    }
+    for (size_t i = 0; i < count_; i++) {
+        reactions_[i].window_run_time = 0;
+        reactions_[i].window_max_run_time = 0;
+    }
+}
+
+esp_err_t ReactionProfiler::handle(httpd_req_t* req) {
+    // Read without locking: a counter may be one run behind the others
+    httpd_resp_set_type(req, "text/csv");
+    char line[768];
+    size_t length = snprintf(line, sizeof(line), "name,period_ms,count,mean_us,max_us,max_lateness_us");
+    const char* histograms[] = {"run", "late"};
+    for (auto histogram : histograms) {
+        for (size_t i = 0; i < BUCKETS - 1; i++) {
+            length += snprintf(line + length, sizeof(line) - length, ",%s_lt_%uus", histogram, 1u << i);
+        }
+        length += snprintf(line + length, sizeof(line) - length, ",%s_ge_%uus", histogram, 1u << (BUCKETS - 2));
+    }
+    length += snprintf(line + length, sizeof(line) - length, "\n");
+    httpd_resp_send_chunk(req, line, length);
+
+    for (size_t i = 0; i < count_; i++) {
+        const Reaction& reaction = reactions_[i];
+        length = snprintf(line, sizeof(line), "%s,%u,%u,%.1f,%u,%u", reaction.name,
+                          reaction.period / 1000, reaction.count,
+                          reaction.count == 0 ? 0.0f : (float)reaction.run_time / reaction.count,
+                          reaction.max_run_time, reaction.max_lateness);
+        for (auto histogram : {reaction.run_time_histogram, reaction.lateness_histogram}) {
+            for (size_t b = 0; b < BUCKETS; b++) {
+                length += snprintf(line + length, sizeof(line) - length, ",%u", histogram[b]);
+            }
+        }
+        length += snprintf(line + length, sizeof(line) - length, "\n");
+        httpd_resp_send_chunk(req, line, length);
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+}  // namespace sensesp
+
+#endif
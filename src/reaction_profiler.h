@@ -0,0 +1,95 @@
+#ifndef __SRC_REACTION_PROFILER_H__
+#define __SRC_REACTION_PROFILER_H__
+
+// Wraps the callback of a main loop reaction so its run time and lateness
+// are profiled, e.g. `app.onRepeat(1000, PROFILED("name", 1000, [this]() { ... }))`.
+// `period` is the reaction's period (ms), 0 for tick reactions. Defining
+// REACTION_PROFILING_DISABLED compiles the profiler out completely.
+#ifndef REACTION_PROFILING_DISABLED
+#define PROFILED(name, period, ...) ReactionProfiler::instance()->wrap(name, period, __VA_ARGS__)
+#else
+#define PROFILED(name, period, ...) (__VA_ARGS__)
+#endif
+
+#ifndef REACTION_PROFILING_DISABLED
+
+#include <functional>
+
+#include "diagnostics_server.h"
+#include "sensesp.h"
+#include "sensesp/system/observablevalue.h"
+
+namespace sensesp {
+
+/**
+ * @brief Run time and lateness histograms of the main loop reactions
+ *
+ * Every wrapped reaction gets a fixed slot with power-of-two histograms of
+ * its run time and, for repeating reactions, of how late it ran; recording
+ * a run only increments counters. Run times are taken from the CPU cycle
+ * counter, which is cheap enough for the reactions that run on every tick.
+ *
+ * The reactions taking the most loop time are published to Signal K every
+ * PUBLISH_INTERVAL, and all the counters are served as CSV at /reactions.
+ * Reactions must be wrapped from the main loop task.
+ */
+class ReactionProfiler {
+   public:
+    static ReactionProfiler* instance();
+
+    std::function<void()> wrap(const char* name, uint period, std::function<void()> callback);
+    void add_handler(DiagnosticsServer* server);
+    // Starts publishing the top reactions to Signal K
+    void start();
+
+   private:
+    static const size_t MAX_REACTIONS = 32;
+    // Bucket i counts the values below 2^i us; the last one everything above
+    static const size_t BUCKETS = 16;
+    static const size_t TOP_COUNT = 3;
+    static const uint PUBLISH_INTERVAL = 10000;
+
+    struct Reaction {
+        const char* name;
+        uint32_t period;    // us, 0 for tick reactions
+        uint32_t due;       // micros() at which the reaction is due
+        uint32_t count;
+        uint64_t run_time;  // us
+        uint32_t max_run_time;
+        uint32_t max_lateness;
+        // Since the last publication
+        uint32_t window_run_time;
+        uint32_t window_max_run_time;
+        uint32_t run_time_histogram[BUCKETS];
+        uint32_t lateness_histogram[BUCKETS];
+    };
+
+    struct TopOutputs {
+        ObservableValue<String> name;
+        ObservableValue<float> run_time;
+        ObservableValue<float> max_run_time;
+    };
+
+    ReactionProfiler();
+    void record(Reaction* reaction, uint32_t start_cycles);
+    void publish();
+    esp_err_t handle(httpd_req_t* req);
+
+    static size_t bucket(uint32_t value) {
+        size_t index = value == 0 ? 0 : 32 - __builtin_clz(value);
+        return index < BUCKETS ? index : BUCKETS - 1;
+    }
+
+    uint32_t cycles_per_us_;
+    Reaction reactions_[MAX_REACTIONS] = {};
+    size_t count_ = 0;
+    uint32_t window_start_;
+    ObservableValue<float> load_;
+    TopOutputs top_[TOP_COUNT];
+};
+
+}  // namespace sensesp
+
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef __SRC_RMS_ACCUMULATOR_H__
+#define __SRC_RMS_ACCUMULATOR_H__
+
+#include <math.h>
+#include <stdint.h>
+
+namespace sensesp {
+
+/**
+ * @brief Allocation-free running DC offset and AC RMS of raw ADC counts
+ *
+ * Sums are kept in 64-bit integers, so the variance is computed exactly no
+ * matter how large the DC offset is compared to the AC component.
+ */
+class RmsAccumulator {
+   public:
+    void reset() {
+        count_ = 0;
+        sum_ = 0;
+        sum_squares_ = 0;
+    }
+
+    void add(int16_t sample) {
+        count_++;
+        sum_ += sample;
+        sum_squares_ += (int32_t)sample * sample;
+    }
+
+    uint32_t count() const { return count_; }
+
+    // DC offset, in counts
+    float mean() const { return count_ == 0 ? 0 : (float)sum_ / count_; }
+
+    // RMS of the signal with the DC offset removed, in counts
+    float rms() const {
+        if (count_ == 0) {
+            return 0;
+        }
+        // n * sum(x^2) - sum(x)^2 == n^2 * variance
+        int64_t scaled_variance = (int64_t)count_ * sum_squares_ - sum_ * sum_;
+        return sqrtf((float)scaled_variance) / count_;
+    }
+
+   private:
+    uint32_t count_ = 0;
+    int64_t sum_ = 0;
+    int64_t sum_squares_ = 0;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,65 @@
+#include "rms_voltage_sensor.h"
+
+#include "adc_channel.h"
+
+namespace sensesp {
+
+RmsVoltageSensor::RmsVoltageSensor(Ads1115Scheduler* ads1115_scheduler, int channel, uint read_delay, uint window, String config_path)
+    : FloatSensor(config_path),
+      ads1115_scheduler_{ads1115_scheduler},
+      read_delay_{read_delay},
+      window_{window},
+      channel_{channel} {
+    load_configuration();
+}
+
+void RmsVoltageSensor::start() {
+    index_ = ads1115_scheduler_->add_burst_channel(
+        channel_, read_delay_, window_,
+        [this](int16_t adc_output) { accumulator_.add(adc_output); },
+        [this]() {
+            float rms = accumulator_.count() > 0 ? accumulator_.rms() * VoltageChannel::counts_to_output : NAN;
+            accumulator_.reset();
+            return rms;
+        },
+        [this](float rms) { this->emit(rms); });
+}
+
+void RmsVoltageSensor::get_configuration(JsonObject& root) {
+    root["read_delay"] = read_delay_;
+    root["window"] = window_;
+    root["channel"] = channel_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "read_delay": { "title": "Read delay", "type": "number", "description": "Number of milliseconds between the start of each measurement window. Set by the sampling policy (/system/sampling_policy) for the engine running state" },
+        "window": { "title": "Window", "type": "number", "description": "Number of milliseconds sampled back to back at up to 860 samples per second for each reading" },
+        "channel": { "title": "Sensor channel", "type": "number", "description": "Channel in the ADS1115 where the sensor is" }
+    }
+  })###";
+
+String RmsVoltageSensor::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool RmsVoltageSensor::set_configuration(const JsonObject& config) {
+    String expected[] = {"read_delay", "window", "channel"};
+    for (auto str : expected) {
+        if (!config.containsKey(str)) {
+            return false;
+        }
+    }
+    read_delay_ = config["read_delay"];
+    window_ = config["window"];
+    channel_ = config["channel"];
+    return true;
+}
+
+void RmsVoltageSensor::set_sample_period(uint period) {
+    read_delay_ = period;
+    if (index_ >= 0) {
+        ads1115_scheduler_->set_period(index_, period);
+    }
+}
+
+}  // namespace sensesp
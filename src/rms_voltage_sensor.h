@@ -0,0 +1,34 @@
+#ifndef __SRC_RMS_VOLTAGE_SENSOR_H__
+#define __SRC_RMS_VOLTAGE_SENSOR_H__
+
+#include "ads1115_scheduler.h"
+#include "rms_accumulator.h"
+#include "sampling_policy.h"
+#include "sensesp.h"
+#include "sensesp/sensors/sensor.h"
+
+namespace sensesp {
+
+// Emits the true RMS voltage (DC offset removed) at an engine hat input,
+// measured over a window of back-to-back ADS1115 conversions
+class RmsVoltageSensor : public FloatSensor, public SamplingTarget {
+   public:
+    RmsVoltageSensor(Ads1115Scheduler* ads1115_scheduler, int channel, uint read_delay = 1000, uint window = 200, String config_path = "");
+    void start() override final;
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+    void set_sample_period(uint period) override;
+
+   private:
+    Ads1115Scheduler* ads1115_scheduler_;
+    uint read_delay_;
+    uint window_;
+    int channel_;
+    RmsAccumulator accumulator_;
+    int index_ = -1;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,179 @@
+#include "rpm_sensor.h"
+
+#include "configuration.h"
+#include "reaction_profiler.h"
+
+namespace sensesp {
+
+RpmSensor::RpmSensor(PulseCounter* counter, EdgeCapture* capture, uint read_delay, String config_path)
+    : FloatSensor(config_path),
+      counter_{counter},
+      capture_{capture},
+      read_delay_{read_delay} {
+    // Periods shorter than the glitch filter of the pulse counter are noise
+    min_period_ticks_ = (uint64_t)capture_->ticks_per_second() * RPM_GLITCH_FILTER_NS / 1000000000;
+    load_configuration();
+}
+
+void RpmSensor::start() {
+    if (mode_ == "period") {
+        capture_->begin();
+        last_emit_millis_ = millis();
+        last_edge_millis_ = millis();
+        ReactESP::app->onTick(PROFILED("rpm_period", 0, [this]() { this->update_period(); }));
+    } else {
+        counter_->begin();
+        last_count_update_ = millis();
+        ReactESP::app->onRepeat(read_delay_, PROFILED("rpm_count", read_delay_, [this]() { this->update_count(); }));
+    }
+}
+
+void RpmSensor::update_count() {
+    uint32_t now = millis();
+    uint32_t elapsed = now - last_count_update_;
+    last_count_update_ = now;
+    if (elapsed > 0) {
+        this->emit(1000.0f * counter_->take_count() / elapsed);
+    }
+}
+
+void RpmSensor::update_period() {
+    uint32_t now = millis();
+    uint32_t edge;
+    while (capture_->next_edge(&edge)) {
+        add_edge(edge, now);
+    }
+    if (capture_->take_overflow()) {
+        // The next edge does not follow the last one
+        has_last_edge_ = false;
+    }
+
+    if (now - last_edge_millis_ > stop_timeout_) {
+        // No edges for a while: engine stopped
+        has_last_edge_ = false;
+        reset_periods();
+    }
+
+    if (edges_since_emit_ >= emit_edges_ || now - last_emit_millis_ >= emit_interval_) {
+        edges_since_emit_ = 0;
+        last_emit_millis_ = now;
+        if (period_count_ == 0) {
+            this->emit(0);
+        } else {
+            this->emit((float)capture_->ticks_per_second() * capture_->edges_per_timestamp() * period_count_ /
+                       period_sum_);
+        }
+    }
+}
+
+void RpmSensor::add_edge(uint32_t edge, uint32_t now) {
+    uint32_t edges = capture_->edges_per_timestamp();
+    if (has_last_edge_) {
+        uint32_t period = edge - last_edge_;
+        if (period < min_period_ticks_) {
+            // Glitch: ignore this edge altogether
+            return;
+        }
+        // A glitch in a prescaled interval: one period short of the previous one
+        bool short_by_a_period = edges > 1 && !dropped_last_period_ && last_period_ > 0 &&
+                                 (uint64_t)period * (2 * edges) < (uint64_t)last_period_ * (2 * edges - 1);
+        dropped_last_period_ = short_by_a_period;
+        if (!short_by_a_period) {
+            add_period(period);
+            edges_since_emit_ += edges;
+        }
+        last_period_ = period;
+    }
+    has_last_edge_ = true;
+    last_edge_ = edge;
+    last_edge_millis_ = now;
+}
+
+// Averages over average_periods edges, i.e. fewer timestamp intervals with a prescaler
+void RpmSensor::add_period(uint32_t period) {
+    uint window = max(1u, (uint)(average_periods_ / capture_->edges_per_timestamp()));
+    if (period_count_ >= window) {
+        period_sum_ -= periods_[period_index_];
+    } else {
+        period_count_++;
+    }
+    periods_[period_index_] = period;
+    period_sum_ += period;
+    period_index_ = (period_index_ + 1) % window;
+}
+
+void RpmSensor::reset_periods() {
+    period_index_ = 0;
+    period_count_ = 0;
+    period_sum_ = 0;
+    last_period_ = 0;
+    dropped_last_period_ = false;
+}
+
+void RpmSensor::get_configuration(JsonObject& root) {
+    root["mode"] = mode_;
+    root["read_delay"] = read_delay_;
+    root["average_periods"] = average_periods_;
+    root["emit_edges"] = emit_edges_;
+    root["emit_interval"] = emit_interval_;
+    root["stop_timeout"] = stop_timeout_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "mode": { "title": "Measurement mode", "type": "string", "enum": ["count", "period"], "description": "Count pulses over the read delay, or measure the period between pulses. Takes effect after a restart" },
+        "read_delay": { "title": "Read delay", "type": "number", "description": "Count mode: number of milliseconds between each pulse count read" },
+        "average_periods": { "title": "Averaged periods", "type": "number", "description": "Period mode: number of pulse periods averaged for each reading (max 32)" },
+        "emit_edges": { "title": "Emit every N pulses", "type": "number", "description": "Period mode: emit a reading after this many pulses" },
+        "emit_interval": { "title": "Emit interval", "type": "number", "description": "Period mode: maximum number of milliseconds between readings" },
+        "stop_timeout": { "title": "Stop timeout", "type": "number", "description": "Period mode: number of milliseconds without pulses after which the engine is considered stopped" }
+    }
+  })###";
+
+String RpmSensor::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool RpmSensor::set_configuration(const JsonObject& config) {
+    String expected[] = {"mode", "read_delay", "average_periods", "emit_edges", "emit_interval", "stop_timeout"};
+    for (auto str : expected) {
+        if (!config.containsKey(str)) {
+            return false;
+        }
+    }
+    mode_ = config["mode"].as<String>();
+    read_delay_ = config["read_delay"];
+    average_periods_ = constrain((uint)config["average_periods"], 1u, MAX_AVERAGE_PERIODS);
+    emit_edges_ = config["emit_edges"];
+    emit_interval_ = config["emit_interval"];
+    stop_timeout_ = config["stop_timeout"];
+    reset_periods();
+    return true;
+}
+
+RpmMultiplier::RpmMultiplier(float multiplier, String config_path)
+    : FloatTransform(config_path),
+      multiplier_{multiplier} {
+    load_configuration();
+}
+
+void RpmMultiplier::get_configuration(JsonObject& root) { root["multiplier"] = multiplier_; }
+
+static const char MULTIPLIER_SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "multiplier": { "title": "Multiplier", "type": "number", "description": "Engine revolutions per W-terminal pulse" }
+    }
+  })###";
+
+String RpmMultiplier::get_config_schema() { return FPSTR(MULTIPLIER_SCHEMA); }
+
+bool RpmMultiplier::set_configuration(const JsonObject& config) {
+    // The Linear transform saved an offset too, always 0 here
+    if (!config.containsKey("multiplier")) {
+        return false;
+    }
+    multiplier_ = config["multiplier"];
+    return true;
+}
+
+}  // namespace sensesp
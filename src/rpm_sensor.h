@@ -0,0 +1,90 @@
+#ifndef __SRC_RPM_SENSOR_H__
+#define __SRC_RPM_SENSOR_H__
+
+#include "edge_capture.h"
+#include "pulse_counter.h"
+#include "sensesp.h"
+#include "sensesp/sensors/sensor.h"
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+/**
+ * @brief Measures the W-terminal pulse frequency (Hz)
+ *
+ * Two measurement modes are available:
+ * - "count": pulses are counted over read_delay ms. Cheap, but coarse at
+ *   idle and up to read_delay ms of latency.
+ * - "period": edges are timestamped and the frequency is derived from the
+ *   average of the last average_periods periods. A value is emitted every
+ *   emit_edges edges or every emit_interval ms, whichever comes first.
+ *
+ * With a capture prescaler, a timestamp comes every few edges. A glitch
+ * counted by the prescaler then shortens one timestamp interval by a
+ * period instead of adding a tiny one, so an interval that much shorter
+ * than the previous one is dropped, unless the next one confirms it.
+ */
+class RpmSensor : public FloatSensor {
+   public:
+    RpmSensor(PulseCounter* counter, EdgeCapture* capture, uint read_delay = 500, String config_path = "");
+    void start() override final;
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    static const uint MAX_AVERAGE_PERIODS = 32;
+
+    void update_count();
+    void update_period();
+    void add_edge(uint32_t edge, uint32_t now);
+    void add_period(uint32_t period);
+    void reset_periods();
+
+    PulseCounter* counter_;
+    EdgeCapture* capture_;
+    String mode_ = "count";
+    uint read_delay_;
+    uint average_periods_ = 8;
+    uint emit_edges_ = 8;
+    uint emit_interval_ = 100;
+    uint stop_timeout_ = 1000;
+    uint32_t min_period_ticks_;
+
+    uint32_t last_count_update_;
+    bool has_last_edge_ = false;
+    uint32_t last_edge_;
+    uint32_t last_period_ = 0;
+    bool dropped_last_period_ = false;
+    uint32_t last_edge_millis_;
+    uint32_t last_emit_millis_;
+    uint edges_since_emit_ = 0;
+    uint32_t periods_[MAX_AVERAGE_PERIODS];
+    uint period_index_ = 0;
+    uint period_count_ = 0;
+    uint64_t period_sum_ = 0;
+};
+
+/**
+ * @brief Engine revolutions (Hz) from the W-terminal frequency
+ *
+ * Reads the configuration of the SensESP Frequency transform it replaces,
+ * i.e. a multiplier alone, as well as that of the Linear transform used
+ * since, so the calibration survives either.
+ */
+class RpmMultiplier : public FloatTransform {
+   public:
+    RpmMultiplier(float multiplier, String config_path = "");
+    void set_input(float input, uint8_t inputChannel = 0) override { this->emit(multiplier_ * input); }
+
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    float multiplier_;
+};
+
+}  // namespace sensesp
+
+#endif
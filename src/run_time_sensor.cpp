@@ -1,16 +1,32 @@
 #include "run_time_sensor.h"
 
+#include "reaction_profiler.h"
 #include "sensesp/system/lambda_consumer.h"
 
 namespace sensesp {
 
+// Number of run time records kept in the journal ring
+static const size_t JOURNAL_CAPACITY = 64;
+
 RunTimeSensor::RunTimeSensor(ValueProducer<float>* running_sensor, uint update_period, uint save_period, String config_path)
     : FloatSensor(config_path),
       update_period_{update_period},
-      save_period_{save_period} {
+      save_period_{save_period},
+      journal_{config_path + ".jnl", sizeof(float), JOURNAL_CAPACITY} {
     last_update_ = millis();
 
+    // Run time is persisted in the journal instead of rewriting the config
+    // file; a run time found in an older config file is migrated into it.
     load_configuration();
+    journal_ready_ = journal_.begin();
+    if (journal_ready_) {
+        if (journal_.read_latest(&run_time_)) {
+            debugI("Recovered run time %.0f s from journal record %u", run_time_, journal_.sequence());
+        } else {
+            journal();
+        }
+    }
+    last_saved_run_time_ = run_time_;
 
     running_sensor->connect_to(new LambdaConsumer<float>([&](float value) {
         if (value > 0) {
@@ -31,27 +47,32 @@ RunTimeSensor::RunTimeSensor(ValueProducer<float>* running_sensor, uint update_p
 }
 
 void RunTimeSensor::start() {
-    ReactESP::app->onRepeat(update_period_, [this]() { this->update(); });
-    ReactESP::app->onRepeat(save_period_, [this]() { this->save(); });
+    // Run time only: the period follows the sampling policy
+    update_timer_ = new AdjustableTimer(ReactESP::app, update_period_, PROFILED("run_time_update", 0, [this]() { this->update(); }));
+    update_timer_->start();
+    ReactESP::app->onRepeat(save_period_, PROFILED("run_time_save", save_period_, [this]() { this->save(); }));
 }
 
 void RunTimeSensor::update() {
     if (is_running_) {
-        run_time_ += (millis() - last_update_) / 1000.;
+        run_time_ += (millis() - last_update_) / 1000.0f;
     }
 
     last_update_ = millis();
 
-    this->emit(round(run_time_));
-
-    save_configuration();
+    this->emit(roundf(run_time_));
 };
 
 void RunTimeSensor::save() {
     // Only save it to filesystem if the value changed from last save
     if (last_saved_run_time_ != run_time_) {
+        journal();
+    }
+}
+
+void RunTimeSensor::journal() {
+    if (journal_ready_ && journal_.append(&run_time_)) {
         last_saved_run_time_ = run_time_;
-        save_configuration();
     }
 }
 
@@ -64,8 +85,8 @@ void RunTimeSensor::get_configuration(JsonObject& root) {
 static const char SCHEMA[] PROGMEM = R"###({
     "type": "object",
     "properties": {
-        "update_period": { "title": "Update period", "type": "number", "description": "Number of milliseconds between each run time update" },
-        "save_period": { "title": "Save period", "type": "number", "description": "Number of milliseconds between each run time value save in filesystem" },
+        "update_period": { "title": "Update period", "type": "number", "description": "Number of milliseconds between each run time update. Set by the sampling policy (/system/sampling_policy) for the engine running state" },
+        "save_period": { "title": "Save period", "type": "number", "description": "Number of milliseconds between each run time journal record" },
         "run_time": { "title": "Run time", "type": "number", "description": "The actual run time in seconds" }
     }
   })###";
@@ -83,7 +104,17 @@ bool RunTimeSensor::set_configuration(const JsonObject& config) {
     save_period_ = config["save_period"];
     run_time_ = config["run_time"];
 
+    // Run time edited through the web UI: record it right away
+    journal();
+
     return true;
 }
 
+void RunTimeSensor::set_sample_period(uint period) {
+    update_period_ = period;
+    if (update_timer_ != nullptr) {
+        update_timer_->set_period(period);
+    }
+}
+
 }  // namespace sensesp
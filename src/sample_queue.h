@@ -0,0 +1,51 @@
+#ifndef __SRC_SAMPLE_QUEUE_H__
+#define __SRC_SAMPLE_QUEUE_H__
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace sensesp {
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ *
+ * One task may push and one (possibly running on the other core) may pop
+ * without any locking. Size must be a power of two.
+ */
+template <typename T, size_t Size>
+class SampleQueue {
+    static_assert((Size & (Size - 1)) == 0, "SampleQueue size must be a power of two");
+
+   public:
+    // Producer side; false if the queue is full
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == Size) {
+            return false;
+        }
+        items_[head & (Size - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false if the queue is empty
+    bool pop(T* item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = items_[tail & (Size - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    T items_[Size];
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};
+};
+
+}  // namespace sensesp
+
+#endif
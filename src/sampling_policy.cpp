@@ -0,0 +1,96 @@
+#include "sampling_policy.h"
+
+#include "reaction_profiler.h"
+#include "sensesp/system/lambda_consumer.h"
+
+namespace sensesp {
+
+static const char* GROUP_NAMES[] = {"engine", "temperature", "electrical", "tanks", "run_time"};
+
+SamplingPolicy::SamplingPolicy(String config_path) : Configurable(config_path) {
+    load_configuration();
+}
+
+void SamplingPolicy::connect_rpms(ValueProducer<float>* rpms) {
+    rpms->connect_to(new LambdaConsumer<float>([this](float value) {
+        if (value > 0) {
+            last_running_ = millis();
+            if (!running_) {
+                this->apply(true);
+            }
+        }
+    }));
+}
+
+void SamplingPolicy::add(SamplingTarget* target, Group group) {
+    targets_.push_back({target, group});
+    Profile& profile = profiles_[group];
+    target->set_sample_period(running_ ? profile.running_period : profile.off_period);
+}
+
+void SamplingPolicy::start() {
+    last_running_ = millis();
+    ReactESP::app->onRepeat(1000, PROFILED("sampling_policy", 1000, [this]() {
+        if (running_ && millis() - last_running_ >= off_delay_) {
+            this->apply(false);
+        }
+    }));
+}
+
+void SamplingPolicy::apply(bool running) {
+    debugI("Engine %s, switching sampling profile", running ? "running" : "off");
+    running_ = running;
+    for (auto& target : targets_) {
+        Profile& profile = profiles_[target.group];
+        target.target->set_sample_period(running ? profile.running_period : profile.off_period);
+    }
+}
+
+void SamplingPolicy::get_configuration(JsonObject& root) {
+    for (int group = 0; group < kGroupCount; group++) {
+        root[String(GROUP_NAMES[group]) + "_running"] = profiles_[group].running_period;
+        root[String(GROUP_NAMES[group]) + "_off"] = profiles_[group].off_period;
+    }
+    root["off_delay"] = off_delay_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "engine_running": { "title": "Engine sensors, engine running", "type": "number", "description": "Milliseconds between oil pressure and coolant temperature reads while the engine runs" },
+        "engine_off": { "title": "Engine sensors, engine off", "type": "number", "description": "Milliseconds between oil pressure and coolant temperature reads while the engine is off" },
+        "temperature_running": { "title": "1-Wire temperatures, engine running", "type": "number", "description": "Milliseconds between 1-Wire temperature reads while the engine runs" },
+        "temperature_off": { "title": "1-Wire temperatures, engine off", "type": "number", "description": "Milliseconds between 1-Wire temperature reads while the engine is off" },
+        "electrical_running": { "title": "Alternator current, engine running", "type": "number", "description": "Milliseconds between alternator current reads while the engine runs" },
+        "electrical_off": { "title": "Alternator current, engine off", "type": "number", "description": "Milliseconds between alternator current reads while the engine is off" },
+        "tanks_running": { "title": "Tank levels, engine running", "type": "number", "description": "Milliseconds between tank level reads while the engine runs" },
+        "tanks_off": { "title": "Tank levels, engine off", "type": "number", "description": "Milliseconds between tank level reads while the engine is off" },
+        "run_time_running": { "title": "Run time, engine running", "type": "number", "description": "Milliseconds between run time updates while the engine runs" },
+        "run_time_off": { "title": "Run time, engine off", "type": "number", "description": "Milliseconds between run time updates while the engine is off" },
+        "off_delay": { "title": "Engine off delay", "type": "number", "description": "Milliseconds the RPMs must stay at zero before switching to the engine off periods" }
+    }
+  })###";
+
+String SamplingPolicy::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool SamplingPolicy::set_configuration(const JsonObject& config) {
+    for (int group = 0; group < kGroupCount; group++) {
+        if (!config.containsKey(String(GROUP_NAMES[group]) + "_running") ||
+            !config.containsKey(String(GROUP_NAMES[group]) + "_off")) {
+            return false;
+        }
+    }
+    if (!config.containsKey("off_delay")) {
+        return false;
+    }
+    for (int group = 0; group < kGroupCount; group++) {
+        profiles_[group].running_period = config[String(GROUP_NAMES[group]) + "_running"];
+        profiles_[group].off_period = config[String(GROUP_NAMES[group]) + "_off"];
+    }
+    off_delay_ = config["off_delay"];
+    // Apply the new periods right away
+    this->apply(running_);
+    return true;
+}
+
+}  // namespace sensesp
@@ -0,0 +1,74 @@
+#ifndef __SRC_SAMPLING_POLICY_H__
+#define __SRC_SAMPLING_POLICY_H__
+
+#include <vector>
+
+#include "sensesp.h"
+#include "sensesp/system/configurable.h"
+#include "sensesp/system/startable.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+// A sensor whose sampling period can be changed at run time
+class SamplingTarget {
+   public:
+    // Called from the main loop; takes effect immediately, or at start()
+    // before the sensor is started
+    virtual void set_sample_period(uint period) = 0;
+};
+
+/**
+ * @brief Switches the sensor sampling periods with the engine running state
+ *
+ * Each sensor belongs to a group with an "engine running" and an "engine
+ * off" period. The engine counts as running as soon as the RPM input is
+ * above zero, and as off once it has stayed at zero for off_delay ms, so
+ * the engine is watched closely while it cools down. The policy owns the
+ * sampling period of the sensors added to it: they take the period of the
+ * current state when added, and their own read delay setting is only the
+ * period before that.
+ */
+class SamplingPolicy : public Configurable, public Startable {
+   public:
+    enum Group { kEngine, kTemperature, kElectrical, kTanks, kRunTime, kGroupCount };
+
+    SamplingPolicy(String config_path = "");
+    void connect_rpms(ValueProducer<float>* rpms);
+    void add(SamplingTarget* target, Group group);
+    void start() override final;
+    bool running() { return running_; }
+
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    struct Profile {
+        uint running_period;
+        uint off_period;
+    };
+
+    struct Target {
+        SamplingTarget* target;
+        Group group;
+    };
+
+    void apply(bool running);
+
+    Profile profiles_[kGroupCount] = {
+        {100, 60000},     // Engine: oil pressure, coolant temperature
+        {1000, 60000},    // Temperature: 1-Wire bus
+        {1000, 60000},    // Electrical: alternator current
+        {2000, 60000},    // Tanks
+        {10000, 60000},   // Run time
+    };
+    uint off_delay_ = 120000;
+    std::vector<Target> targets_;
+    bool running_ = true;
+    uint32_t last_running_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,133 @@
+#include "sensor_log.h"
+
+#include "pipeline_arena.h"
+#include "reaction_profiler.h"
+
+namespace sensesp {
+
+static const char* MODE_NAMES[] = {"off", "record", "replay"};
+
+SensorLog::SensorLog(String config_path)
+    : Configurable(config_path),
+      ring_{"/sensor_log", sizeof(GorillaBlock), BLOCK_CAPACITY} {
+    load_configuration();
+}
+
+SensorLogTap* SensorLog::tap(String name) {
+    if (taps_.size() >= GorillaBlock::MAX_SOURCES) {
+        debugW("Sensor log source %s will not be recorded", name.c_str());
+    }
+    auto tap = arena_new<SensorLogTap>(this, taps_.size());
+    debugI("Sensor log source %u: %s", taps_.size(), name.c_str());
+    taps_.push_back(tap);
+    return tap;
+}
+
+void SensorLog::start() {
+    if (mode_ == kOff || !ring_.begin()) {
+        return;
+    }
+    if (mode_ == kRecord) {
+        if (ring_.read_latest(&block_)) {
+            boot_ = block_.boot + 1;
+        }
+        encoder_.reset();
+        block_.boot = boot_;
+    }
+    if (mode_ == kReplay) {
+        debugI("Replaying %u sensor log blocks at %.0fx", ring_.size(), speed_);
+        ReactESP::app->onRepeat(10, PROFILED("sensor_log_replay", 10, [this]() { this->replay(); }));
+    }
+}
+
+void SensorLog::record(uint8_t source, float value) {
+    uint32_t now = millis();
+    if (!encoder_.append(source, now, value) && source < GorillaBlock::MAX_SOURCES) {
+        // Block full
+        ring_.append(&block_);
+        encoder_.reset();
+        block_.boot = boot_;
+        encoder_.append(source, now, value);
+    }
+}
+
+void SensorLog::replay() {
+    while (true) {
+        if (!replay_pending_) {
+            // Decode the next sample, loading the next block as needed; skip
+            // any block that fails the CRC check
+            while (!decoder_.next(&pending_source_, &pending_timestamp_, &pending_value_)) {
+                if (replay_block_index_ >= ring_.size()) {
+                    return;
+                }
+                if (!ring_.read(replay_block_index_++, &block_)) {
+                    block_.count = 0;
+                }
+                decoder_.reset();
+            }
+            replay_pending_ = true;
+            if (!replay_started_ || block_.boot != replay_boot_) {
+                // millis() restarted with this boot: replay its first sample now
+                replay_started_ = true;
+                replay_boot_ = block_.boot;
+                replay_offset_ = pending_timestamp_;
+                replay_start_ = millis();
+            }
+        }
+
+        uint32_t replay_time = replay_offset_ + (millis() - replay_start_) * speed_;
+        if ((int32_t)(pending_timestamp_ - replay_time) > 0) {
+            return;
+        }
+        if (pending_source_ < taps_.size()) {
+            taps_[pending_source_]->emit(pending_value_);
+        }
+        replay_pending_ = false;
+    }
+}
+
+void SensorLog::get_configuration(JsonObject& root) {
+    root["mode"] = MODE_NAMES[mode_];
+    root["speed"] = speed_;
+};
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "mode": { "title": "Mode", "type": "string", "enum": ["off", "record", "replay"], "description": "Record the raw sensor values to flash, or replay the recorded values instead of the live sensors. Takes effect after a restart" },
+        "speed": { "title": "Replay speed", "type": "number", "description": "Replay speed as a multiple of real time" }
+    }
+  })###";
+
+String SensorLog::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool SensorLog::set_configuration(const JsonObject& config) {
+    String expected[] = {"mode", "speed"};
+    for (auto str : expected) {
+        if (!config.containsKey(str)) {
+            return false;
+        }
+    }
+    String mode = config["mode"];
+    mode_ = kOff;
+    for (int i = 0; i < 3; i++) {
+        if (mode == MODE_NAMES[i]) {
+            mode_ = (Mode)i;
+        }
+    }
+    speed_ = config["speed"];
+    return true;
+}
+
+void SensorLogTap::set_input(float input, uint8_t inputChannel) {
+    if (log_->mode_ == SensorLog::kReplay) {
+        // Live values are replaced by the replayed ones
+        return;
+    }
+    if (log_->mode_ == SensorLog::kRecord) {
+        log_->record(source_, input);
+    }
+    this->emit(input);
+}
+
+}  // namespace sensesp
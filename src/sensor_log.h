@@ -0,0 +1,84 @@
+#ifndef __SRC_SENSOR_LOG_H__
+#define __SRC_SENSOR_LOG_H__
+
+#include <vector>
+
+#include "flash_ring.h"
+#include "gorilla_codec.h"
+#include "sensesp.h"
+#include "sensesp/system/configurable.h"
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+class SensorLogTap;
+
+/**
+ * @brief Records raw sensor streams to flash and replays them
+ *
+ * Taps are pass-through transforms inserted right after each raw producer.
+ * In "record" mode every value going through a tap is Gorilla-encoded into
+ * the current block; full blocks are appended to a flash ring, so the log
+ * always holds the most recent stretch of data. Timestamps are millis(),
+ * so every block also carries a boot counter, one more than the one of the
+ * newest block found in the ring at startup. In "replay" mode the
+ * taps ignore the live sensors and emit the logged values instead, at
+ * `speed` times real time, through the same transform graph.
+ */
+class SensorLog : public Configurable {
+   public:
+    static const size_t BLOCK_CAPACITY = 128;
+
+    SensorLog(String config_path = "");
+    // Creates a tap for a raw producer; `name` identifies it in the log
+    SensorLogTap* tap(String name);
+    void start();
+
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    friend class SensorLogTap;
+
+    enum Mode { kOff, kRecord, kReplay };
+
+    void record(uint8_t source, float value);
+    void replay();
+
+    Mode mode_ = kOff;
+    float speed_ = 1;
+    FlashRing ring_;
+    std::vector<SensorLogTap*> taps_;
+    GorillaBlock block_;
+    GorillaEncoder encoder_{&block_};
+    GorillaDecoder decoder_{&block_};
+
+    uint16_t boot_ = 0;
+
+    // Replay state
+    size_t replay_block_index_ = 0;
+    uint16_t replay_boot_;
+    bool replay_pending_ = false;
+    uint8_t pending_source_;
+    uint32_t pending_timestamp_;
+    float pending_value_;
+    bool replay_started_ = false;
+    uint32_t replay_offset_;
+    uint32_t replay_start_;
+};
+
+// Pass-through transform recording or replaying one raw sensor stream
+class SensorLogTap : public FloatTransform {
+   public:
+    SensorLogTap(SensorLog* log, uint8_t source) : FloatTransform(""), log_{log}, source_{source} {}
+    void set_input(float input, uint8_t inputChannel = 0) override;
+
+   private:
+    SensorLog* log_;
+    uint8_t source_;
+};
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,253 @@
+#include "sensor_pipelines.h"
+
+#include "config_store.h"
+#include "configuration.h"
+#include "deadband.h"
+#include "engine_alarm.h"
+#include "pipeline_arena.h"
+#include "rpm_sensor.h"
+#include "run_time_sensor.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/transforms/linear.h"
+#include "sensesp/transforms/moving_average.h"
+#include "sensesp_base_app.h"
+#include "tank_capacity.h"
+
+namespace sensesp {
+
+// Logs the values of `producer` with the value log, off the main loop
+static void logValues(PipelineServices& services, ValueProducer<float>* producer, const char* format) {
+    if (services.value_log != nullptr) {
+        services.value_log->tap(producer, format);
+    }
+}
+
+// Publishes the number of values held back by `deadband` to Signal K
+static Deadband* reportSuppressed(Deadband* deadband, String name) {
+    deadband->suppressed()->connect_to(arena_new<SKOutputFloat>(
+        "sensorDevice." + SensESPBaseApp::get_hostname() + ".deadband." + name + ".suppressed"));
+    return deadband;
+}
+
+FuelTankSensor* setupDieselTank(PipelineServices& services) {
+    // Tank level
+    auto fuel_tank_sensor = arena_new<Stored<FuelTankSensor>>(FUEL_TANK_EMPTY_MM, FUEL_TANK_FULL_MM, 2000, "/data/fuel_tank_level/sensor");
+    services.sampling->add(fuel_tank_sensor, SamplingPolicy::kTanks);
+    // The raw level in mm is logged, before the calibration
+    auto fuel_tank_level = fuel_tank_sensor
+                               ->connect_to(services.sensor_log->tap("fuel_tank_mm"))
+                               ->connect_to(fuel_tank_sensor->level())
+                               ->connect_to(arena_new<Stored<MovingAverage>>(10, 1.0, "/data/fuel_tank_level/samples"));
+    auto fuel_tank_level_output = fuel_tank_level->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.005, false, 60000, "/data/fuel_tank_level/deadband"), "fuelTankLevel"));
+    fuel_tank_level_output->connect_to(arena_new<Stored<SKOutputFloat>>("tanks.fuel.main.currentLevel",
+                                                                        "/data/fuel_tank_level/sk_path",
+                                                                        "ratio"));
+    services.nmea->connect_fuel_level(fuel_tank_level_output);
+
+    // Tank capacity
+    auto fuel_tank_capacity = arena_new<Stored<TankCapacity>>(FUEL_TANK_CAPACITY, 600000, "/data/fuel_tank_capacity/capacity_m3");
+    fuel_tank_capacity->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "tanks.fuel.main.capacity",
+        "/data/fuel_tank_capacity/sk_path",
+        "m3"));
+    services.nmea->connect_fuel_capacity(fuel_tank_capacity);
+
+    // Tank volume
+    fuel_tank_level_output
+        ->connect_to(arena_new<TankVolume>(fuel_tank_capacity))
+        ->connect_to(arena_new<Stored<SKOutputFloat>>("tanks.fuel.main.currentVolume",
+                                                      "/data/fuel_tank_volume/sk_path",
+                                                      "m3"));
+
+    logValues(services, fuel_tank_level, "Diesel tank level: %f m3");
+
+    return fuel_tank_sensor;
+}
+
+OneWireTemperatures setup1WireTempSensors(PipelineServices& services) {
+    auto onewire_bus = arena_new<OneWireBus>(ONEWIRE_PIN, services.acquisition, 1000);
+    services.sampling->add(onewire_bus, SamplingPolicy::kTemperature);
+
+    // Engine room temperature
+    auto engine_room_temperature_sensor = arena_new<Stored<OneWireBusTemperature>>(onewire_bus, 12, "/data/engine_room_temperature/sensor");
+    auto engine_room_temperature = engine_room_temperature_sensor->connect_to(services.sensor_log->tap("engine_room_temperature"));
+    engine_room_temperature
+        ->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.2, false, 60000, "/data/engine_room_temperature/deadband"), "engineRoomTemperature"))
+        ->connect_to(arena_new<Stored<SKOutputFloat>>(
+            "environment.inside.engineRoom.temperature",
+            "/data/engine_room_temperature/sk_path",
+            "K"));
+
+    // Engine alternator temperature
+    auto engine_alternator_temperature_sensor = arena_new<Stored<OneWireBusTemperature>>(onewire_bus, 12, "/data/engine_alternator_temperature/sensor");
+    auto engine_alternator_temperature = engine_alternator_temperature_sensor->connect_to(services.sensor_log->tap("engine_alternator_temperature"));
+    engine_alternator_temperature
+        ->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.2, false, 60000, "/data/engine_alternator_temperature/deadband"), "engineAlternatorTemperature"))
+        ->connect_to(arena_new<Stored<SKOutputFloat>>(
+            "electrical.alternators.engine.temperature",
+            "/data/engine_alternator_temperature/sk_path",
+            "K"));
+
+    // Engine exhaust temperature; 0.25 K resolution is plenty and converts in 188 ms
+    auto engine_exhaust_temperature_sensor = arena_new<Stored<OneWireBusTemperature>>(onewire_bus, 10, "/data/engine_exhaust_temperature/sensor");
+    auto engine_exhaust_temperature = engine_exhaust_temperature_sensor->connect_to(services.sensor_log->tap("engine_exhaust_temperature"));
+    services.history->track(engine_exhaust_temperature, "propulsion.main.exhaustTemperature", 0.01, 273.15);
+    auto engine_exhaust_temperature_alarm = arena_new<Stored<EngineAlarm>>(services.acquisition, false, 333.15, 5, 5000, "/data/engine_exhaust_temperature/alarm");
+    engine_exhaust_temperature->connect_to(engine_exhaust_temperature_alarm);
+    services.nmea->connect_water_flow_alarm(engine_exhaust_temperature_alarm);
+    auto engine_exhaust_temperature_output = engine_exhaust_temperature->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.5, false, 30000, "/data/engine_exhaust_temperature/deadband"), "engineExhaustTemperature"));
+    services.nmea->connect_exhaust_temperature(engine_exhaust_temperature_output);
+    engine_exhaust_temperature_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "propulsion.main.exhaustTemperature",
+        "/data/engine_exhaust_temperature/sk_path",
+        "K"));
+
+    logValues(services, engine_room_temperature, "Engine room temp: %f K");
+    logValues(services, engine_alternator_temperature, "Alternator temp: %f K");
+    logValues(services, engine_exhaust_temperature, "Engine exhaust temp: %f K");
+    logValues(services, services.nmea->ambient_temperature(), "Ambient temp (NMEA 2000): %f K");
+
+    return {engine_room_temperature_sensor, engine_alternator_temperature_sensor, engine_exhaust_temperature_sensor};
+}
+
+ResistanceSensor* setupWaterTank(PipelineServices& services) {
+    // Tank level
+    auto fresh_water_tank_sensor = arena_new<Stored<ResistanceSensor>>(services.ads1115_scheduler, FRESH_WATER_TANK_SENSOR_CHANNEL, 500, "/data/fresh_water_tank_level/sensor");
+    services.sampling->add(fresh_water_tank_sensor, SamplingPolicy::kTanks);
+    auto fresh_water_tank_level = fresh_water_tank_sensor
+                                      ->connect_to(services.sensor_log->tap("fresh_water_tank_resistance"))
+                                      ->connect_to(arena_new<Stored<MovingAverage>>(10, 1.0, "/data/fresh_water_tank_level/samples"))
+                                      ->connect_to(arena_new<Stored<TankLevelSender>>("/data/fresh_water_tank_level/interpolator"));
+    auto fresh_water_tank_level_output = fresh_water_tank_level->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.005, false, 60000, "/data/fresh_water_tank_level/deadband"), "freshWaterTankLevel"));
+    fresh_water_tank_level_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "tanks.freshWater.main.currentLevel",
+        "/data/fresh_water_tank_level/sk_path",
+        "ratio"));
+    services.nmea->connect_water_level(fresh_water_tank_level_output);
+
+    // Tank capacity; the config path is the one of the Linear transform that used to hold it
+    auto fresh_water_tank_capacity = arena_new<Stored<TankCapacity>>(FRESH_WATER_TANK_CAPACITY, 600000, "/data/fresh_water_tank_volume/capacity_m3");
+    fresh_water_tank_capacity->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "tanks.freshWater.main.capacity",
+        "/data/fresh_water_tank_capacity/sk_path",
+        "m3"));
+    services.nmea->connect_water_capacity(fresh_water_tank_capacity);
+
+    // Tank volume
+    fresh_water_tank_level_output
+        ->connect_to(arena_new<TankVolume>(fresh_water_tank_capacity))
+        ->connect_to(arena_new<Stored<SKOutputFloat>>(
+            "tanks.freshWater.main.currentVolume",
+            "/data/fresh_water_tank_volume/sk_path",
+            "m3"));
+
+    logValues(services, fresh_water_tank_level, "Fresh water tank level: %f %%");
+    logValues(services, fresh_water_tank_capacity, "Fresh water tank capacity: %f m3");
+
+    return fresh_water_tank_sensor;
+}
+
+ValueProducer<float>* setupEngineRpmsAndRuntime(PipelineServices& services, ValueProducer<float>* engine_rpms_sensor) {
+    // Engine RPMs
+    auto engine_rpms_raw = engine_rpms_sensor->connect_to(services.sensor_log->tap("engine_rpms"));
+    auto engine_rpms = engine_rpms_raw->connect_to(arena_new<Stored<RpmMultiplier>>(RPM_MULTIPLIER, "/data/engine_rpms/multiplier"));
+    services.sampling->connect_rpms(engine_rpms);
+    auto engine_rpms_output = engine_rpms->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.01, true, 10000, "/data/engine_rpms/deadband"), "engineRpms"));
+    services.nmea->connect_engine_rpms(engine_rpms_output);
+    engine_rpms_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "propulsion.main.revolutions",
+        "/data/engine_rpms/sk_path",
+        "Hz"));
+
+    // Engine run time
+    // Not in the config store: the run time is journaled on its own and a
+    // second set_configuration() would replay the stale run time
+    auto engine_runtime = arena_new<RunTimeSensor>(engine_rpms, 10000, 60000, "/data/engine_runtime");
+    services.sampling->add(engine_runtime, SamplingPolicy::kRunTime);
+    auto engine_runtime_output = engine_runtime->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(60, false, 300000, "/data/engine_runtime/deadband"), "engineRuntime"));
+    services.nmea->connect_engine_run_time(engine_runtime_output);
+    engine_runtime_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "propulsion.main.runTime",
+        "/data/engine_runtime/sk_path",
+        "s"));
+
+    logValues(services, engine_rpms_raw, "Engine RPMs (raw): %f Hz");
+    logValues(services, engine_rpms, "Engine RPMs: %f");
+    logValues(services, engine_runtime, "Engine runtime: %f seconds");
+
+    return engine_rpms;
+}
+
+ResistanceSensor* setupEngineCoolantTemperature(PipelineServices& services) {
+    auto engine_coolant_temperature_sensor = arena_new<Stored<ResistanceSensor>>(services.ads1115_scheduler, ENGINE_COOLANT_TEMP_SENSOR_CHANNEL, 500, "/data/engine_coolant_temperature/sensor");
+    services.sampling->add(engine_coolant_temperature_sensor, SamplingPolicy::kEngine);
+    auto engine_coolant_temperature_resistance = engine_coolant_temperature_sensor->connect_to(services.sensor_log->tap("engine_coolant_resistance"));
+    auto engine_coolant_temperature = engine_coolant_temperature_resistance->connect_to(arena_new<Stored<CoolantTempSender>>("/data/engine_coolant_temperature/interpolator"));
+    services.history->track(engine_coolant_temperature, "propulsion.main.coolantTemperature", 0.01, 273.15);
+    auto engine_coolant_temperature_alarm = arena_new<Stored<EngineAlarm>>(services.acquisition, false, 368.15, 3, 2000, "/data/engine_coolant_temperature/alarm");
+    engine_coolant_temperature->connect_to(engine_coolant_temperature_alarm);
+    services.nmea->connect_over_temperature_alarm(engine_coolant_temperature_alarm);
+    auto engine_coolant_temperature_output = engine_coolant_temperature->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.5, false, 30000, "/data/engine_coolant_temperature/deadband"), "engineCoolantTemperature"));
+    services.nmea->connect_coolant_temperature(engine_coolant_temperature_output);
+    engine_coolant_temperature_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "propulsion.main.coolantTemperature",
+        "/data/engine_coolant_temperature/sk_path",
+        "K"));
+
+    // Treat coolant temperature as the actual engine temperature
+    engine_coolant_temperature_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "propulsion.main.temperature",
+        "/data/engine_temperature/sk_path",
+        "K"));
+
+    logValues(services, engine_coolant_temperature_resistance, "Engine coolant sensor resistance: %f Ohms");
+    logValues(services, engine_coolant_temperature, "Engine coolant temperature: %f K");
+
+    return engine_coolant_temperature_sensor;
+}
+
+ResistanceSensor* setupEngineOilTemperature(PipelineServices& services, ValueProducer<float>* engine_rpms) {
+    auto engine_oil_pressure_sensor = arena_new<Stored<ResistanceSensor>>(services.ads1115_scheduler, ENGINE_OIL_PRESSURE_SENSOR_CHANNEL, 500, "/data/engine_oil_pressure/sensor");
+    services.sampling->add(engine_oil_pressure_sensor, SamplingPolicy::kEngine);
+    auto engine_oil_pressure_resistance = engine_oil_pressure_sensor->connect_to(services.sensor_log->tap("engine_oil_pressure_resistance"));
+    auto engine_oil_pressure = engine_oil_pressure_resistance->connect_to(arena_new<Stored<OilPressureSender>>("/data/engine_oil_pressure/interpolator"));
+    services.history->track(engine_oil_pressure, "propulsion.main.oilPressure", 100);
+    // Oil pressure is only expected while the engine runs
+    auto engine_oil_pressure_alarm = arena_new<Stored<EngineAlarm>>(services.acquisition, true, 50000, 20000, 3000, "/data/engine_oil_pressure/alarm");
+    engine_oil_pressure_alarm->require_running(engine_rpms);
+    engine_oil_pressure->connect_to(engine_oil_pressure_alarm);
+    services.nmea->connect_low_oil_pressure_alarm(engine_oil_pressure_alarm);
+    auto engine_oil_pressure_output = engine_oil_pressure->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(2000, false, 30000, "/data/engine_oil_pressure/deadband"), "engineOilPressure"));
+    services.nmea->connect_oil_pressure(engine_oil_pressure_output);
+    engine_oil_pressure_output->connect_to(arena_new<Stored<SKOutputFloat>>(
+        "propulsion.main.oilPressure",
+        "/data/engine_oil_pressure/sk_path",
+        "Pa"));
+
+    logValues(services, engine_oil_pressure_resistance, "Engine oil pressure resistance: %f Ohms");
+    logValues(services, engine_oil_pressure, "Engine oil pressure: %f Pa");
+
+    return engine_oil_pressure_sensor;
+}
+
+RmsVoltageSensor* setupAlternatorOutput(PipelineServices& services) {
+    auto alternator_output_sensor = arena_new<Stored<RmsVoltageSensor>>(services.ads1115_scheduler, ALTERNATOR_OUTPUT_SENSOR_CHANNEL, 1000, 200, "/data/alternator_output/sensor");
+    services.sampling->add(alternator_output_sensor, SamplingPolicy::kElectrical);
+    auto alternator_output_voltage = alternator_output_sensor->connect_to(services.sensor_log->tap("alternator_output_voltage"));
+    // Alt. I = (V / R) * transformer multiplier
+    auto alternator_output = alternator_output_voltage->connect_to(arena_new<Stored<Linear>>(PZCT02_MULTIPLIER * (1 / PZCT02_BURDEN_RESISTANCE), 0, "/data/alternator_output/linear"));
+    alternator_output
+        ->connect_to(reportSuppressed(arena_new<Stored<Deadband>>(0.5, false, 30000, "/data/alternator_output/deadband"), "alternatorOutput"))
+        ->connect_to(arena_new<Stored<SKOutputFloat>>(
+            "electrical.alternators.engine.current",
+            "/data/alternator_output/sk_path",
+            "A"));
+
+    logValues(services, alternator_output_voltage, "Alternator current sensor voltage: %f V RMS");
+    logValues(services, alternator_output, "Alternator output current: %f A");
+    logValues(services, services.nmea->battery_voltage(), "Battery voltage (NMEA 2000): %f V");
+
+    return alternator_output_sensor;
+}
+
+}  // namespace sensesp
@@ -0,0 +1,55 @@
+#ifndef __SRC_SENSOR_PIPELINES_H__
+#define __SRC_SENSOR_PIPELINES_H__
+
+#include "acquisition_task.h"
+#include "ads1115_scheduler.h"
+#include "deferred_log.h"
+#include "fuel_tank_sensor.h"
+#include "history_store.h"
+#include "nmea.h"
+#include "onewire_bus.h"
+#include "resistance_sensor.h"
+#include "rms_voltage_sensor.h"
+#include "sampling_policy.h"
+#include "sensor_log.h"
+
+namespace sensesp {
+
+/**
+ * @brief The services setup() creates for the sensor pipelines
+ *
+ * The pipelines are built by the setup*() functions below, from each sensor
+ * to its Signal K outputs, NMEA 2000 and the history. main.cpp and the
+ * pipeline benchmarks share them, so the benchmarks measure the pipelines
+ * the firmware runs.
+ */
+struct PipelineServices {
+    Nmea* nmea;
+    SensorLog* sensor_log;
+    HistoryStore* history;
+    SamplingPolicy* sampling;
+    AcquisitionTask* acquisition;
+    Ads1115Scheduler* ads1115_scheduler;
+    // Producer values are logged to it, if any
+    DeferredLog* value_log;
+};
+
+struct OneWireTemperatures {
+    OneWireBusTemperature* engine_room;
+    OneWireBusTemperature* engine_alternator;
+    OneWireBusTemperature* engine_exhaust;
+};
+
+// Each returns the sensor at the head of its pipeline
+FuelTankSensor* setupDieselTank(PipelineServices& services);
+OneWireTemperatures setup1WireTempSensors(PipelineServices& services);
+ResistanceSensor* setupWaterTank(PipelineServices& services);
+// From the raw RPM sensor (Hz) on; returns the engine RPMs
+ValueProducer<float>* setupEngineRpmsAndRuntime(PipelineServices& services, ValueProducer<float>* engine_rpms_sensor);
+ResistanceSensor* setupEngineCoolantTemperature(PipelineServices& services);
+ResistanceSensor* setupEngineOilTemperature(PipelineServices& services, ValueProducer<float>* engine_rpms);
+RmsVoltageSensor* setupAlternatorOutput(PipelineServices& services);
+
+}  // namespace sensesp
+
+#endif
@@ -0,0 +1,44 @@
+#include "tank_capacity.h"
+
+#include "reaction_profiler.h"
+
+namespace sensesp {
+
+TankCapacity::TankCapacity(float capacity, uint heartbeat, String config_path)
+    : FloatSensor(config_path),
+      capacity_{capacity},
+      heartbeat_{heartbeat} {
+    load_configuration();
+}
+
+void TankCapacity::start() {
+    ReactESP::app->onRepeat(heartbeat_, PROFILED("tank_capacity", heartbeat_, [this]() { this->emit(capacity_); }));
+    this->emit(capacity_);
+}
+
+void TankCapacity::get_configuration(JsonObject& root) { root["capacity"] = capacity_; };
+
+static const char SCHEMA[] PROGMEM = R"###({
+    "type": "object",
+    "properties": {
+        "capacity": { "title": "Capacity", "type": "number", "description": "Total capacity of the tank, in cubic meters (m3)" }
+    }
+  })###";
+
+String TankCapacity::get_config_schema() { return FPSTR(SCHEMA); }
+
+bool TankCapacity::set_configuration(const JsonObject& config) {
+    // Capacities used to be the multiplier of a Linear transform
+    const char* key = config.containsKey("capacity") ? "capacity" : "multiplier";
+    if (!config.containsKey(key)) {
+        return false;
+    }
+    float capacity = config[key];
+    if (capacity != capacity_) {
+        capacity_ = capacity;
+        this->emit(capacity_);
+    }
+    return true;
+}
+
+}  // namespace sensesp
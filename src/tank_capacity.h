@@ -0,0 +1,44 @@
+#ifndef __SRC_TANK_CAPACITY_H__
+#define __SRC_TANK_CAPACITY_H__
+
+#include "sensesp.h"
+#include "sensesp/sensors/sensor.h"
+#include "sensesp/transforms/transform.h"
+
+namespace sensesp {
+
+/**
+ * @brief Configured total capacity of a tank (m3)
+ *
+ * Emits the capacity at start, whenever it is changed in the configuration
+ * and otherwise only every `heartbeat` ms, so late Signal K subscribers
+ * still get it.
+ */
+class TankCapacity : public FloatSensor {
+   public:
+    TankCapacity(float capacity, uint heartbeat = 600000, String config_path = "");
+    void start() override final;
+    float capacity() { return capacity_; }
+
+    virtual void get_configuration(JsonObject& doc) override final;
+    virtual bool set_configuration(const JsonObject& config) override final;
+    virtual String get_config_schema() override;
+
+   private:
+    float capacity_;
+    uint heartbeat_;
+};
+
+// Tank volume (m3) from its level (ratio) and the tank's TankCapacity
+class TankVolume : public FloatTransform {
+   public:
+    TankVolume(TankCapacity* capacity) : FloatTransform(""), capacity_{capacity} {}
+    void set_input(float input, uint8_t inputChannel = 0) override { this->emit(input * capacity_->capacity()); }
+
+   private:
+    TankCapacity* capacity_;
+};
+
+}  // namespace sensesp
+
+#endif
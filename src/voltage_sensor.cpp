@@ -2,25 +2,15 @@
 
 namespace sensesp {
 
-VoltageSensor::VoltageSensor(Adafruit_ADS1115* ads1115, int channel, uint read_delay, String config_path)
+AdcSensor::AdcSensor(Ads1115Scheduler* ads1115_scheduler, int channel, uint read_delay, String config_path)
     : FloatSensor(config_path),
-      ads1115_{ads1115},
+      ads1115_scheduler_{ads1115_scheduler},
       read_delay_{read_delay},
       channel_{channel} {
     load_configuration();
 }
 
-void VoltageSensor::start() {
-    ReactESP::app->onRepeat(read_delay_, [this]() { this->update(); });
-}
-
-void VoltageSensor::update() {
-    int16_t adc_output = ads1115_->readADC_SingleEnded(channel_);
-    float adc_output_volts = ads1115_->computeVolts(adc_output);
-    this->emit(ADS1115INPUTSCALE * adc_output_volts / ADS1115MEASUREMENTCURRENT);
-};
-
-void VoltageSensor::get_configuration(JsonObject& root) {
+void AdcSensor::get_configuration(JsonObject& root) {
     root["read_delay"] = read_delay_;
     root["channel"] = channel_;
 };
@@ -28,14 +18,14 @@ void VoltageSensor::get_configuration(JsonObject& root) {
 static const char SCHEMA[] PROGMEM = R"###({
     "type": "object",
     "properties": {
-        "read_delay": { "title": "Read delay", "type": "number", "description": "Number of milliseconds between each analogRead(A0)" },
+        "read_delay": { "title": "Read delay", "type": "number", "description": "Number of milliseconds between each read. Set by the sampling policy (/system/sampling_policy) for the engine running state" },
         "channel": { "title": "Sensor channel", "type": "number", "description": "Channel in the ADS1115 where the sensor is" }
     }
   })###";
 
-String VoltageSensor::get_config_schema() { return FPSTR(SCHEMA); }
+String AdcSensor::get_config_schema() { return FPSTR(SCHEMA); }
 
-bool VoltageSensor::set_configuration(const JsonObject& config) {
+bool AdcSensor::set_configuration(const JsonObject& config) {
     String expected[] = {"read_delay", "channel"};
     for (auto str : expected) {
         if (!config.containsKey(str)) {
@@ -47,4 +37,11 @@ bool VoltageSensor::set_configuration(const JsonObject& config) {
     return true;
 }
 
+void AdcSensor::set_sample_period(uint period) {
+    read_delay_ = period;
+    if (index_ >= 0) {
+        ads1115_scheduler_->set_period(index_, period);
+    }
+}
+
 }  // namespace sensesp
@@ -1,29 +1,48 @@
 #ifndef __SRC_VOLTAGE_SENSOR_H__
 #define __SRC_VOLTAGE_SENSOR_H__
 
-#include <Adafruit_ADS1X15.h>
-
+#include "adc_channel.h"
+#include "ads1115_scheduler.h"
 #include "configuration.h"
+#include "sampling_policy.h"
 #include "sensesp.h"
 #include "sensesp/sensors/sensor.h"
 
 namespace sensesp {
 
-class VoltageSensor : public FloatSensor {
+// Configuration and scheduling shared by all the ADS1115 channel sensors
+class AdcSensor : public FloatSensor, public SamplingTarget {
    public:
-    VoltageSensor(Adafruit_ADS1115* ads1115, int channel, uint read_delay = 500, String config_path = "");
-    void start() override final;
+    AdcSensor(Ads1115Scheduler* ads1115_scheduler, int channel, uint read_delay = 500, String config_path = "");
     virtual void get_configuration(JsonObject& doc) override final;
     virtual bool set_configuration(const JsonObject& config) override final;
     virtual String get_config_schema() override;
+    void set_sample_period(uint period) override;
 
    protected:
-    Adafruit_ADS1115* ads1115_;
+    Ads1115Scheduler* ads1115_scheduler_;
     uint read_delay_;
     int channel_;
-    void update();
+    // Scheduler channel index, once started
+    int index_ = -1;
+};
+
+// ADS1115 channel sensor emitting the value computed by the Channel conversion
+template <typename Channel>
+class AdcChannelSensor : public AdcSensor {
+   public:
+    AdcChannelSensor(Ads1115Scheduler* ads1115_scheduler, int channel, uint read_delay = 500, String config_path = "")
+        : AdcSensor(ads1115_scheduler, channel, read_delay, config_path) {}
+
+    void start() override final {
+        index_ = ads1115_scheduler_->add_channel(channel_, read_delay_, [this](float adc_output) {
+            this->emit(Channel::convert(adc_output));
+        });
+    }
 };
 
+using VoltageSensor = AdcChannelSensor<VoltageChannel>;
+
 }  // namespace sensesp
 
 #endif
@@ -0,0 +1,164 @@
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "acquisition_task.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "sample_queue.h"
+
+using namespace sensesp;
+
+// The acquisition task and the main loop as two plain host threads on the
+// real clock, with the main loop stalled by slow "network sends". Once
+// switched to real time the clock stays there, so those tests run last.
+
+static const uint32_t SAMPLE_INTERVAL = 5;
+static const uint32_t RUN_MS = 2000;
+// A Signal K websocket send stalling the main loop, every STALL_PERIOD ms
+static const uint32_t STALL_MS = 40;
+static const uint32_t STALL_PERIOD = 100;
+
+void setUp() {
+    if (!fakes::real_time()) {
+        fakes::retire_tasks();
+    }
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+// One producer and one consumer thread: every item arrives once, in order
+void test_sample_queue_between_threads() {
+    const uint32_t ITEMS = 1000000;
+    static SampleQueue<uint32_t, 256> queue;
+    auto begin = std::chrono::steady_clock::now();
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < ITEMS; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint32_t expected = 0;
+    bool in_order = true;
+    while (expected < ITEMS) {
+        uint32_t item;
+        if (queue.pop(&item)) {
+            in_order = in_order && item == expected;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    auto end = std::chrono::steady_clock::now();
+
+    char message[120];
+    snprintf(message, sizeof(message), "SampleQueue across threads: %.1f ns/item",
+             std::chrono::duration<double, std::nano>(end - begin).count() / ITEMS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(in_order);
+}
+
+// Runs the main loop for RUN_MS of real time, stalling it regularly
+static void run_stalled_loop() {
+    uint32_t start = millis();
+    uint32_t last_stall = start;
+    while (millis() - start < RUN_MS) {
+        ReactESP::app->tick();
+        if (millis() - last_stall >= STALL_PERIOD) {
+            last_stall = millis();
+            std::this_thread::sleep_for(std::chrono::milliseconds(STALL_MS));
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+static uint32_t max_interval(const std::vector<uint32_t>& timestamps) {
+    uint32_t longest = 0;
+    for (size_t i = 1; i < timestamps.size(); i++) {
+        longest = std::max(longest, timestamps[i] - timestamps[i - 1]);
+    }
+    return longest;
+}
+
+// Intervals stretched by at least half a stall
+static uint32_t late_samples(const std::vector<uint32_t>& timestamps) {
+    uint32_t late = 0;
+    for (size_t i = 1; i < timestamps.size(); i++) {
+        if (timestamps[i] - timestamps[i - 1] >= STALL_MS * 1000 / 2) {
+            late++;
+        }
+    }
+    return late;
+}
+
+static void report(const char* name, const std::vector<uint32_t>& timestamps) {
+    char message[160];
+    snprintf(message, sizeof(message), "%s: %u samples, %u late, longest interval %.1f ms for %u ms nominal", name,
+             (unsigned)timestamps.size(), (unsigned)late_samples(timestamps), max_interval(timestamps) / 1000.0f,
+             (unsigned)SAMPLE_INTERVAL);
+    TEST_MESSAGE(message);
+}
+
+// Sampling from the main loop, as before the acquisition task: every stall
+// delays the samples
+void test_sampling_in_main_loop() {
+    fakes::use_real_time();
+    std::vector<uint32_t> timestamps;
+    ReactESP::app->onRepeat(SAMPLE_INTERVAL, [&timestamps]() { timestamps.push_back(micros()); });
+    run_stalled_loop();
+    report("sampling in the main loop", timestamps);
+    TEST_ASSERT_GREATER_OR_EQUAL(STALL_MS * 1000, max_interval(timestamps));
+    TEST_ASSERT_GREATER_OR_EQUAL(RUN_MS / STALL_PERIOD / 2, late_samples(timestamps));
+}
+
+// Sampling in the acquisition task thread: samples keep their timing and
+// reach the main loop consumer in order, none lost
+void test_sampling_in_acquisition_task() {
+    fakes::use_real_time();
+    auto acquisition = new AcquisitionTask(ACQUISITION_CORE);
+    std::vector<uint32_t> timestamps;
+    std::vector<float> values;
+    uint8_t source = acquisition->add_source("test", SAMPLE_INTERVAL, [&](float value) {
+        timestamps.push_back(acquisition->sample_timestamp());
+        values.push_back(value);
+    });
+    float next = 0;
+    acquisition->reactor()->onRepeat(SAMPLE_INTERVAL, [&]() { acquisition->publish(source, next++); });
+
+    std::thread::id main_thread = std::this_thread::get_id();
+    std::atomic<std::thread::id> action_thread{main_thread};
+    acquisition->start();
+    acquisition->post([&action_thread]() { action_thread = std::this_thread::get_id(); });
+    run_stalled_loop();
+    report("sampling in the acquisition task", timestamps);
+
+    // Posted actions run in the acquisition task
+    TEST_ASSERT_TRUE(action_thread.load() != main_thread);
+    TEST_ASSERT_GREATER_THAN(RUN_MS / SAMPLE_INTERVAL / 2, values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        TEST_ASSERT_EQUAL_FLOAT(i, values[i]);
+    }
+    // The host may preempt the task thread now and then, but the stalls
+    // no longer show up
+    TEST_ASSERT_LESS_OR_EQUAL(2, late_samples(timestamps));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sample_queue_between_threads);
+    RUN_TEST(test_sampling_in_main_loop);
+    RUN_TEST(test_sampling_in_acquisition_task);
+    return UNITY_END();
+}
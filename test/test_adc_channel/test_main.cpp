@@ -0,0 +1,103 @@
+#include <Adafruit_ADS1X15.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include "acquisition_task.h"
+#include "adc_channel.h"
+#include "ads1115_scheduler.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "resistance_sensor.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "voltage_sensor.h"
+
+using namespace sensesp;
+
+// Pins the numbers coming out of the ADS1115 channel conversions, against
+// the formula the sensors used before and end to end through the fake chip
+
+// Folded at compile time
+static_assert(ResistanceChannel::counts_to_output > 0, "constexpr");
+static_assert(ads1115_full_scale(GAIN_ONE) == 4.096f, "GAIN_ONE full scale");
+static_assert(ads1115_full_scale(GAIN_SIXTEEN) == 0.256f, "GAIN_SIXTEEN full scale");
+
+// The old VoltageSensor::update() formula, which both sensors used
+static float old_resistance(Adafruit_ADS1115* ads1115, int16_t counts) {
+    return ADS1115INPUTSCALE * ads1115->computeVolts(counts) / ADS1115MEASUREMENTCURRENT;
+}
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+void test_constants() {
+    // 0.125 mV per count at GAIN_ONE, times the 29/2.048 input divider
+    TEST_ASSERT_EQUAL_FLOAT(0.0017700195f, VoltageChannel::counts_to_output);
+    // ... through the 10 mA current source
+    TEST_ASSERT_EQUAL_FLOAT(0.17700195f, ResistanceChannel::counts_to_output);
+    // Other gains, with unit scale and conversion
+    TEST_ASSERT_EQUAL_FLOAT(6.144f / 32768, (AdcChannel<GAIN_TWOTHIRDS, VoltageConversion, VoltageConversion>::counts_to_output));
+    TEST_ASSERT_EQUAL_FLOAT(0.256f / 32768, (AdcChannel<GAIN_SIXTEEN, VoltageConversion, VoltageConversion>::counts_to_output));
+}
+
+void test_resistance_matches_old_formula() {
+    Adafruit_ADS1115 ads1115;
+    ads1115.setGain(ADS1115GAIN);
+    for (int32_t counts = -32768; counts <= 32767; counts++) {
+        float expected = old_resistance(&ads1115, counts);
+        TEST_ASSERT_FLOAT_WITHIN(fabsf(expected) * 1e-6f, expected, ResistanceChannel::convert(counts));
+    }
+}
+
+// The alternator input is a voltage: no division by the measurement current
+void test_voltage_is_not_divided_by_current() {
+    Adafruit_ADS1115 ads1115;
+    ads1115.setGain(ADS1115GAIN);
+    for (int32_t counts = -32768; counts <= 32767; counts += 7) {
+        float expected = old_resistance(&ads1115, counts) * ADS1115MEASUREMENTCURRENT;
+        TEST_ASSERT_FLOAT_WITHIN(fabsf(expected) * 1e-6f, expected, VoltageChannel::convert(counts));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(14.16015625f, VoltageChannel::convert(8000));
+    TEST_ASSERT_EQUAL_FLOAT(-58.0f, VoltageChannel::convert(-32768));
+}
+
+// Sensors read from the fake chip: within one count of the connector value
+void test_sensors_end_to_end() {
+    auto ads1115 = new Adafruit_ADS1115();
+    ads1115->setGain(ADS1115GAIN);
+    auto acquisition = new AcquisitionTask(ACQUISITION_CORE);
+    auto scheduler = new Ads1115Scheduler(new Ads1115Device(ads1115), acquisition);
+    // 120 ohm sender on channel 0, 13.8 V on channel 1
+    ads1115->set_input(0, [](uint64_t us) { return 120 * ADS1115MEASUREMENTCURRENT / ADS1115INPUTSCALE; });
+    ads1115->set_input(1, [](uint64_t us) { return 13.8f / ADS1115INPUTSCALE; });
+
+    auto resistance = new ResistanceSensor(scheduler, 0, 500);
+    auto voltage = new VoltageSensor(scheduler, 1, 500);
+    float ohms = NAN;
+    float volts = NAN;
+    resistance->connect_to(new LambdaConsumer<float>([&ohms](float value) { ohms = value; }));
+    voltage->connect_to(new LambdaConsumer<float>([&volts](float value) { volts = value; }));
+    resistance->start();
+    voltage->start();
+    acquisition->start();
+    fakes::run_ms(2000);
+
+    TEST_ASSERT_FLOAT_WITHIN(ResistanceChannel::counts_to_output, 120, ohms);
+    TEST_ASSERT_FLOAT_WITHIN(VoltageChannel::counts_to_output, 13.8f, volts);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_constants);
+    RUN_TEST(test_resistance_matches_old_formula);
+    RUN_TEST(test_voltage_is_not_divided_by_current);
+    RUN_TEST(test_sensors_end_to_end);
+    return UNITY_END();
+}
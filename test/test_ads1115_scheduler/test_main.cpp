@@ -0,0 +1,135 @@
+#include <Adafruit_ADS1X15.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "acquisition_task.h"
+#include "ads1115_scheduler.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+
+using namespace sensesp;
+
+// The ADS1115 sampling of the four analog senders, every 500 ms as in
+// main.cpp. The main loop blocking time is measured against the blocking
+// readADC_SingleEnded() calls the sensors made before the scheduler.
+
+static const int CHANNELS = 4;
+static const uint32_t RUN_MS = 10000;
+
+static Adafruit_ADS1115* ads1115;
+static AcquisitionTask* acquisition;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+
+    ads1115 = new Adafruit_ADS1115();
+    ads1115->setGain(GAIN_ONE);
+    ads1115->begin(ADS1115ADDR);
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        // 0.5, 1.0, 1.5 and 2.0 V
+        ads1115->set_input(channel, [channel](uint64_t us) { return 0.5f * (channel + 1); });
+    }
+    acquisition = new AcquisitionTask(ACQUISITION_CORE);
+}
+
+void tearDown() {}
+
+// Runs the main loop for `ms` and returns its longest tick (us)
+static uint64_t run_loop(uint32_t ms) {
+    uint64_t longest = 0;
+    for (uint32_t i = 0; i < ms; i++) {
+        fakes::advance_ms(1);
+        uint64_t start = fakes::now_us();
+        ReactESP::app->tick();
+        longest = std::max(longest, fakes::now_us() - start);
+    }
+    return longest;
+}
+
+static void report(const char* name, uint64_t loop_us, uint64_t task_us, uint32_t transactions) {
+    char message[160];
+    snprintf(message, sizeof(message), "%s: main loop blocked %u us max, acquisition task busy %u us max, %.1f I2C transactions/s",
+             name, (unsigned)loop_us, (unsigned)task_us, transactions * 1000.0f / RUN_MS);
+    TEST_MESSAGE(message);
+}
+
+// Each sensor reading its channel from the main loop, as before the scheduler
+void test_blocking_reads() {
+    std::vector<int16_t> counts[CHANNELS];
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        ReactESP::app->onRepeat(500, [channel, &counts]() {
+            counts[channel].push_back(ads1115->readADC_SingleEnded(channel));
+        });
+    }
+    uint32_t transactions = ads1115->transactions();
+    uint64_t loop_us = run_loop(RUN_MS);
+    report("blocking reads", loop_us, 0, ads1115->transactions() - transactions);
+
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 500, counts[channel].size());
+        TEST_ASSERT_EQUAL_INT16(4000 * (channel + 1), counts[channel].back());
+    }
+    // All four 128 SPS conversions back to back in one tick
+    TEST_ASSERT_GREATER_OR_EQUAL(CHANNELS * 1000000 / 128, loop_us);
+}
+
+void test_scheduled_reads() {
+    auto scheduler = new Ads1115Scheduler(new Ads1115Device(ads1115), acquisition);
+    std::vector<int16_t> counts[CHANNELS];
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        scheduler->add_channel(channel, 500, [channel, &counts](float value) { counts[channel].push_back(value); });
+    }
+    acquisition->start();
+    fakes::reset_task_stats();
+    uint32_t transactions = ads1115->transactions();
+    uint64_t loop_us = run_loop(RUN_MS);
+    report("scheduled reads", loop_us, fakes::max_task_busy_us(), ads1115->transactions() - transactions);
+
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 500, counts[channel].size());
+        TEST_ASSERT_EQUAL_INT16(4000 * (channel + 1), counts[channel].back());
+    }
+    // The main loop only drains the results; the task never waits for a
+    // conversion, it only spends the I2C transactions of one tick
+    TEST_ASSERT_EQUAL_UINT64(0, loop_us);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * (Adafruit_ADS1115::READ_REGISTER_US * 2 + Adafruit_ADS1115::WRITE_REGISTER_US),
+                              fakes::max_task_busy_us());
+}
+
+// A chip converting 30% slower than its nominal rate overruns the
+// conversion delay; its results are collected late instead of being read
+// before they are ready
+void test_slow_chip_clock() {
+    ads1115->set_clock_error(0.3);
+    auto scheduler = new Ads1115Scheduler(new Ads1115Device(ads1115), acquisition);
+    std::vector<int16_t> counts[CHANNELS];
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        scheduler->add_channel(channel, 500, [channel, &counts](float value) { counts[channel].push_back(value); });
+    }
+    acquisition->start();
+    run_loop(RUN_MS);
+
+    for (int channel = 0; channel < CHANNELS; channel++) {
+        TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 500, counts[channel].size());
+        for (auto value : counts[channel]) {
+            TEST_ASSERT_EQUAL_INT16(4000 * (channel + 1), value);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(CHANNELS * counts[0].size(), ads1115->conversions());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_blocking_reads);
+    RUN_TEST(test_scheduled_reads);
+    RUN_TEST(test_slow_chip_clock);
+    return UNITY_END();
+}
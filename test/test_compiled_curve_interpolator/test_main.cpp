@@ -0,0 +1,124 @@
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <chrono>
+
+#include "compiled_curve_interpolator.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+
+using namespace sensesp;
+
+// CompiledCurveInterpolator against the SensESP CurveInterpolator it
+// replaces, from the first to the last sample of the three senders, and the
+// cost of one input with each.
+
+static const float SWEEP_STEP = 0.01f;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+// The sender curves, as SensESP interpolates them
+template <typename Sender>
+class Reference : public CurveInterpolator {
+   public:
+    Reference() : CurveInterpolator(NULL, "") {
+        Sender sender;
+        samples_ = sender.samples();
+    }
+
+    float input_min() { return samples_.begin()->input; }
+    float input_max() { return samples_.rbegin()->input; }
+    float output_min() { return samples_.begin()->output; }
+};
+
+template <typename Sender>
+class Exposed : public Sender {
+   public:
+    const std::set<CurveInterpolator::Sample>& samples() { return this->samples_; }
+};
+
+template <typename Sender>
+static void check_equivalence(const char* name) {
+    Reference<Exposed<Sender>> reference;
+    Sender compiled;
+    float worst = 0;
+    float worst_input = 0;
+    for (float input = reference.input_min(); input <= reference.input_max(); input += SWEEP_STEP) {
+        reference.set_input(input);
+        compiled.set_input(input);
+        float error = fabsf(compiled.get() - reference.get());
+        // Float rounding of the segment slopes and the multiply-add
+        if (error > 1e-5f * fabsf(reference.get()) + 1e-5f) {
+            char message[160];
+            snprintf(message, sizeof(message), "%s at %.2f ohms: %g instead of %g", name, input, compiled.get(),
+                     reference.get());
+            TEST_FAIL_MESSAGE(message);
+        }
+        if (error > worst) {
+            worst = error;
+            worst_input = input;
+        }
+    }
+
+    // Past the end CurveInterpolator gives 9999.9, and below the first
+    // sample it ramps from (0, 0); the compiled curve holds its end values
+    compiled.set_input(reference.input_max() + 50);
+    reference.set_input(reference.input_max());
+    TEST_ASSERT_EQUAL_FLOAT(reference.get(), compiled.get());
+    compiled.set_input(reference.input_min() - 5);
+    TEST_ASSERT_EQUAL_FLOAT(reference.output_min(), compiled.get());
+
+    char message[160];
+    snprintf(message, sizeof(message), "%s: worst error %g at %.2f ohms", name, worst, worst_input);
+    TEST_MESSAGE(message);
+}
+
+void test_oil_pressure_sender() { check_equivalence<OilPressureSender>("oil pressure"); }
+
+void test_coolant_temp_sender() { check_equivalence<CoolantTempSender>("coolant temperature"); }
+
+void test_tank_level_sender() { check_equivalence<TankLevelSender>("tank level"); }
+
+template <typename Interpolator>
+static double ns_per_input(Interpolator* interpolator, float input_max) {
+    const int INPUTS = 200000;
+    volatile float sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < INPUTS; i++) {
+        interpolator->set_input(input_max * (i % 1000) / 1000);
+        sink = interpolator->get();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / INPUTS;
+}
+
+void test_benchmark() {
+    Reference<Exposed<CoolantTempSender>> reference;
+    CoolantTempSender compiled;
+    double reference_ns = ns_per_input(&reference, reference.input_max());
+    double compiled_ns = ns_per_input(&compiled, reference.input_max());
+
+    char message[160];
+    snprintf(message, sizeof(message), "coolant temperature curve (18 samples): CurveInterpolator %.1f ns/input, compiled %.1f ns/input",
+             reference_ns, compiled_ns);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(reference_ns, compiled_ns);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_oil_pressure_sender);
+    RUN_TEST(test_coolant_temp_sender);
+    RUN_TEST(test_tank_level_sender);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
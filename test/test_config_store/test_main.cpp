@@ -0,0 +1,160 @@
+#include <ReactESP.h>
+#include <SPIFFS.h>
+#include <unity.h>
+
+#include "config_store.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "sensesp/system/hash.h"
+#include "sensesp/transforms/linear.h"
+
+using namespace sensesp;
+
+// The configuration blob on the simulated flash: the one-time migration of
+// the SensESP per-file configurations into the blob, and the fallback to
+// the previous blob when a write is cut by a power loss at any byte.
+
+static const int PATHS = 40;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    // A fresh boot on the formatted flash
+    ConfigStore::instance()->reload();
+}
+
+void tearDown() {}
+
+static String config_path(int i) { return "/data/transform_" + String(i) + "/multiplier"; }
+
+// Output of the transform for an input of 1, i.e. multiplier + offset
+static float output(Linear* linear) {
+    linear->set_input(1);
+    return linear->get();
+}
+
+static void boot() {
+    ConfigStore::instance()->reload();
+    new ReactESP();
+}
+
+// Configurations saved by SensESP, one file each, move into the blob on
+// the first boot; the files are gone once the blob is written
+void test_migration() {
+    for (int i = 0; i < PATHS; i++) {
+        Linear linear(i, 1, config_path(i));
+        linear.save_configuration();
+    }
+    // Both kinds of file name are migrated
+    File file = SPIFFS.open("/data/plain/multiplier", "w");
+    const char* json = "{\"multiplier\":7,\"offset\":0}";
+    file.write((const uint8_t*)json, strlen(json));
+    file.close();
+
+    boot();
+    fakes::reset_flash_stats();
+    for (int i = 0; i < PATHS; i++) {
+        auto linear = new Stored<Linear>(0.0f, 0.0f, config_path(i));
+        TEST_ASSERT_EQUAL_FLOAT(i + 1, output(linear));
+    }
+    auto stored_plain = new Stored<Linear>(1.0f, 0.0f, "/data/plain/multiplier");
+    TEST_ASSERT_EQUAL_FLOAT(7, output(stored_plain));
+    // The migrations are batched into a single blob write
+    TEST_ASSERT_FALSE(SPIFFS.exists("/config.a") || SPIFFS.exists("/config.b"));
+    ReactESP::app->tick();
+    TEST_ASSERT_TRUE(SPIFFS.exists("/config.a") != SPIFFS.exists("/config.b"));
+    for (int i = 0; i < PATHS; i++) {
+        TEST_ASSERT_FALSE(SPIFFS.exists("/" + Base64Sha1(config_path(i))));
+    }
+    TEST_ASSERT_FALSE(SPIFFS.exists("/data/plain/multiplier"));
+    char message[120];
+    snprintf(message, sizeof(message), "migrating %d configurations: %llu bytes read, %llu bytes written", PATHS + 1,
+             (unsigned long long)fakes::flash_stats().bytes_read,
+             (unsigned long long)fakes::flash_stats().bytes_written);
+    TEST_MESSAGE(message);
+
+    // The next boot reads the blob alone, and has nothing left to migrate
+    boot();
+    fakes::reset_flash_stats();
+    for (int i = 0; i < PATHS; i++) {
+        auto linear = new Stored<Linear>(0.0f, 0.0f, config_path(i));
+        TEST_ASSERT_EQUAL_FLOAT(i + 1, output(linear));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(7, output(new Stored<Linear>(1.0f, 0.0f, "/data/plain/multiplier")));
+    ReactESP::app->tick();
+    TEST_ASSERT_EQUAL_UINT64(0, fakes::flash_stats().bytes_written);
+    TEST_ASSERT_EQUAL_UINT64(0, fakes::flash_stats().bytes_read);
+}
+
+// A path with neither a file nor an entry keeps its constructor defaults
+void test_missing_path() {
+    auto linear = new Stored<Linear>(3.0f, 1.0f, "/data/new/multiplier");
+    TEST_ASSERT_EQUAL_FLOAT(4, output(linear));
+    ReactESP::app->tick();
+    boot();
+    TEST_ASSERT_EQUAL_FLOAT(4, output(new Stored<Linear>(0.0f, 0.0f, "/data/new/multiplier")));
+}
+
+// The power is cut at every byte of a blob write: the next boot finds
+// either the new or the previous configuration, never the defaults
+void test_torn_write() {
+    for (int i = 0; i < PATHS; i++) {
+        new Stored<Linear>(1.0f, 0.0f, config_path(i));
+    }
+    ReactESP::app->tick();
+
+    // The size of one blob write
+    boot();
+    auto linear = new Stored<Linear>(0.0f, 0.0f, config_path(0));
+    DynamicJsonDocument doc(256);
+    JsonObject config = doc.to<JsonObject>();
+    config["multiplier"] = 2;
+    config["offset"] = 0;
+    fakes::reset_flash_stats();
+    linear->set_configuration(config);
+    linear->save_configuration();
+    size_t blob_bytes = fakes::flash_stats().bytes_written;
+    TEST_ASSERT_GREATER_THAN(0, blob_bytes);
+
+    int previous = 0;
+    int updated = 0;
+    for (size_t cut = 0; cut <= blob_bytes; cut++) {
+        boot();
+        linear = new Stored<Linear>(0.0f, 0.0f, config_path(0));
+        float before = output(linear);
+        config["multiplier"] = before + 1;
+        fakes::cut_power_after(cut);
+        linear->set_configuration(config);
+        linear->save_configuration();
+        fakes::power_on();
+
+        boot();
+        float after = output(new Stored<Linear>(0.0f, 0.0f, config_path(0)));
+        if (after == before) {
+            previous++;
+        } else {
+            TEST_ASSERT_EQUAL_FLOAT(before + 1, after);
+            updated++;
+        }
+        // The other configurations survive as well
+        TEST_ASSERT_EQUAL_FLOAT(1, output(new Stored<Linear>(0.0f, 0.0f, config_path(PATHS - 1))));
+    }
+
+    char message[120];
+    snprintf(message, sizeof(message), "%u-byte blob write cut at every byte: %d previous, %d new configurations",
+             (unsigned)blob_bytes, previous, updated);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0, previous);
+    TEST_ASSERT_GREATER_THAN(0, updated);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_migration);
+    RUN_TEST(test_missing_path);
+    RUN_TEST(test_torn_write);
+    return UNITY_END();
+}
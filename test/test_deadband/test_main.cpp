@@ -0,0 +1,163 @@
+#include <N2kMessages.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <functional>
+#include <vector>
+
+#include "configuration.h"
+#include "deadband.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "nmea.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/system/observablevalue.h"
+
+using namespace sensesp;
+
+// The deadbands of main.cpp in front of Nmea and the Signal K outputs,
+// with the engine off: every sensor reads a steady value with its usual
+// noise, at the engine off sampling period of SamplingPolicy. CAN frames
+// and Signal K deltas per minute with and without the deadbands.
+
+static const uint32_t WARM_UP_MS = 60000;
+static const uint32_t RUN_MS = 10 * 60000;
+// SamplingPolicy's engine off period of every group
+static const uint32_t ENGINE_OFF_PERIOD = 60000;
+// RpmSensor's period, which does not follow the engine state
+static const uint32_t RPM_PERIOD = 500;
+
+// Deterministic noise in [-1, 1]
+static float noise(uint64_t seed) {
+    seed = (seed ^ (seed >> 31)) * 0x7fb5d329728ea185ull;
+    seed = (seed ^ (seed >> 27)) * 0x81dadef4bc2dd44dull;
+    return (seed >> 40) / (float)(1 << 23) - 1;
+}
+
+struct Output {
+    std::vector<SKOutputFloat*> sk_outputs;
+
+    uint32_t deltas() {
+        uint32_t count = 0;
+        for (auto output : sk_outputs) {
+            count += output->count();
+        }
+        return count;
+    }
+};
+
+static Output* output;
+static Nmea* nmea;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    output = new Output();
+    nmea = new Nmea();
+}
+
+void tearDown() {}
+
+/**
+ * @brief One sensor of main.cpp, from its reading to Nmea and Signal K
+ *
+ * `read` gives the value at a time in ms; with `deadbanded`, it goes
+ * through a Deadband with the main.cpp parameters.
+ */
+static void sensor(bool deadbanded, uint32_t period, std::function<float(uint32_t)> read, float threshold, bool relative,
+                   uint max_silence, void (Nmea::*connect)(ValueProducer<float>*)) {
+    auto source = new ObservableValue<float>();
+    ValueProducer<float>* producer = source;
+    if (deadbanded) {
+        producer = source->connect_to(new Deadband(threshold, relative, max_silence));
+    }
+    if (connect != nullptr) {
+        (nmea->*connect)(producer);
+    }
+    auto sk_output = new SKOutputFloat("sk.path");
+    producer->connect_to(sk_output);
+    output->sk_outputs.push_back(sk_output);
+    ReactESP::app->onRepeat(period, [source, read]() { source->set(read(millis())); });
+}
+
+static void engine_off(bool deadbanded) {
+    // RPMs: no pulses, so 0 on every update
+    sensor(deadbanded, RPM_PERIOD, [](uint32_t ms) { return 0.0f; }, 0.01, true, 10000, &Nmea::connect_engine_rpms);
+    // Run time, not counting while the engine is off
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 36000.0f; }, 60, false, 300000,
+           &Nmea::connect_engine_run_time);
+    // Coolant temperature and oil pressure through the sender curves, with
+    // the ADC noise
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 291.15f + 0.1f * noise(ms); }, 0.5, false, 30000,
+           &Nmea::connect_coolant_temperature);
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 500 * noise(ms + 1); }, 2000, false, 30000,
+           &Nmea::connect_oil_pressure);
+    // 1-Wire temperatures in 1/16 K or 1/4 K steps
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 290.15f + 0.0625f * roundf(noise(ms + 2)); }, 0.2,
+           false, 60000, nullptr);
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 290.15f + 0.0625f * roundf(noise(ms + 3)); }, 0.2,
+           false, 60000, nullptr);
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 290.15f + 0.25f * roundf(noise(ms + 4)); }, 0.5,
+           false, 30000, &Nmea::connect_exhaust_temperature);
+    // Tank levels
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 0.5f + 0.002f * noise(ms + 5); }, 0.005, false,
+           60000, &Nmea::connect_water_level);
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 0.7f + 0.002f * noise(ms + 6); }, 0.005, false,
+           60000, &Nmea::connect_fuel_level);
+    // Alternator current
+    sensor(deadbanded, ENGINE_OFF_PERIOD, [](uint32_t ms) { return 0.1f * fabsf(noise(ms + 7)); }, 0.5, false, 30000,
+           nullptr);
+}
+
+struct PerMinute {
+    float frames;
+    float deltas;
+    float rpm_pgns;
+};
+
+static PerMinute measure(const char* name) {
+    fakes::run_ms(WARM_UP_MS);
+    fakes::can_bus().clear();
+    uint32_t deltas = output->deltas();
+    fakes::run_ms(RUN_MS);
+
+    float minutes = RUN_MS / 60000.0f;
+    PerMinute rate = {fakes::can_bus().frames_sent() / minutes, (output->deltas() - deltas) / minutes,
+                      fakes::can_bus().sent_count(127488) / minutes};
+    char message[160];
+    snprintf(message, sizeof(message), "%s: %.0f CAN frames/minute (PGN 127488 %.0f), %.1f Signal K deltas/minute",
+             name, rate.frames, rate.rpm_pgns, rate.deltas);
+    TEST_MESSAGE(message);
+    return rate;
+}
+
+static PerMinute without_deadbands;
+
+void test_without_deadbands() {
+    engine_off(false);
+    without_deadbands = measure("engine off, no deadbands");
+}
+
+void test_with_deadbands() {
+    engine_off(true);
+    PerMinute rate = measure("engine off, deadbands");
+
+    // The RPMs of 0 only mark PGN 127488 dirty every 10 s; the heartbeat
+    // sends it every second in between, instead of on every update
+    TEST_ASSERT_FLOAT_WITHIN(1, 60000 / 1000, rate.rpm_pgns);
+    TEST_ASSERT_FLOAT_WITHIN(1, 60000 / RPM_PERIOD, without_deadbands.rpm_pgns);
+    TEST_ASSERT_LESS_THAN(without_deadbands.frames, rate.frames);
+    // The RPMs go from an update every 500 ms to one every 10 s; the
+    // sensors sampled every minute pass their deadbands on max silence
+    TEST_ASSERT_LESS_THAN(without_deadbands.deltas / 4, rate.deltas);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_without_deadbands);
+    RUN_TEST(test_with_deadbands);
+    return UNITY_END();
+}
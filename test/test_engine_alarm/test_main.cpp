@@ -0,0 +1,217 @@
+#include <Adafruit_ADS1X15.h>
+#include <N2kMessages.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <algorithm>
+
+#include "acquisition_task.h"
+#include "ads1115_scheduler.h"
+#include "configuration.h"
+#include "engine_alarm.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "nmea.h"
+#include "resistance_sensor.h"
+#include "sensesp/system/observablevalue.h"
+
+using namespace sensesp;
+
+// The engine alarms of main.cpp from the fake ADS1115 to the fake CAN bus:
+// the worst time from a sender crossing its threshold to the PGN 127489
+// with the status bit, and from the sample behind the transition to the
+// frame. Then debounce, hysteresis and the running condition of the low
+// oil pressure alarm.
+
+// Engine running sampling period of the resistance senders
+static const uint32_t SAMPLE_PERIOD = 100;
+static const uint32_t COOLANT_DEBOUNCE = 2000;
+static const uint32_t OIL_DEBOUNCE = 3000;
+static const int TRIALS = 20;
+
+static float coolant_ohms;
+static float oil_ohms;
+
+static Adafruit_ADS1115* ads1115;
+static AcquisitionTask* acquisition;
+static Ads1115Scheduler* scheduler;
+static Nmea* nmea;
+
+static float ohms_to_chip_volts(float ohms) { return ohms * ADS1115MEASUREMENTCURRENT / ADS1115INPUTSCALE; }
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+
+    coolant_ohms = 70.12f;  // 80 C
+    oil_ohms = 124;         // 6 bar
+    ads1115 = new Adafruit_ADS1115();
+    ads1115->setGain(ADS1115GAIN);
+    ads1115->set_input(ENGINE_COOLANT_TEMP_SENSOR_CHANNEL, [](uint64_t us) { return ohms_to_chip_volts(coolant_ohms); });
+    ads1115->set_input(ENGINE_OIL_PRESSURE_SENSOR_CHANNEL, [](uint64_t us) { return ohms_to_chip_volts(oil_ohms); });
+    acquisition = new AcquisitionTask(ACQUISITION_CORE);
+    scheduler = new Ads1115Scheduler(new Ads1115Device(ads1115), acquisition);
+    nmea = new Nmea();
+}
+
+void tearDown() {}
+
+// The coolant over temperature alarm as wired in main.cpp
+static EngineAlarm* coolant_alarm() {
+    auto sensor = new ResistanceSensor(scheduler, ENGINE_COOLANT_TEMP_SENSOR_CHANNEL, SAMPLE_PERIOD);
+    auto temperature = sensor->connect_to(new CoolantTempSender());
+    auto alarm = new EngineAlarm(acquisition, false, 368.15, 3, COOLANT_DEBOUNCE);
+    temperature->connect_to(alarm);
+    nmea->connect_over_temperature_alarm(alarm);
+    sensor->start();
+    return alarm;
+}
+
+// The low oil pressure alarm as wired in main.cpp
+static EngineAlarm* oil_alarm(ValueProducer<float>* rpms) {
+    auto sensor = new ResistanceSensor(scheduler, ENGINE_OIL_PRESSURE_SENSOR_CHANNEL, SAMPLE_PERIOD);
+    auto pressure = sensor->connect_to(new OilPressureSender());
+    auto alarm = new EngineAlarm(acquisition, true, 50000, 20000, OIL_DEBOUNCE);
+    alarm->require_running(rpms);
+    pressure->connect_to(alarm);
+    nmea->connect_low_oil_pressure_alarm(alarm);
+    sensor->start();
+    return alarm;
+}
+
+// Engine status of the first PGN 127489 sent at or after `from_us`
+// matching `match`; returns its index in the sent messages, or -1
+static int find_status(uint64_t from_us, std::function<bool(tN2kEngineDiscreteStatus1)> match) {
+    auto& sent = fakes::can_bus().sent();
+    for (size_t i = 0; i < sent.size(); i++) {
+        unsigned char instance;
+        double oil_pressure, oil_temperature, coolant_temperature, alternator_voltage, fuel_rate, hours,
+            coolant_pressure, fuel_pressure;
+        int8_t load, torque;
+        tN2kEngineDiscreteStatus1 status1;
+        tN2kEngineDiscreteStatus2 status2;
+        if (sent[i].time_us >= from_us &&
+            ParseN2kPGN127489(sent[i].msg, instance, oil_pressure, oil_temperature, coolant_temperature,
+                              alternator_voltage, fuel_rate, hours, coolant_pressure, fuel_pressure, load, torque,
+                              status1, status2) &&
+            match(status1)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool over_temperature(tN2kEngineDiscreteStatus1 status) { return status.Bits.OverTemperature; }
+static bool low_oil_pressure(tN2kEngineDiscreteStatus1 status) { return status.Bits.LowOilPressure; }
+
+// The coolant steps from 80 C to 100 C at a different point of the
+// sampling period in each trial
+void test_alarm_latency() {
+    auto alarm = coolant_alarm();
+    acquisition->start();
+    fakes::run_ms(3000);
+
+    uint64_t worst_step_us = 0;
+    uint32_t worst_sample_us = 0;
+    for (int trial = 0; trial < TRIALS; trial++) {
+        fakes::run_ms(trial * SAMPLE_PERIOD / TRIALS);
+        fakes::can_bus().clear();
+        uint64_t step_us = fakes::now_us();
+        coolant_ohms = 38.47f;
+        fakes::run_ms(COOLANT_DEBOUNCE + 1000);
+
+        int index = find_status(step_us, over_temperature);
+        TEST_ASSERT_TRUE(index >= 0);
+        TEST_ASSERT_TRUE(alarm->active());
+        auto& sent = fakes::can_bus().sent();
+        worst_step_us = std::max(worst_step_us, sent[index].time_us - step_us);
+        // Queueing from the acquisition task to the main loop; the
+        // pipeline itself takes no virtual time
+        worst_sample_us = std::max(worst_sample_us, (uint32_t)sent[index].time_us - alarm->sample_timestamp());
+
+        // Back to 80 C: the bit clears in the same way
+        coolant_ohms = 70.12f;
+        uint64_t clear_us = fakes::now_us();
+        fakes::run_ms(COOLANT_DEBOUNCE + 1000);
+        TEST_ASSERT_FALSE(alarm->active());
+        TEST_ASSERT_TRUE(find_status(clear_us, [](tN2kEngineDiscreteStatus1 status) { return !status.Bits.OverTemperature; }) >= 0);
+    }
+
+    char message[200];
+    snprintf(message, sizeof(message),
+             "over temperature, %u ms debounce: worst %.1f ms from the step to the bus, %.2f ms from the sample",
+             (unsigned)COOLANT_DEBOUNCE, worst_step_us / 1000.0, worst_sample_us / 1000.0);
+    TEST_MESSAGE(message);
+    // The first sample past the threshold comes up to a period after the
+    // step, and the debounce ends on a later sample
+    TEST_ASSERT_LESS_OR_EQUAL((COOLANT_DEBOUNCE + 3 * SAMPLE_PERIOD) * 1000ull, worst_step_us);
+    TEST_ASSERT_LESS_THAN(SAMPLE_PERIOD * 1000, worst_sample_us);
+}
+
+// A spike shorter than the debounce does not raise the alarm
+void test_debounce() {
+    auto alarm = coolant_alarm();
+    acquisition->start();
+    fakes::run_ms(3000);
+    fakes::can_bus().clear();
+    coolant_ohms = 38.47f;
+    fakes::run_ms(COOLANT_DEBOUNCE / 2);
+    coolant_ohms = 70.12f;
+    fakes::run_ms(COOLANT_DEBOUNCE * 2);
+    TEST_ASSERT_FALSE(alarm->active());
+    TEST_ASSERT_EQUAL(-1, find_status(0, over_temperature));
+}
+
+// Once raised above 95 C, the alarm holds down to 92 C
+void test_hysteresis() {
+    auto alarm = coolant_alarm();
+    acquisition->start();
+    coolant_ohms = 38.47f;  // 100 C
+    fakes::run_ms(COOLANT_DEBOUNCE + 1000);
+    TEST_ASSERT_TRUE(alarm->active());
+
+    coolant_ohms = 47.08f;  // 93 C
+    fakes::run_ms(COOLANT_DEBOUNCE * 2);
+    TEST_ASSERT_TRUE(alarm->active());
+
+    coolant_ohms = 51.21f;  // 90 C
+    fakes::run_ms(COOLANT_DEBOUNCE + 1000);
+    TEST_ASSERT_FALSE(alarm->active());
+}
+
+// No oil pressure is only an alarm while the engine runs
+void test_low_oil_pressure_requires_running() {
+    ObservableValue<float> rpms;
+    auto alarm = oil_alarm(&rpms);
+    acquisition->start();
+    oil_ohms = 10;  // 0 bar
+    rpms.set(0);
+    fakes::run_ms(OIL_DEBOUNCE * 2);
+    TEST_ASSERT_FALSE(alarm->active());
+
+    uint64_t start_us = fakes::now_us();
+    rpms.set(30);
+    fakes::run_ms(OIL_DEBOUNCE + 1000);
+    TEST_ASSERT_TRUE(alarm->active());
+    TEST_ASSERT_TRUE(find_status(start_us, low_oil_pressure) >= 0);
+
+    // Stopping the engine clears it right away
+    uint64_t stop_us = fakes::now_us();
+    rpms.set(0);
+    TEST_ASSERT_FALSE(alarm->active());
+    int index = find_status(stop_us, [](tN2kEngineDiscreteStatus1 status) { return !status.Bits.LowOilPressure; });
+    TEST_ASSERT_TRUE(index >= 0);
+    TEST_ASSERT_EQUAL_UINT64(stop_us, fakes::can_bus().sent()[index].time_us);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_alarm_latency);
+    RUN_TEST(test_debounce);
+    RUN_TEST(test_hysteresis);
+    RUN_TEST(test_low_oil_pressure_requires_running);
+    return UNITY_END();
+}
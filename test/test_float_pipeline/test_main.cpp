@@ -0,0 +1,342 @@
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <chrono>
+#include <type_traits>
+
+#include "adc_channel.h"
+#include "configuration.h"
+#include "deadband.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "rpm_sensor.h"
+#include "sensesp/transforms/linear.h"
+#include "sensesp/transforms/moving_average.h"
+
+using namespace sensesp;
+
+// The per-sample arithmetic of each pipeline of main.cpp, from the raw
+// reading to the value Nmea keeps for its next PGN, as it was with double
+// literals and double Nmea fields and as it is now in single precision.
+// For each pipeline: the double operations per sample before (each one is a
+// soft-float library call on the ESP32, whose FPU is single precision
+// only), the host time per sample before and after, and that both give
+// the same values. The host FPU does double in hardware, so the host times
+// mostly show that nothing else got slower.
+
+static const int SAMPLES = 200000;
+
+// The unit conversions are float now
+static_assert(std::is_same<decltype(ctok(35)), float>::value, "ctok() is double");
+static_assert(std::is_same<decltype(bartopa(2)), float>::value, "bartopa() is double");
+static_assert(std::is_same<decltype(ADS1115INPUTSCALE), float>::value, "ADS1115INPUTSCALE is double");
+static_assert(std::is_same<decltype(ADS1115MEASUREMENTCURRENT), float>::value, "ADS1115MEASUREMENTCURRENT is double");
+static_assert(std::is_same<decltype(RPM_MULTIPLIER), float>::value, "RPM_MULTIPLIER is double");
+static_assert(std::is_same<decltype(PZCT02_MULTIPLIER * (1 / PZCT02_BURDEN_RESISTANCE)), float>::value,
+              "the alternator current factor is double");
+static_assert(std::is_same<decltype(FUEL_TANK_CAPACITY), float>::value, "FUEL_TANK_CAPACITY is double");
+
+/**
+ * @brief A double counting the operations done on it
+ *
+ * Conversions from float and integers, arithmetic and the conversion back
+ * to float each count as one operation. Literals are not counted: the
+ * compiler folds them.
+ */
+struct CountedDouble {
+    static uint32_t operations;
+
+    double value;
+
+    CountedDouble(double literal) : value{literal} {}
+    CountedDouble(float v) : value{v} { operations++; }
+    template <typename Int, typename = typename std::enable_if<std::is_integral<Int>::value>::type>
+    CountedDouble(Int v) : value((double)v) {
+        operations++;
+    }
+    explicit operator float() const {
+        operations++;
+        return value;
+    }
+};
+
+uint32_t CountedDouble::operations = 0;
+
+static CountedDouble count(double result) {
+    CountedDouble::operations++;
+    return CountedDouble(result);
+}
+
+static CountedDouble operator+(CountedDouble a, CountedDouble b) { return count(a.value + b.value); }
+static CountedDouble operator-(CountedDouble a, CountedDouble b) { return count(a.value - b.value); }
+static CountedDouble operator*(CountedDouble a, CountedDouble b) { return count(a.value * b.value); }
+static CountedDouble operator/(CountedDouble a, CountedDouble b) { return count(a.value / b.value); }
+
+// The Nmea field as handed to the N2k API, which takes double: not counted
+static float sent(double field) { return field; }
+static float sent(CountedDouble field) { return field.value; }
+
+/**
+ * @brief One pipeline of main.cpp, before and after
+ *
+ * `before<D>()` has the old arithmetic with every double written as D,
+ * `after()` the current one; both process sample `i` and return the value
+ * stored in Nmea.
+ */
+struct Pipeline {
+    Deadband deadband;
+
+    Pipeline(float threshold, bool relative = false) : deadband{threshold, relative} {}
+
+    // Deadband output, i.e. the value downstream sees
+    float deadbanded(float value) {
+        deadband.set_input(value);
+        return deadband.get();
+    }
+};
+
+// Sender resistance from the ADS1115: the conversion and the curves were
+// float already, the Nmea field was double
+template <typename Sender>
+struct ResistancePipeline : Pipeline {
+    Sender sender;
+    int16_t base;
+
+    ResistancePipeline(float threshold, int16_t base) : Pipeline(threshold), base{base} {}
+
+    float resistance(int i) {
+        sender.set_input(ResistanceChannel::convert(base + i % 400));
+        return deadbanded(sender.get());
+    }
+    template <typename D>
+    float before(int i) {
+        D field = resistance(i);
+        return sent(field);
+    }
+    float after(int i) { return resistance(i); }
+};
+
+// About 53 to 124 ohms
+struct CoolantPipeline : ResistancePipeline<CoolantTempSender> {
+    CoolantPipeline() : ResistancePipeline(0.5f, 300) {}
+};
+
+// About 71 to 141 ohms
+struct OilPressurePipeline : ResistancePipeline<OilPressureSender> {
+    OilPressurePipeline() : ResistancePipeline(2000, 400) {}
+};
+
+// Water tank: the same with a moving average before the curve
+struct WaterTankPipeline : Pipeline {
+    MovingAverage average{10, 1.0f};
+    TankLevelSender sender;
+
+    WaterTankPipeline() : Pipeline(0.005f) {}
+
+    float level(int i) {
+        average.set_input(ResistanceChannel::convert(500 + i % 600));
+        sender.set_input(average.get());
+        return deadbanded(sender.get());
+    }
+    template <typename D>
+    float before(int i) {
+        D field = level(i);
+        return sent(field);
+    }
+    float after(int i) { return level(i); }
+};
+
+// 1-Wire: raw / 16.0 + 273.15 in the acquisition task
+struct OneWirePipeline : Pipeline {
+    OneWirePipeline() : Pipeline(0.5f) {}
+
+    int16_t raw(int i) { return 960 + i % 160; }
+    template <typename D>
+    float before(int i) {
+        D field = deadbanded((float)(D(raw(i)) / D(16.0) + D(273.15)));
+        return sent(field);
+    }
+    float after(int i) { return deadbanded(raw(i) / 16.0f + 273.15f); }
+};
+
+// RPMs: 1000. * count / elapsed, then the multiplier
+struct RpmPipeline : Pipeline {
+    RpmMultiplier multiplier{RPM_MULTIPLIER};
+
+    RpmPipeline() : Pipeline(0.01f, true) {}
+
+    float scaled(float rps) {
+        multiplier.set_input(rps);
+        return deadbanded(multiplier.get());
+    }
+    template <typename D>
+    float before(int i) {
+        uint32_t count = 15 + i % 3;
+        uint32_t elapsed = 500 + i % 7;
+        D field = scaled((float)(D(1000.) * D(count) / D(elapsed)));
+        return sent(field);
+    }
+    float after(int i) {
+        uint32_t count = 15 + i % 3;
+        uint32_t elapsed = 500 + i % 7;
+        return scaled(1000.0f * count / elapsed);
+    }
+};
+
+// Run time: accumulated seconds, and the engine hours in Nmea
+struct RunTimePipeline : Pipeline {
+    float run_time = 3600;
+
+    RunTimePipeline() : Pipeline(60) {}
+
+    template <typename D>
+    float before(int i) {
+        uint32_t elapsed_ms = 10000 + i % 5;
+        run_time = (float)(D(run_time) + D(elapsed_ms) / D(1000.));
+        float value = deadbanded(round(run_time));
+        // round() of a float is the float overload
+        D field = round(value / 60 / 60);
+        return sent(field);
+    }
+    float after(int i) {
+        uint32_t elapsed_ms = 10000 + i % 5;
+        run_time += elapsed_ms / 1000.0f;
+        float value = deadbanded(roundf(run_time));
+        return roundf(value / 3600.0f);
+    }
+};
+
+// DS1603L fuel level: the calibration, recomputed with each reading
+struct FuelTankPipeline : Pipeline {
+    MovingAverage average{10, 1.0f};
+    int full_mm = FUEL_TANK_FULL_MM;
+    int empty_mm = FUEL_TANK_EMPTY_MM;
+
+    FuelTankPipeline() : Pipeline(0.005f) {}
+
+    float averaged(float level) {
+        average.set_input(level);
+        return deadbanded(average.get());
+    }
+    template <typename D>
+    float before(int i) {
+        int16_t reading = 100 + i % 50;
+        const float range = full_mm - empty_mm;
+        const float divisor = (float)(D(range) / D(100.0));
+        const float multiplier = (float)(D(1.0) / D(divisor));
+        const float offset = (float)(D(100.0) - D(full_mm * multiplier));
+        D field = averaged(multiplier * reading + offset);
+        return sent(field);
+    }
+    float after(int i) {
+        int16_t reading = 100 + i % 50;
+        const float range = full_mm - empty_mm;
+        const float divisor = range / 100.0f;
+        const float multiplier = 1.0f / divisor;
+        const float offset = 100.0f - full_mm * multiplier;
+        return averaged(multiplier * reading + offset);
+    }
+};
+
+// Alternator current: the RMS voltage times a factor folded at compile
+// time; not sent on NMEA 2000
+struct AlternatorPipeline : Pipeline {
+    Linear current{PZCT02_MULTIPLIER * (1 / PZCT02_BURDEN_RESISTANCE), 0};
+
+    AlternatorPipeline() : Pipeline(0.5f) {}
+
+    float amps(int i) {
+        current.set_input(0.2f + (i % 100) * 0.001f);
+        return deadbanded(current.get());
+    }
+    template <typename D>
+    float before(int i) {
+        return amps(i);
+    }
+    float after(int i) { return amps(i); }
+};
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+template <typename P, typename Process>
+static double ns_per_sample(P* pipeline, Process process) {
+    volatile float sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; i++) {
+        sink = (pipeline->*process)(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / SAMPLES;
+}
+
+template <typename P>
+static void measure(const char* name) {
+    // Same values, sample by sample
+    P before_values;
+    P after_values;
+    for (int i = 0; i < SAMPLES; i++) {
+        float before = before_values.template before<double>(i);
+        float after = after_values.after(i);
+        if (fabsf(after - before) > 1e-6f * fabsf(before)) {
+            char message[160];
+            snprintf(message, sizeof(message), "%s sample %d: %g instead of %g", name, i, after, before);
+            TEST_FAIL_MESSAGE(message);
+        }
+    }
+
+    P counted;
+    CountedDouble::operations = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        counted.template before<CountedDouble>(i);
+    }
+    float operations = (float)CountedDouble::operations / SAMPLES;
+
+    P before_pipeline;
+    P after_pipeline;
+    double before_ns = ns_per_sample(&before_pipeline, &P::template before<double>);
+    double after_ns = ns_per_sample(&after_pipeline, &P::after);
+
+    char message[200];
+    snprintf(message, sizeof(message), "%s: %.1f double operations/sample before, 0 after; host %.1f ns/sample before, %.1f after",
+             name, operations, before_ns, after_ns);
+    TEST_MESSAGE(message);
+}
+
+void test_engine_coolant_temperature() {
+    measure<CoolantPipeline>("engine coolant temperature");
+}
+
+void test_engine_oil_pressure() { measure<OilPressurePipeline>("engine oil pressure"); }
+
+void test_fresh_water_tank() { measure<WaterTankPipeline>("fresh water tank"); }
+
+void test_onewire_temperatures() { measure<OneWirePipeline>("1-Wire temperatures"); }
+
+void test_engine_rpms() { measure<RpmPipeline>("engine RPMs"); }
+
+void test_engine_run_time() { measure<RunTimePipeline>("engine run time"); }
+
+void test_fuel_tank() { measure<FuelTankPipeline>("fuel tank"); }
+
+void test_alternator_output() { measure<AlternatorPipeline>("alternator output"); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_engine_coolant_temperature);
+    RUN_TEST(test_engine_oil_pressure);
+    RUN_TEST(test_fresh_water_tank);
+    RUN_TEST(test_onewire_temperatures);
+    RUN_TEST(test_engine_rpms);
+    RUN_TEST(test_engine_run_time);
+    RUN_TEST(test_fuel_tank);
+    RUN_TEST(test_alternator_output);
+    return UNITY_END();
+}
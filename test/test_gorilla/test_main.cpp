@@ -0,0 +1,231 @@
+#include <Adafruit_ADS1X15.h>
+#include <ArduinoJson.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <chrono>
+#include <vector>
+
+#include "acquisition_task.h"
+#include "ads1115_scheduler.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "flash_ring.h"
+#include "gorilla_codec.h"
+#include "resistance_sensor.h"
+#include "rms_voltage_sensor.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensor_log.h"
+
+using namespace sensesp;
+
+// Gorilla compression of the sensor log. The nine raw streams of main.cpp
+// are recorded through SensorLog from the fake sensors for RECORD_MS of
+// simulated time; the recorded blocks are then decoded and re-encoded to
+// measure the compression ratio and the encoding cost on that data.
+
+// About 31 samples/s, 0.6 blocks/s: short enough for the ring not to wrap
+static const uint32_t RECORD_MS = 3 * 60000;
+// A raw (timestamp, source, float) record
+static const size_t RAW_RECORD_SIZE = 9;
+
+struct Sample {
+    uint8_t source;
+    uint32_t timestamp;
+    float value;
+};
+
+static std::vector<Sample> recorded;
+static size_t recorded_blocks;
+
+// Deterministic noise in [-1, 1]
+static float noise(uint64_t seed) {
+    seed = (seed ^ (seed >> 31)) * 0x7fb5d329728ea185ull;
+    seed = (seed ^ (seed >> 27)) * 0x81dadef4bc2dd44dull;
+    return (seed >> 40) / (float)(1 << 23) - 1;
+}
+
+static float ohms_to_chip_volts(float ohms) { return ohms * ADS1115MEASUREMENTCURRENT / ADS1115INPUTSCALE; }
+
+static float quantize(float value, float step) { return roundf(value / step) * step; }
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+// Records the sensor streams with the engine running, as main.cpp taps them
+void test_record() {
+    fakes::flash_format();
+    auto log = new SensorLog("/system/sensor_log");
+    DynamicJsonDocument config(256);
+    JsonObject object = config.to<JsonObject>();
+    object["mode"] = "record";
+    object["speed"] = 1;
+    TEST_ASSERT_TRUE(log->set_configuration(object));
+
+    auto ads1115 = new Adafruit_ADS1115();
+    ads1115->setGain(ADS1115GAIN);
+    auto acquisition = new AcquisitionTask(ACQUISITION_CORE);
+    auto scheduler = new Ads1115Scheduler(new Ads1115Device(ads1115), acquisition);
+    ads1115->set_input(ENGINE_COOLANT_TEMP_SENSOR_CHANNEL, [](uint64_t us) {
+        return ohms_to_chip_volts(60 + 5 * sinf(us / 60e6f) + 0.3f * noise(us));
+    });
+    ads1115->set_input(ENGINE_OIL_PRESSURE_SENSOR_CHANNEL, [](uint64_t us) {
+        return ohms_to_chip_volts(110 + 10 * sinf(us / 20e6f) + 0.5f * noise(us));
+    });
+    ads1115->set_input(FRESH_WATER_TANK_SENSOR_CHANNEL, [](uint64_t us) {
+        // Sloshing
+        return ohms_to_chip_volts(90 + 8 * sinf(us / 3e6f) + noise(us));
+    });
+    ads1115->set_input(ALTERNATOR_OUTPUT_SENSOR_CHANNEL, [](uint64_t us) {
+        return (1 + 0.3f * sinf(2 * M_PI * 50 * us / 1e6f) + 0.005f * noise(us)) / ADS1115INPUTSCALE;
+    });
+
+    // Same order as the taps of main.cpp, at the engine running periods
+    // of SamplingPolicy
+    auto fuel_tank_mm = log->tap("fuel_tank_mm");
+    ObservableValue<float>* temperatures[3];
+    for (int i = 0; i < 3; i++) {
+        temperatures[i] = new ObservableValue<float>();
+    }
+    temperatures[0]->connect_to(log->tap("engine_room_temperature"));
+    temperatures[1]->connect_to(log->tap("engine_alternator_temperature"));
+    temperatures[2]->connect_to(log->tap("engine_exhaust_temperature"));
+    auto water = new ResistanceSensor(scheduler, FRESH_WATER_TANK_SENSOR_CHANNEL, 2000);
+    water->connect_to(log->tap("fresh_water_tank_resistance"));
+    auto rpms = new ObservableValue<float>();
+    rpms->connect_to(log->tap("engine_rpms"));
+    auto coolant = new ResistanceSensor(scheduler, ENGINE_COOLANT_TEMP_SENSOR_CHANNEL, 100);
+    coolant->connect_to(log->tap("engine_coolant_resistance"));
+    auto oil = new ResistanceSensor(scheduler, ENGINE_OIL_PRESSURE_SENSOR_CHANNEL, 100);
+    oil->connect_to(log->tap("engine_oil_pressure_resistance"));
+    auto alternator = new RmsVoltageSensor(scheduler, ALTERNATOR_OUTPUT_SENSOR_CHANNEL, 1000, 200);
+    alternator->connect_to(log->tap("alternator_output_voltage"));
+
+    // DS1603L millimetres, DS18B20 at 12 and 10 bit resolution, and the
+    // RPM sensor's revolutions per second from a measured period in us
+    ReactESP::app->onRepeat(1000, [fuel_tank_mm]() {
+        fuel_tank_mm->set_input(roundf(150 + 2 * noise(micros())));
+    });
+    ReactESP::app->onRepeat(1000, [temperatures]() {
+        float t = millis() / 1000.0f;
+        temperatures[0]->set(quantize(ctok(35 + 3 * sinf(t / 600)), 0.0625f));
+        temperatures[1]->set(quantize(ctok(60 + 5 * sinf(t / 300)), 0.0625f));
+        temperatures[2]->set(quantize(ctok(45 + 2 * sinf(t / 200) + 0.3f * noise(micros())), 0.25f));
+    });
+    ReactESP::app->onRepeat(500, [rpms]() {
+        uint32_t period_us = 33333 + 300 * sinf(millis() / 7000.0f) + 40 * noise(micros());
+        rpms->set(1e6f / period_us);
+    });
+
+    for (auto startable : std::vector<Startable*>{water, coolant, oil, alternator}) {
+        startable->start();
+    }
+    acquisition->start();
+    log->start();
+    fakes::run_ms(RECORD_MS);
+
+    // Read back the log the way replay does
+    FlashRing ring("/sensor_log", sizeof(GorillaBlock), SensorLog::BLOCK_CAPACITY);
+    TEST_ASSERT_TRUE(ring.begin());
+    recorded.clear();
+    recorded_blocks = ring.size();
+    GorillaBlock block;
+    for (size_t i = 0; i < ring.size(); i++) {
+        TEST_ASSERT_TRUE(ring.read(i, &block));
+        GorillaDecoder decoder(&block);
+        Sample sample;
+        while (decoder.next(&sample.source, &sample.timestamp, &sample.value)) {
+            recorded.push_back(sample);
+        }
+        TEST_ASSERT_TRUE(decoder.done());
+    }
+
+    char message[160];
+    snprintf(message, sizeof(message), "recorded %u samples from 9 streams in %u blocks over %u simulated minutes",
+             (unsigned)recorded.size(), (unsigned)recorded_blocks, (unsigned)(RECORD_MS / 60000));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(SensorLog::BLOCK_CAPACITY, recorded_blocks);
+    TEST_ASSERT_GREATER_THAN(1000, recorded.size());
+}
+
+// Re-encodes the recorded samples into fresh blocks, as SensorLog does
+static size_t encode(std::vector<GorillaBlock>* blocks) {
+    GorillaBlock block;
+    GorillaEncoder encoder(&block);
+    size_t count = 0;
+    for (auto& sample : recorded) {
+        if (!encoder.append(sample.source, sample.timestamp, sample.value)) {
+            if (blocks != nullptr) {
+                blocks->push_back(block);
+            }
+            count++;
+            encoder.reset();
+            encoder.append(sample.source, sample.timestamp, sample.value);
+        }
+    }
+    if (blocks != nullptr) {
+        blocks->push_back(block);
+    }
+    return count + 1;
+}
+
+void test_round_trip_and_ratio() {
+    std::vector<GorillaBlock> blocks;
+    encode(&blocks);
+
+    size_t index = 0;
+    uint64_t bits = 0;
+    for (auto& block : blocks) {
+        GorillaDecoder decoder(&block);
+        Sample sample;
+        while (decoder.next(&sample.source, &sample.timestamp, &sample.value)) {
+            TEST_ASSERT_EQUAL_UINT8(recorded[index].source, sample.source);
+            TEST_ASSERT_EQUAL_UINT32(recorded[index].timestamp, sample.timestamp);
+            TEST_ASSERT_EQUAL_MEMORY(&recorded[index].value, &sample.value, sizeof(float));
+            index++;
+        }
+        bits += block.bits;
+    }
+    TEST_ASSERT_EQUAL(recorded.size(), index);
+
+    float flash_ratio = (float)recorded.size() * RAW_RECORD_SIZE / (blocks.size() * sizeof(GorillaBlock));
+    char message[200];
+    snprintf(message, sizeof(message),
+             "compression: %.1f bits/sample, %.2fx smaller than %u-byte raw records in flash (%.2fx in encoded bits)",
+             (double)bits / recorded.size(), flash_ratio, (unsigned)RAW_RECORD_SIZE,
+             recorded.size() * RAW_RECORD_SIZE * 8.0 / bits);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(1.5f, flash_ratio);
+}
+
+void test_encode_benchmark() {
+    const int PASSES = 50;
+    size_t blocks = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++) {
+        blocks += encode(nullptr);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    char message[160];
+    snprintf(message, sizeof(message), "encode: %.1f ns/sample on the host over %u blocks",
+             std::chrono::duration<double, std::nano>(end - begin).count() / PASSES / recorded.size(),
+             (unsigned)(blocks / PASSES));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0, blocks);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_record);
+    RUN_TEST(test_round_trip_and_ratio);
+    RUN_TEST(test_encode_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "diagnostics_server.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "fakes/http.h"
+#include "history_store.h"
+#include "sensesp/system/observablevalue.h"
+
+using namespace sensesp;
+
+// HistoryStore tiers and budgets: a value sampled every 100 ms for two
+// hours, then each tier read back through /history and checked against
+// the finer one, and how many paths fit in the flash budget.
+
+static const float RESOLUTION = 0.01;
+// 2020-10-01
+static const uint32_t WALL_CLOCK = 1601510400;
+static const uint32_t RUN_S = 2 * 3600 + 5 * 60;
+
+struct Point {
+    uint32_t time;
+    float min;
+    float max;
+    float mean;
+};
+
+static DiagnosticsServer* server;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    server = new DiagnosticsServer();
+}
+
+void tearDown() {}
+
+static std::vector<Point> history(const String& query) {
+    auto response = fakes::http_get(std::string("/history?") + query.c_str());
+    TEST_ASSERT_EQUAL(200, response.status);
+    std::vector<Point> points;
+    const char* line = strchr(response.body.c_str(), '\n');
+    while (line != nullptr && line[1] != '\0') {
+        Point point;
+        TEST_ASSERT_EQUAL(4, sscanf(line + 1, "%u,%g,%g,%g", &point.time, &point.min, &point.max, &point.mean));
+        points.push_back(point);
+        line = strchr(line + 1, '\n');
+    }
+    return points;
+}
+
+// Each `coarse` point summarizes the `fine` points of its period, the ones
+// after the previous coarse point up to its own time
+static void check_tier(const std::vector<Point>& fine, const std::vector<Point>& coarse, uint32_t period) {
+    int checked = 0;
+    for (auto& point : coarse) {
+        if (point.time - period + 1 < fine.front().time) {
+            continue;
+        }
+        float min = 1e9;
+        float max = -1e9;
+        float sum = 0;
+        int count = 0;
+        for (auto& sample : fine) {
+            if (sample.time > point.time - period && sample.time <= point.time) {
+                min = std::min(min, sample.min);
+                max = std::max(max, sample.max);
+                sum += sample.mean;
+                count++;
+            }
+        }
+        TEST_ASSERT_EQUAL(period / (fine[1].time - fine[0].time), count);
+        TEST_ASSERT_FLOAT_WITHIN(RESOLUTION / 2, min, point.min);
+        TEST_ASSERT_FLOAT_WITHIN(RESOLUTION / 2, max, point.max);
+        // The fine means are rounded to the resolution on their own
+        TEST_ASSERT_FLOAT_WITHIN(RESOLUTION, sum / count, point.mean);
+        checked++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, checked);
+}
+
+static void check_spacing(const std::vector<Point>& points, uint32_t period) {
+    for (size_t i = 1; i < points.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(period, points[i].time - points[i - 1].time);
+    }
+}
+
+void test_tiers() {
+    auto store = new HistoryStore(server);
+    auto value = new ObservableValue<float>();
+    TEST_ASSERT_TRUE(store->track(value, "propulsion.main.coolantTemperature", RESOLUTION));
+    store->start();
+    server->start();
+    uint64_t start_ms = fakes::now_us() / 1000;
+    ReactESP::app->onRepeat(100, [value, start_ms]() {
+        uint32_t ms = fakes::now_us() / 1000 - start_ms;
+        value->set(60 + 20 * sinf(ms / 370000.0f) + (ms / 100 % 7) * 0.3f);
+    });
+
+    // Nothing is recorded until SNTP sets the clock
+    fakes::run_ms(5000);
+    TEST_ASSERT_EQUAL(0, history("path=propulsion.main.coolantTemperature&tier=0").size());
+
+    fakes::set_wall_clock(WALL_CLOCK);
+    fakes::run_ms(RUN_S * 1000);
+    uint32_t now = time(nullptr);
+    auto seconds = history("path=propulsion.main.coolantTemperature&tier=0");
+    auto minutes = history("path=propulsion.main.coolantTemperature&tier=1");
+    auto quarters = history("path=propulsion.main.coolantTemperature&tier=2");
+    char message[160];
+    snprintf(message, sizeof(message), "%u s of samples: %u 1 s points, %u 1 min points, %u 15 min points",
+             (unsigned)RUN_S, (unsigned)seconds.size(), (unsigned)minutes.size(), (unsigned)quarters.size());
+    TEST_MESSAGE(message);
+
+    // The last 10 minutes of 1 s points, up to now
+    TEST_ASSERT_EQUAL(600, seconds.size());
+    TEST_ASSERT_EQUAL_UINT32(now, seconds.back().time);
+    check_spacing(seconds, 1);
+    // 1 min points from flash and from the block being filled
+    TEST_ASSERT_EQUAL(RUN_S / 60, minutes.size());
+    TEST_ASSERT_UINT32_WITHIN(60, now, minutes.back().time);
+    check_spacing(minutes, 60);
+    check_tier(seconds, minutes, 60);
+    // 15 min points: one block of 8 in flash
+    TEST_ASSERT_EQUAL(RUN_S / 900, quarters.size());
+    check_spacing(quarters, 900);
+    check_tier(minutes, quarters, 900);
+
+    // The time range is applied to the stored points
+    uint32_t from = minutes[10].time;
+    uint32_t to = minutes[20].time;
+    auto range = history("path=propulsion.main.coolantTemperature&tier=1&from=" + String(from) + "&to=" + String(to));
+    TEST_ASSERT_EQUAL(11, range.size());
+    TEST_ASSERT_EQUAL_UINT32(from, range.front().time);
+    TEST_ASSERT_EQUAL_UINT32(to, range.back().time);
+}
+
+// Paths are tracked until the next one would take more flash than
+// FLASH_BUDGET, and the rings of the tracked ones fit in it
+void test_flash_budget() {
+    auto store = new HistoryStore(server);
+    int tracked = 0;
+    while (store->track(new ObservableValue<float>(), "path" + String(tracked), RESOLUTION)) {
+        tracked++;
+    }
+    fakes::reset_flash_stats();
+    store->start();
+    server->start();
+    uint64_t written = fakes::flash_stats().bytes_written;
+
+    char message[120];
+    snprintf(message, sizeof(message), "%d paths tracked, %llu bytes of flash of %u", tracked,
+             (unsigned long long)written, (unsigned)HistoryStore::FLASH_BUDGET);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(3, tracked);
+    TEST_ASSERT_LESS_OR_EQUAL(HistoryStore::FLASH_BUDGET, written);
+    // Another path's rings would not fit
+    TEST_ASSERT_GREATER_THAN(HistoryStore::FLASH_BUDGET, written + written / tracked);
+    TEST_ASSERT_EQUAL(404, fakes::http_get("/history?path=path3&tier=1").status);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_tiers);
+    RUN_TEST(test_flash_budget);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include <N2kMessages.h>
+#include <NMEA2000_esp32.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "nmea.h"
+#include "sensesp/system/lambda_consumer.h"
+
+using namespace sensesp;
+
+// NMEA 2000 receive handling against the fake CAN receive queue: how often
+// the stack is run on a quiet and on a busy bus, compared with polling it
+// every millisecond as Nmea did before, and the dispatch of the received
+// PGNs to their handlers.
+
+static const uint32_t RUN_MS = 10000;
+
+struct Received {
+    int count = 0;
+    float value = 0;
+};
+
+static Received battery_voltage;
+static Received ambient_temperature;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    battery_voltage = Received();
+    ambient_temperature = Received();
+}
+
+void tearDown() {}
+
+static Nmea* receiving_nmea() {
+    auto nmea = new Nmea();
+    nmea->battery_voltage()->connect_to(new LambdaConsumer<float>([](float value) {
+        battery_voltage.count++;
+        battery_voltage.value = value;
+    }));
+    nmea->ambient_temperature()->connect_to(new LambdaConsumer<float>([](float value) {
+        ambient_temperature.count++;
+        ambient_temperature.value = value;
+    }));
+    return nmea;
+}
+
+static float parse_calls_per_s(const char* name) {
+    float rate = fakes::can_bus().parse_calls() * 1000.0f / RUN_MS;
+    char message[120];
+    snprintf(message, sizeof(message), "%s: %.1f ParseMessages() calls/s", name, rate);
+    TEST_MESSAGE(message);
+    return rate;
+}
+
+static float polling_rate;
+
+// The stack polled every millisecond, as before
+void test_polling_quiet_bus() {
+    auto nmea2000 = new tNMEA2000_esp32();
+    ReactESP::app->onRepeat(1, [nmea2000]() { nmea2000->ParseMessages(); });
+    fakes::run_ms(RUN_MS);
+    polling_rate = parse_calls_per_s("polling every ms, quiet bus");
+    TEST_ASSERT_GREATER_THAN(500, polling_rate);
+}
+
+// Without received frames the stack only runs for its housekeeping
+void test_quiet_bus() {
+    receiving_nmea();
+    fakes::run_ms(RUN_MS);
+    float rate = parse_calls_per_s("parsing on arrival, quiet bus");
+    TEST_ASSERT_FLOAT_WITHIN(1, 20, rate);
+    TEST_ASSERT_LESS_THAN(polling_rate / 20, rate);
+}
+
+// A battery status every 100 ms and a temperature every 2 s from other
+// devices: every message is handled, with at most one parse per arrival on
+// top of the housekeeping
+void test_busy_bus() {
+    receiving_nmea();
+    ReactESP::app->onRepeat(100, []() {
+        tN2kMsg msg;
+        SetN2kPGN127508(msg, N2K_BATTERY_INSTANCE, 13.2);
+        fakes::can_bus().receive(msg);
+    });
+    ReactESP::app->onRepeat(2000, []() {
+        tN2kMsg msg;
+        SetN2kPGN130316(msg, 0, 0, N2kts_OutsideTemperature, 288.15);
+        fakes::can_bus().receive(msg);
+    });
+    fakes::run_ms(RUN_MS);
+    float rate = parse_calls_per_s("parsing on arrival, 10.5 messages/s");
+    TEST_ASSERT_INT_WITHIN(1, RUN_MS / 100, battery_voltage.count);
+    TEST_ASSERT_INT_WITHIN(1, RUN_MS / 2000, ambient_temperature.count);
+    TEST_ASSERT_LESS_THAN(20 + 11, rate);
+}
+
+// A frame is parsed on the first main loop tick after it arrived
+void test_dispatched_on_next_tick() {
+    receiving_nmea();
+    fakes::run_ms(100);
+    tN2kMsg msg;
+    SetN2kPGN127508(msg, N2K_BATTERY_INSTANCE, 12.6);
+    fakes::can_bus().receive(msg);
+    ReactESP::app->tick();
+    TEST_ASSERT_EQUAL(1, battery_voltage.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 12.6, battery_voltage.value);
+    TEST_ASSERT_EQUAL(0, fakes::can_bus().frames_pending());
+}
+
+void test_handlers() {
+    receiving_nmea();
+    fakes::run_ms(100);
+    auto receive = [](tN2kMsg& msg) {
+        fakes::can_bus().receive(msg);
+        ReactESP::app->tick();
+    };
+
+    // Other battery instances are ignored
+    tN2kMsg msg;
+    SetN2kPGN127508(msg, N2K_BATTERY_INSTANCE + 1, 24.1);
+    receive(msg);
+    TEST_ASSERT_EQUAL(0, battery_voltage.count);
+    SetN2kPGN127508(msg, N2K_BATTERY_INSTANCE, 13.8);
+    receive(msg);
+    TEST_ASSERT_EQUAL(1, battery_voltage.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 13.8, battery_voltage.value);
+
+    // Only the outside temperature, from either temperature PGN
+    SetN2kPGN130312(msg, 0, 0, N2kts_EngineRoomTemperature, 313.15);
+    receive(msg);
+    TEST_ASSERT_EQUAL(0, ambient_temperature.count);
+    SetN2kPGN130312(msg, 0, 0, N2kts_OutsideTemperature, 285.15);
+    receive(msg);
+    TEST_ASSERT_EQUAL(1, ambient_temperature.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 285.15, ambient_temperature.value);
+    SetN2kPGN130316(msg, 0, 0, N2kts_OutsideTemperature, 290.15);
+    receive(msg);
+    TEST_ASSERT_EQUAL(2, ambient_temperature.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 290.15, ambient_temperature.value);
+
+    // PGNs without a handler are dropped, whether they sort before or after
+    // the table entries
+    SetN2kPGN127488(msg, 0, 1800);
+    receive(msg);
+    SetN2kPGN127505(msg, 0, N2kft_Fuel, 50, 0.14);
+    receive(msg);
+    msg.SetPGN(130577L);
+    msg.AddByte(0);
+    receive(msg);
+    TEST_ASSERT_EQUAL(1, battery_voltage.count);
+    TEST_ASSERT_EQUAL(2, ambient_temperature.count);
+    TEST_ASSERT_EQUAL(0, fakes::can_bus().frames_pending());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_polling_quiet_bus);
+    RUN_TEST(test_quiet_bus);
+    RUN_TEST(test_busy_bus);
+    RUN_TEST(test_dispatched_on_next_tick);
+    RUN_TEST(test_handlers);
+    return UNITY_END();
+}
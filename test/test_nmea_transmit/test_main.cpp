@@ -0,0 +1,310 @@
+#include <N2kMessages.h>
+#include <NMEA2000_esp32.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <algorithm>
+
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "nmea.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
+
+using namespace sensesp;
+
+// NMEA 2000 output on the fake bus with the engine running: each value
+// arrives at the sampling period SamplingPolicy gives its sensor. The
+// transmit scheduler is compared with sending the PGN on every update, as
+// Nmea did before it. Then the engine off case, where steady values only
+// go out at each PGN's heartbeat.
+
+static const uint32_t WARM_UP_MS = 3000;
+static const uint32_t RUN_MS = 60000;
+
+struct Inputs {
+    ObservableValue<float> engine_rpms;
+    ObservableValue<float> coolant_temperature;
+    ObservableValue<float> oil_pressure;
+    ObservableValue<float> exhaust_temperature;
+    ObservableValue<float> engine_run_time;
+    ObservableValue<float> water_level;
+    ObservableValue<float> water_capacity;
+    ObservableValue<float> fuel_level;
+    ObservableValue<float> fuel_capacity;
+};
+
+static Inputs* inputs;
+
+// Slowly changing values at the engine running sampling periods
+static void feed(Inputs* in) {
+    ReactESP::app->onRepeat(500, [in]() { in->engine_rpms.set(30 + (millis() / 500) % 7); });
+    ReactESP::app->onRepeat(100, [in]() { in->coolant_temperature.set(350 + (millis() / 100) % 10 * 0.1f); });
+    ReactESP::app->onRepeat(100, [in]() { in->oil_pressure.set(300000 + (millis() / 100) % 10 * 100); });
+    ReactESP::app->onRepeat(1000, [in]() { in->exhaust_temperature.set(310 + (millis() / 1000) % 5); });
+    ReactESP::app->onRepeat(10000, [in]() { in->engine_run_time.set(3600 + millis() / 1000); });
+    ReactESP::app->onRepeat(2000, [in]() { in->water_level.set(0.5f + (millis() / 2000) % 3 * 0.01f); });
+    ReactESP::app->onRepeat(2000, [in]() { in->fuel_level.set(0.7f + (millis() / 2000) % 3 * 0.01f); });
+    ReactESP::app->onDelay(10, [in]() {
+        in->water_capacity.set(0.3f);
+        in->fuel_capacity.set(0.14f);
+    });
+}
+
+// Steady values at the engine off sampling periods
+static void feed_engine_off(Inputs* in) {
+    auto steady = [in]() {
+        in->engine_rpms.set(0);
+        in->coolant_temperature.set(291.15f);
+        in->oil_pressure.set(0);
+        in->exhaust_temperature.set(290.15f);
+        in->engine_run_time.set(36000);
+        in->water_level.set(0.5f);
+        in->fuel_level.set(0.7f);
+        in->water_capacity.set(0.3f);
+        in->fuel_capacity.set(0.14f);
+    };
+    ReactESP::app->onDelay(10, steady);
+    ReactESP::app->onRepeat(60000, steady);
+}
+
+static Nmea* connected_nmea(Inputs* in) {
+    auto nmea = new Nmea();
+    nmea->connect_engine_rpms(&in->engine_rpms);
+    nmea->connect_coolant_temperature(&in->coolant_temperature);
+    nmea->connect_oil_pressure(&in->oil_pressure);
+    nmea->connect_exhaust_temperature(&in->exhaust_temperature);
+    nmea->connect_engine_run_time(&in->engine_run_time);
+    nmea->connect_water_level(&in->water_level);
+    nmea->connect_water_capacity(&in->water_capacity);
+    nmea->connect_fuel_level(&in->fuel_level);
+    nmea->connect_fuel_capacity(&in->fuel_capacity);
+    return nmea;
+}
+
+/**
+ * @brief The transmit path of Nmea before the scheduler
+ *
+ * Every value update encoded and sent its PGN right away.
+ */
+class SendOnUpdate {
+   public:
+    SendOnUpdate(Inputs* in) {
+        nmea2000_.SetMode(tNMEA2000::N2km_NodeOnly, 22);
+        on(&in->engine_rpms, [this](float value) {
+            tN2kMsg msg;
+            SetN2kPGN127488(msg, 0, value);
+            nmea2000_.SendMsg(msg);
+        });
+        on(&in->coolant_temperature, [this](float value) { coolant_temperature_ = value; sendEngineData(); });
+        on(&in->oil_pressure, [this](float value) { oil_pressure_ = value; sendEngineData(); });
+        on(&in->engine_run_time, [this](float value) { engine_hours_ = roundf(value / 3600); sendEngineData(); });
+        on(&in->exhaust_temperature, [this](float value) {
+            tN2kMsg msg;
+            SetN2kTemperature(msg, 1, 2, N2kts_ExhaustGasTemperature, value);
+            nmea2000_.SendMsg(msg);
+        });
+        on(&in->water_level, [this](float value) { water_level_ = value; sendTank(N2kft_Water, water_level_, water_capacity_); });
+        on(&in->water_capacity, [this](float value) { water_capacity_ = value; sendTank(N2kft_Water, water_level_, water_capacity_); });
+        on(&in->fuel_level, [this](float value) { fuel_level_ = value; sendTank(N2kft_Fuel, fuel_level_, fuel_capacity_); });
+        on(&in->fuel_capacity, [this](float value) { fuel_capacity_ = value; sendTank(N2kft_Fuel, fuel_level_, fuel_capacity_); });
+    }
+
+   private:
+    void on(ValueProducer<float>* producer, std::function<void(float)> send) {
+        producer->connect_to(new LambdaConsumer<float>(send));
+    }
+
+    void sendEngineData() {
+        tN2kMsg msg;
+        SetN2kEngineDynamicParam(msg, 0, oil_pressure_, N2kFloatNA, coolant_temperature_, N2kDoubleNA, N2kDoubleNA,
+                                 engine_hours_, N2kDoubleNA, N2kDoubleNA, N2kInt8NA, N2kInt8NA, status1_, status2_);
+        nmea2000_.SendMsg(msg);
+    }
+
+    void sendTank(tN2kFluidType type, float level, float capacity) {
+        tN2kMsg msg;
+        SetN2kFluidLevel(msg, 0, type, level, capacity);
+        nmea2000_.SendMsg(msg);
+    }
+
+    tNMEA2000_esp32 nmea2000_;
+    float coolant_temperature_ = N2kFloatNA;
+    float oil_pressure_ = N2kFloatNA;
+    float engine_hours_ = N2kFloatNA;
+    float water_level_ = N2kFloatNA;
+    float water_capacity_ = N2kFloatNA;
+    float fuel_level_ = N2kFloatNA;
+    float fuel_capacity_ = N2kFloatNA;
+    tN2kEngineDiscreteStatus1 status1_;
+    tN2kEngineDiscreteStatus2 status2_;
+};
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    inputs = new Inputs();
+}
+
+void tearDown() {}
+
+// Most frames put on the bus within any 10 ms
+static uint32_t peak_burst(uint64_t from_us) {
+    auto& sent = fakes::can_bus().sent();
+    uint32_t peak = 0;
+    size_t first = 0;
+    uint32_t frames = 0;
+    for (size_t i = 0; i < sent.size(); i++) {
+        if (sent[i].time_us < from_us) {
+            first = i + 1;
+            continue;
+        }
+        frames += fakes::CanBus::frames(sent[i].msg);
+        while (sent[first].time_us + 10000 <= sent[i].time_us) {
+            frames -= fakes::CanBus::frames(sent[first].msg);
+            first++;
+        }
+        peak = std::max(peak, frames);
+    }
+    return peak;
+}
+
+// Runs for RUN_MS after a warm-up and returns the frames per second
+static float measure(const char* name) {
+    fakes::run_ms(WARM_UP_MS);
+    uint64_t start = fakes::now_us();
+    fakes::can_bus().clear();
+    fakes::run_ms(RUN_MS);
+
+    float frames_per_s = fakes::can_bus().frames_sent() * 1000.0f / RUN_MS;
+    char message[200];
+    snprintf(message, sizeof(message), "%s: %.1f frames/s, bus load %.2f%%, peak %u frames in 10 ms, PGN 127489 %.1f/s",
+             name, frames_per_s, 100 * fakes::can_bus().bus_load(RUN_MS * 1000ull), (unsigned)peak_burst(start),
+             fakes::can_bus().sent_count(127489) * 1000.0f / RUN_MS);
+    TEST_MESSAGE(message);
+    return frames_per_s;
+}
+
+static float send_on_update_rate;
+
+void test_send_on_update() {
+    new SendOnUpdate(inputs);
+    feed(inputs);
+    send_on_update_rate = measure("send on every update");
+    // Coolant temperature and oil pressure alone send PGN 127489 20 times a second
+    TEST_ASSERT_GREATER_OR_EQUAL(20, fakes::can_bus().sent_count(127489) * 1000.0f / RUN_MS);
+}
+
+void test_transmit_scheduler() {
+    connected_nmea(inputs);
+    feed(inputs);
+    float rate = measure("transmit scheduler");
+
+    // At most once per period, whatever the update rate: the RPMs change
+    // every 500 ms, the other values faster than their PGN's period
+    TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 500, fakes::can_bus().sent_count(127488));
+    TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 500, fakes::can_bus().sent_count(127489));
+    TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 2000, fakes::can_bus().sent_count(130312));
+    TEST_ASSERT_UINT32_WITHIN(2, 2 * RUN_MS / 2500, fakes::can_bus().sent_count(127505));
+    TEST_ASSERT_LESS_THAN(send_on_update_rate / 3, rate);
+}
+
+// Engine off, every value steady: each PGN goes out at its heartbeat only
+void test_engine_off() {
+    connected_nmea(inputs);
+    feed_engine_off(inputs);
+    float rate = measure("engine off, steady values");
+    float frames_per_minute = rate * 60;
+
+    // The heartbeats: 1 s for PGN 127488, 2.5 s for 127489 and 127505, 2 s
+    // for 130312; the values arriving every minute add one send each
+    uint32_t minutes = RUN_MS / 60000;
+    TEST_ASSERT_UINT32_WITHIN(minutes + 1, RUN_MS / 1000, fakes::can_bus().sent_count(127488));
+    TEST_ASSERT_UINT32_WITHIN(minutes + 1, RUN_MS / 2500, fakes::can_bus().sent_count(127489));
+    TEST_ASSERT_UINT32_WITHIN(1, RUN_MS / 2000, fakes::can_bus().sent_count(130312));
+    TEST_ASSERT_UINT32_WITHIN(2, 2 * RUN_MS / 2500, fakes::can_bus().sent_count(127505));
+
+    // Sending every PGN on each period would be 600 PGN 127488 and 120 PGN
+    // 127489 fast packets a minute
+    tN2kMsg engine_data;
+    SetN2kEngineDynamicParam(engine_data, 0, 0, N2kFloatNA, 291.15, N2kDoubleNA, N2kDoubleNA, 10, N2kDoubleNA,
+                             N2kDoubleNA, N2kInt8NA, N2kInt8NA, tN2kEngineDiscreteStatus1(),
+                             tN2kEngineDiscreteStatus2());
+    float every_period = 600 + 120 * fakes::CanBus::frames(engine_data) + 30 + 48;
+    char message[120];
+    snprintf(message, sizeof(message), "engine off: %.0f frames/minute, %.0f when sending every PGN each period",
+             frames_per_minute, every_period);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(every_period / 3, frames_per_minute);
+}
+
+// Without any value, nothing but the stack's own frames goes on the bus
+void test_no_values_yet() {
+    connected_nmea(inputs);
+    fakes::run_ms(10000);
+    for (unsigned long pgn : {127488ul, 127489ul, 130312ul, 127505ul}) {
+        TEST_ASSERT_EQUAL(0, fakes::can_bus().sent_count(pgn));
+    }
+
+    // The tank PGNs wait for a level, not just a capacity
+    inputs->fuel_capacity.set(0.14f);
+    fakes::run_ms(10000);
+    TEST_ASSERT_EQUAL(0, fakes::can_bus().sent_count(127505));
+    inputs->fuel_level.set(0.7f);
+    fakes::run_ms(2500);
+    TEST_ASSERT_EQUAL(1, fakes::can_bus().sent_count(127505));
+    TEST_ASSERT_EQUAL(0, fakes::can_bus().sent_count(127488));
+}
+
+// Coalesced values are the latest ones, and the temperature SID advances
+// with each message
+void test_coalesced_values_and_sid() {
+    auto nmea = new Nmea();
+    nmea->connect_coolant_temperature(&inputs->coolant_temperature);
+    nmea->connect_exhaust_temperature(&inputs->exhaust_temperature);
+    fakes::run_ms(100);
+    for (int i = 0; i < 10; i++) {
+        inputs->coolant_temperature.set(340 + i);
+    }
+    inputs->exhaust_temperature.set(320);
+    fakes::can_bus().clear();
+    fakes::run_ms(10000);
+
+    int last_sid = -1;
+    for (auto& sent : fakes::can_bus().sent()) {
+        unsigned char instance, sid;
+        double oil_pressure, oil_temperature, coolant_temperature, alternator_voltage, fuel_rate, hours,
+            coolant_pressure, fuel_pressure, actual, set;
+        int8_t load, torque;
+        tN2kEngineDiscreteStatus1 status1;
+        tN2kEngineDiscreteStatus2 status2;
+        tN2kTempSource source;
+        if (ParseN2kPGN127489(sent.msg, instance, oil_pressure, oil_temperature, coolant_temperature,
+                              alternator_voltage, fuel_rate, hours, coolant_pressure, fuel_pressure, load, torque,
+                              status1, status2)) {
+            TEST_ASSERT_FLOAT_WITHIN(0.01, 349, coolant_temperature);
+        } else if (ParseN2kPGN130312(sent.msg, sid, instance, source, actual, set)) {
+            TEST_ASSERT_FLOAT_WITHIN(0.01, 320, actual);
+            if (last_sid >= 0) {
+                TEST_ASSERT_EQUAL((last_sid + 1) % 253, sid);
+            }
+            last_sid = sid;
+        }
+    }
+    // Steady after the first send: the 2.5 s heartbeat for PGN 127489
+    TEST_ASSERT_UINT32_WITHIN(1, 4, fakes::can_bus().sent_count(127489));
+    TEST_ASSERT_UINT32_WITHIN(1, 5, fakes::can_bus().sent_count(130312));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_send_on_update);
+    RUN_TEST(test_transmit_scheduler);
+    RUN_TEST(test_engine_off);
+    RUN_TEST(test_no_values_yet);
+    RUN_TEST(test_coalesced_values_and_sid);
+    return UNITY_END();
+}
@@ -0,0 +1,221 @@
+#include <OneWire.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "acquisition_task.h"
+#include "config_store.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "onewire_bus.h"
+#include "sensesp/system/lambda_consumer.h"
+
+using namespace sensesp;
+
+// OneWireBus on a simulated bus of three DS18B20s, two at 12 bits and the
+// exhaust at 10 bits, as in main.cpp, against the per-sensor conversions
+// of the SensESP OneWireTemperature it replaced: bus time per second, bus
+// time at startup with and without saved ROM addresses, and when each
+// reading arrives after the conversion.
+
+static const uint32_t RUN_MS = 10000;
+static const int SENSORS = 3;
+static const uint8_t RESOLUTIONS[SENSORS] = {12, 12, 10};
+static const float CELSIUS[SENSORS] = {31.3f, 52.7f, 41.9f};
+
+struct Arrivals {
+    std::vector<uint32_t> ms;
+    float value = 0;
+};
+
+static uint8_t roms[SENSORS][8];
+static Arrivals arrivals[SENSORS];
+static AcquisitionTask* acquisition;
+
+static void boot() {
+    fakes::retire_tasks();
+    new ReactESP();
+    ConfigStore::instance()->reload();
+    acquisition = new AcquisitionTask();
+    OneWire::reset_stats();
+    for (auto& arrival : arrivals) {
+        arrival = Arrivals();
+    }
+}
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    OneWire::remove_devices();
+    for (int i = 0; i < SENSORS; i++) {
+        OneWire::ds18b20_rom(i + 1, roms[i]);
+        float celsius = CELSIUS[i];
+        OneWire::add_ds18b20(roms[i], [celsius](uint64_t us) { return celsius; });
+    }
+    boot();
+}
+
+void tearDown() {}
+
+static void record(int i, float value) {
+    arrivals[i].ms.push_back(millis());
+    arrivals[i].value = value;
+}
+
+static std::vector<OneWireBusTemperature*> batched_sensors() {
+    auto bus = new OneWireBus(ONEWIRE_PIN, acquisition, 1000);
+    std::vector<OneWireBusTemperature*> sensors;
+    for (int i = 0; i < SENSORS; i++) {
+        String path = "/data/onewire_" + String(i) + "/sensor";
+        auto sensor = new Stored<OneWireBusTemperature>(bus, RESOLUTIONS[i], path);
+        sensor->connect_to(new LambdaConsumer<float>([i](float value) { record(i, value); }));
+        sensors.push_back(sensor);
+    }
+    bus->start();
+    acquisition->start();
+    return sensors;
+}
+
+/**
+ * @brief The SensESP OneWireTemperature way, per sensor
+ *
+ * The bus is searched at every boot. Each sensor starts its own conversion
+ * every second with Match ROM, and reads its scratchpad 750 ms later,
+ * whatever its resolution.
+ */
+static void per_sensor() {
+    auto onewire = new OneWire(ONEWIRE_PIN);
+    acquisition->reactor()->onDelay(0, [onewire]() {
+        uint8_t address[8];
+        onewire->reset_search();
+        while (onewire->search(address)) {
+        }
+    });
+    for (int i = 0; i < SENSORS; i++) {
+        acquisition->reactor()->onRepeat(1000, [onewire, i]() {
+            onewire->reset();
+            onewire->select(roms[i]);
+            onewire->write(0x44);
+            acquisition->reactor()->onDelay(750, [onewire, i]() {
+                uint8_t scratchpad[9];
+                onewire->reset();
+                onewire->select(roms[i]);
+                onewire->write(0xBE);
+                onewire->read_bytes(scratchpad, sizeof(scratchpad));
+                int16_t raw = (scratchpad[1] << 8) | scratchpad[0];
+                arrivals[i].ms.push_back(millis());
+                arrivals[i].value = raw / 16.0f + 273.15f;
+            });
+        });
+    }
+    acquisition->start();
+}
+
+struct BusTime {
+    float startup_ms;
+    float ms_per_s;
+};
+
+static BusTime measure(const char* name) {
+    // The search runs as soon as the acquisition task starts
+    fakes::run_ms(500);
+    float startup_ms = OneWire::bus_us() / 1000.0f;
+    fakes::run_ms(1000);
+    OneWire::reset_stats();
+    fakes::reset_task_stats();
+    fakes::run_ms(RUN_MS);
+    BusTime time = {startup_ms, OneWire::bus_us() / 1000.0f / (RUN_MS / 1000)};
+
+    char message[200];
+    snprintf(message, sizeof(message),
+             "%s: %.1f ms of bus time in the first 500 ms, %.1f ms/s after; acquisition task busy %.1f ms max", name,
+             time.startup_ms, time.ms_per_s, fakes::max_task_busy_us() / 1000.0f);
+    TEST_MESSAGE(message);
+    return time;
+}
+
+// Time from each exhaust reading to the next 12-bit one (ms)
+static uint32_t exhaust_lead_ms() {
+    uint32_t exhaust = arrivals[2].ms.back();
+    for (auto ms : arrivals[0].ms) {
+        if (ms >= exhaust) {
+            return ms - exhaust;
+        }
+    }
+    return 0;
+}
+
+static BusTime per_sensor_time;
+
+void test_per_sensor() {
+    per_sensor();
+    per_sensor_time = measure("per sensor conversions");
+    for (int i = 0; i < SENSORS; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.25f, CELSIUS[i] + 273.15f, arrivals[i].value);
+    }
+}
+
+// A single convert T for the three sensors, and the 10-bit exhaust read as
+// soon as its 188 ms conversion is done
+void test_batched() {
+    batched_sensors();
+    BusTime time = measure("batched conversions, first boot");
+    for (int i = 0; i < SENSORS; i++) {
+        // The exhaust at 0.25 K resolution, the others at 1/16 K
+        TEST_ASSERT_FLOAT_WITHIN(RESOLUTIONS[i] == 10 ? 0.25f : 0.0625f, CELSIUS[i] + 273.15f, arrivals[i].value);
+        TEST_ASSERT_UINT32_WITHIN(1, (1500 + RUN_MS) / 1000, arrivals[i].ms.size());
+    }
+    char message[120];
+    snprintf(message, sizeof(message), "exhaust reading %u ms before the 12-bit ones", (unsigned)exhaust_lead_ms());
+    TEST_MESSAGE(message);
+    // Less the time it takes to read the first 12-bit sensor, 12 ms
+    TEST_ASSERT_UINT32_WITHIN(15, 750 - 187, exhaust_lead_ms());
+    TEST_ASSERT_LESS_THAN(per_sensor_time.ms_per_s * 0.75f, time.ms_per_s);
+}
+
+// The ROM addresses found on the first boot are saved, so the next boot
+// does not search the bus, and each sensor keeps its device
+void test_saved_addresses() {
+    batched_sensors();
+    fakes::run_ms(1500);
+    TEST_ASSERT_EQUAL_UINT32(1, OneWire::searches());
+
+    boot();
+    batched_sensors();
+    BusTime time = measure("batched conversions, saved addresses");
+    TEST_ASSERT_EQUAL_UINT32(0, OneWire::searches());
+    for (int i = 0; i < SENSORS; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.25f, CELSIUS[i] + 273.15f, arrivals[i].value);
+    }
+    // Setting the resolutions alone, without the search
+    TEST_ASSERT_LESS_THAN(per_sensor_time.startup_ms, time.startup_ms);
+}
+
+// Configurations saved before the resolution was configurable only have
+// the address; the sensor keeps the resolution it was built with
+void test_configuration_without_resolution() {
+    auto bus = new OneWireBus(ONEWIRE_PIN, acquisition, 1000);
+    OneWireBusTemperature sensor(bus, 10);
+    DynamicJsonDocument doc(256);
+    JsonObject config = doc.to<JsonObject>();
+    config["address"] = "28:03:5a:01:00:00:00:7b";
+    TEST_ASSERT_TRUE(sensor.set_configuration(config));
+    TEST_ASSERT_EQUAL_UINT(750 / 4, sensor.conversion_time());
+    JsonObject saved = doc.to<JsonObject>();
+    sensor.get_configuration(saved);
+    TEST_ASSERT_EQUAL_STRING("28:03:5a:01:00:00:00:7b", saved["address"].as<String>().c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_per_sensor);
+    RUN_TEST(test_batched);
+    RUN_TEST(test_saved_addresses);
+    RUN_TEST(test_configuration_without_resolution);
+    return UNITY_END();
+}
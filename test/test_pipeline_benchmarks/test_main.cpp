@@ -0,0 +1,253 @@
+#include <Adafruit_ADS1X15.h>
+#include <DS1603L.h>
+#include <OneWire.h>
+#include <unity.h>
+
+#include <chrono>
+#include <vector>
+
+#include "config_store.h"
+#include "configuration.h"
+#include "diagnostics_server.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "fakes/heap.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensor_pipelines.h"
+
+using namespace sensesp;
+
+// Benchmarks of the sensor pipelines of main.cpp, built by the same
+// setup*() functions on top of the fakes. For each pipeline:
+// - host time and heap allocations per sample pushed through it, from the
+//   sensor to the Signal K outputs, NMEA 2000 and the history;
+// - Signal K updates per second over simulated minutes, with the fake
+//   sensors producing slowly changing values.
+// Run with `pio test -e native -v` to see the numbers.
+
+static const int SAMPLES = 20000;
+static const uint32_t WARM_UP_MS = 5000;
+static const uint32_t RUN_MS = 60000;
+
+// Volts at the ADS1115 pin for a sender of `ohms`, driven by the engine hat current source
+static float ohms_to_chip_volts(float ohms) { return ohms * ADS1115MEASUREMENTCURRENT / ADS1115INPUTSCALE; }
+
+static float wave(uint64_t us, float low, float high, float period_s) {
+    return low + (high - low) * 0.5f * (1 + sinf(2 * M_PI * us / 1e6f / period_s));
+}
+
+struct Rig {
+    Adafruit_ADS1115* ads1115;
+    PipelineServices services;
+};
+
+static Rig rig;
+
+// The part of setup() the pipelines depend on
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    // SNTP has set the clock, so the history records
+    fakes::set_wall_clock(1601510400);
+    Startable::forget_all();
+    SKOutputFloat::forget_all();
+    OneWire::remove_devices();
+
+    rig = Rig();
+    auto acquisition = new AcquisitionTask(ACQUISITION_CORE);
+    rig.ads1115 = new Adafruit_ADS1115();
+    rig.ads1115->setGain(ADS1115GAIN);
+    rig.ads1115->begin(ADS1115ADDR);
+    rig.services = {new Nmea(),
+                    new Stored<SensorLog>("/system/sensor_log"),
+                    new HistoryStore(new DiagnosticsServer()),
+                    new Stored<SamplingPolicy>("/system/sampling_policy"),
+                    acquisition,
+                    new Ads1115Scheduler(new Ads1115Device(rig.ads1115), acquisition),
+                    nullptr};
+}
+
+void tearDown() {}
+
+// As at the end of setup(), with the history started right away
+static void start() {
+    Startable::start_all();
+    rig.services.acquisition->start();
+    rig.services.sensor_log->start();
+    rig.services.history->start();
+}
+
+// Signal K updates of the pipeline outputs, not counting the deadband diagnostics
+static uint32_t output_count() {
+    uint32_t count = 0;
+    for (auto output : SKOutputFloat::all()) {
+        if (!output->sk_path().startsWith("sensorDevice.")) {
+            count += output->count();
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Pushes SAMPLES values from `low` to `high` and back into `head`
+ *
+ * Reports the host time and the heap allocations per sample, and checks
+ * that a sample allocates nothing once the pipeline is warmed up.
+ */
+static void bench_samples(const char* name, ValueProducer<float>* head, float low, float high) {
+    auto emit = [head, low, high](int i) {
+        float phase = (float)(i % 200) / 100;
+        head->emit(low + (high - low) * (phase < 1 ? phase : 2 - phase));
+    };
+    // Every transform sees a full sweep before the measurement
+    for (int i = 0; i < 400; i++) {
+        emit(i);
+    }
+    uint32_t outputs = output_count();
+    uint64_t allocations = fakes::allocations();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < SAMPLES; i++) {
+        emit(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    allocations = fakes::allocations() - allocations;
+    outputs = output_count() - outputs;
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count() / SAMPLES;
+    char message[160];
+    snprintf(message, sizeof(message), "%s: %.0f ns/sample, %.3f allocations/sample, %.3f outputs/sample", name, ns,
+             (double)allocations / SAMPLES, (double)outputs / SAMPLES);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT64(0, allocations);
+}
+
+// Runs the rig for RUN_MS of simulated time and reports the Signal K updates per second
+static void bench_rate(const char* name, float min_rate, float max_rate) {
+    fakes::run_ms(WARM_UP_MS);
+    uint32_t outputs = output_count();
+    uint64_t allocations = fakes::allocations();
+    fakes::reset_task_stats();
+    fakes::run_ms(RUN_MS);
+    outputs = output_count() - outputs;
+    allocations = fakes::allocations() - allocations;
+
+    float rate = outputs * 1000.0f / RUN_MS;
+    char message[160];
+    snprintf(message, sizeof(message), "%s: %.2f Signal K updates/s, %.1f allocations/s, acquisition task busy %u us max",
+             name, rate, allocations * 1000.0f / RUN_MS, (unsigned)fakes::max_task_busy_us());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_OR_EQUAL(min_rate, rate);
+    TEST_ASSERT_LESS_OR_EQUAL(max_rate, rate);
+}
+
+void test_coolant_temperature() {
+    auto sensor = setupEngineCoolantTemperature(rig.services);
+    start();
+    bench_samples("coolant temperature", sensor, 22.44, 356.64);
+
+    rig.ads1115->set_input(ENGINE_COOLANT_TEMP_SENSOR_CHANNEL, [](uint64_t us) {
+        return ohms_to_chip_volts(wave(us, 30, 120, 60));
+    });
+    bench_rate("coolant temperature", 0.1, 6);
+}
+
+void test_oil_pressure() {
+    ObservableValue<float> rpms;
+    auto sensor = setupEngineOilTemperature(rig.services, &rpms);
+    start();
+    rpms.set(30);
+    bench_samples("oil pressure", sensor, 10, 184);
+
+    rig.ads1115->set_input(ENGINE_OIL_PRESSURE_SENSOR_CHANNEL, [](uint64_t us) {
+        return ohms_to_chip_volts(wave(us, 60, 150, 45));
+    });
+    // Sampled every 100 ms, the engine running period of SamplingPolicy
+    bench_rate("oil pressure", 0.1, 10);
+}
+
+void test_water_tank() {
+    auto sensor = setupWaterTank(rig.services);
+    start();
+    bench_samples("water tank", sensor, 0, 180);
+
+    rig.ads1115->set_input(FRESH_WATER_TANK_SENSOR_CHANNEL, [](uint64_t us) {
+        return ohms_to_chip_volts(wave(us, 20, 160, 120));
+    });
+    bench_rate("water tank", 0.1, 8);
+}
+
+void test_alternator_output() {
+    auto sensor = setupAlternatorOutput(rig.services);
+    start();
+    bench_samples("alternator output", sensor, 0, 2);
+
+    // 50 Hz around a 1 V bias at the input, amplitude swinging between 0.1 and 0.5 V
+    rig.ads1115->set_input(ALTERNATOR_OUTPUT_SENSOR_CHANNEL, [](uint64_t us) {
+        float amplitude = wave(us, 0.1, 0.5, 20);
+        return (1 + amplitude * sinf(2 * M_PI * 50 * us / 1e6f)) / ADS1115INPUTSCALE;
+    });
+    bench_rate("alternator output", 0.1, 1);
+}
+
+void test_diesel_tank() {
+    auto sensor = setupDieselTank(rig.services);
+    start();
+    bench_samples("diesel tank", sensor, 0, 200);
+
+    // The DS1603L sends its level about once a second
+    ReactESP::app->onRepeat(1000, []() {
+        uint8_t frame[4];
+        DS1603L::frame(wave(fakes::now_us(), 20, 180, 90), frame);
+        Serial1.receive(frame, sizeof(frame));
+    });
+    bench_rate("diesel tank", 0.05, 2);
+}
+
+void test_engine_rpms_and_run_time() {
+    // The RPM sensor replaced by a value the test sets every 500 ms, its
+    // default read delay
+    auto raw = new ObservableValue<float>();
+    setupEngineRpmsAndRuntime(rig.services, raw);
+    start();
+    bench_samples("engine rpms and run time", raw, 0, 50);
+
+    ReactESP::app->onRepeat(500, [raw]() { raw->set(wave(fakes::now_us(), 10, 40, 30)); });
+    bench_rate("engine rpms and run time", 0.5, 3);
+}
+
+void test_onewire_temperatures() {
+    // Three DS18B20s on the fake bus, in the order setup1WireTempSensors() creates the sensors
+    std::function<float(uint64_t)> celsius[3] = {
+        [](uint64_t us) { return wave(us, 22, 42, 120); },
+        [](uint64_t us) { return wave(us, 27, 77, 60); },
+        [](uint64_t us) { return wave(us, 17, 57, 90); },
+    };
+    for (int i = 0; i < 3; i++) {
+        uint8_t rom[8];
+        OneWire::ds18b20_rom(i + 1, rom);
+        OneWire::add_ds18b20(rom, celsius[i]);
+    }
+    auto sensors = setup1WireTempSensors(rig.services);
+    start();
+    bench_samples("engine room temperature", sensors.engine_room, 290, 340);
+    bench_samples("alternator temperature", sensors.engine_alternator, 290, 340);
+    bench_samples("exhaust temperature", sensors.engine_exhaust, 290, 340);
+
+    bench_rate("1-Wire temperatures", 0.1, 3);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_coolant_temperature);
+    RUN_TEST(test_oil_pressure);
+    RUN_TEST(test_water_tank);
+    RUN_TEST(test_alternator_output);
+    RUN_TEST(test_diesel_tank);
+    RUN_TEST(test_engine_rpms_and_run_time);
+    RUN_TEST(test_onewire_temperatures);
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <chrono>
+
+#include "diagnostics_server.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "fakes/http.h"
+#include "fuel_tank_sensor.h"
+#include "reaction_profiler.h"
+#include "run_time_sensor.h"
+#include "sensesp/system/observablevalue.h"
+
+using namespace sensesp;
+
+// The cost of ReactionProfiler::wrap() on the host, built without
+// REACTION_PROFILING_DISABLED: a bare callback against the same callback
+// wrapped as a tick reaction and as a repeating one, and what that adds to
+// the 1 ms main loop tick for the profiled tick reactions of main.cpp. Also
+// that the reactions run by an AdjustableTimer show up in /reactions.
+
+static const int CALLS = 2000000;
+// acquisition_drain, nmea_parse and rpm_period run on every tick
+static const int TICK_REACTIONS = 3;
+
+static volatile uint32_t sink;
+
+static void body() { sink = sink + 1; }
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+static double ns_per_call(std::function<void()> callback) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLS; i++) {
+        callback();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / CALLS;
+}
+
+void test_wrap_overhead() {
+    // Best of three, as the host may be busy with something else
+    double bare = 1e9;
+    double tick = 1e9;
+    double repeating = 1e9;
+    auto wrapped_tick = ReactionProfiler::instance()->wrap("benchmark_tick", 0, body);
+    auto wrapped_repeating = ReactionProfiler::instance()->wrap("benchmark_repeating", 10, body);
+    for (int run = 0; run < 3; run++) {
+        bare = std::min(bare, ns_per_call(body));
+        tick = std::min(tick, ns_per_call(wrapped_tick));
+        repeating = std::min(repeating, ns_per_call(wrapped_repeating));
+    }
+    double overhead = std::max(tick, repeating) - bare;
+    double share = TICK_REACTIONS * overhead / 1e6;
+
+    char message[200];
+    snprintf(message, sizeof(message),
+             "bare callback %.1f ns, wrapped tick reaction %.1f ns, wrapped repeating reaction %.1f ns: "
+             "%.4f%% of a 1 ms tick for %d tick reactions",
+             bare, tick, repeating, 100 * share, TICK_REACTIONS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(0.01, share);
+}
+
+// The AdjustableTimer callbacks of FuelTankSensor and RunTimeSensor are
+// profiled like the other main loop reactions
+void test_adjustable_timers_profiled() {
+    auto server = new DiagnosticsServer();
+    ReactionProfiler::instance()->add_handler(server);
+    server->start();
+    auto fuel_tank = new FuelTankSensor(0, 100, 500);
+    fuel_tank->start();
+    auto run_time = new RunTimeSensor(new ObservableValue<float>(0), 1000);
+    run_time->start();
+    fakes::run_ms(5000);
+
+    auto response = fakes::http_get("/reactions");
+    TEST_ASSERT_EQUAL(200, response.status);
+    auto count = [&response](const char* name) {
+        size_t line = response.body.find(std::string("\n") + name + ",");
+        TEST_ASSERT_TRUE_MESSAGE(line != std::string::npos, name);
+        // name,period_ms,count,...
+        size_t field = response.body.find(',', response.body.find(',', line) + 1);
+        return atoi(response.body.c_str() + field + 1);
+    };
+    TEST_ASSERT_INT_WITHIN(1, 5000 / 500, count("fuel_tank"));
+    TEST_ASSERT_INT_WITHIN(1, 5000 / 1000, count("run_time_update"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_wrap_overhead);
+    RUN_TEST(test_adjustable_timers_profiled);
+    return UNITY_END();
+}
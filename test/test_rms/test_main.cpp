@@ -0,0 +1,166 @@
+#include <Adafruit_ADS1X15.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <chrono>
+#include <vector>
+
+#include "acquisition_task.h"
+#include "adc_channel.h"
+#include "ads1115_scheduler.h"
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "rms_accumulator.h"
+#include "rms_voltage_sensor.h"
+#include "sensesp/system/lambda_consumer.h"
+
+using namespace sensesp;
+
+// The alternator current RMS: the accumulator kernel on its own, and the
+// RmsVoltageSensor bursts on the fake ADS1115 fed a 50 Hz waveform, alone
+// and sharing the chip with the other analog channels as in main.cpp.
+
+static const float BIAS = 1.0f;
+static const float AMPLITUDE = 0.4f;
+static const uint32_t RUN_MS = 20000;
+
+static Adafruit_ADS1115* ads1115;
+static AcquisitionTask* acquisition;
+static Ads1115Scheduler* scheduler;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+
+    ads1115 = new Adafruit_ADS1115();
+    ads1115->setGain(ADS1115GAIN);
+    ads1115->set_i2c_frequency(I2C_FREQUENCY);
+    acquisition = new AcquisitionTask(ACQUISITION_CORE);
+    scheduler = new Ads1115Scheduler(new Ads1115Device(ads1115), acquisition);
+}
+
+void tearDown() {}
+
+// A large DC offset does not cost any precision
+void test_accumulator_is_exact() {
+    RmsAccumulator accumulator;
+    for (int i = 0; i < 100000; i++) {
+        accumulator.add(i % 2 == 0 ? 30100 : 29900);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(30000, accumulator.mean());
+    TEST_ASSERT_EQUAL_FLOAT(100, accumulator.rms());
+
+    accumulator.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, accumulator.count());
+    TEST_ASSERT_EQUAL_FLOAT(0, accumulator.rms());
+}
+
+void test_accumulator_benchmark() {
+    const int WINDOWS = 20000;
+    const int SAMPLES = 172;  // 200 ms at 860 SPS
+    std::vector<int16_t> samples(SAMPLES);
+    for (int i = 0; i < SAMPLES; i++) {
+        samples[i] = 9000 + 4000 * sinf(2 * M_PI * 50 * i / 860.0f);
+    }
+
+    RmsAccumulator accumulator;
+    volatile float sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int window = 0; window < WINDOWS; window++) {
+        for (auto sample : samples) {
+            accumulator.add(sample);
+        }
+        sink = accumulator.rms();
+        accumulator.reset();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    char message[120];
+    snprintf(message, sizeof(message), "RMS kernel: %.2f ns/sample including the per-window rms()",
+             std::chrono::duration<double, std::nano>(end - begin).count() / WINDOWS / SAMPLES);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_FLOAT_WITHIN(20, 4000 / sqrtf(2), sink);
+}
+
+// BIAS + AMPLITUDE * sin(50 Hz) at the engine hat input
+static void alternator_input(int channel) {
+    ads1115->set_input(channel, [](uint64_t us) {
+        return (BIAS + AMPLITUDE * sinf(2 * M_PI * 50 * us / 1e6f)) / ADS1115INPUTSCALE;
+    });
+}
+
+// Virtual time the last run_sensor() took; the tasks' I2C transactions
+// make it a little longer than RUN_MS
+static uint32_t elapsed_ms;
+
+static std::vector<float> run_sensor() {
+    auto sensor = new RmsVoltageSensor(scheduler, ALTERNATOR_OUTPUT_SENSOR_CHANNEL, 1000, 200);
+    std::vector<float>* readings = new std::vector<float>();
+    sensor->connect_to(new LambdaConsumer<float>([readings](float value) { readings->push_back(value); }));
+    sensor->start();
+    acquisition->start();
+    uint32_t start = millis();
+    fakes::run_ms(RUN_MS);
+    elapsed_ms = millis() - start;
+    return *readings;
+}
+
+// `other_conversions` were made for the single-shot channels
+static void check_readings(const char* name, const std::vector<float>& readings, uint32_t other_conversions = 0) {
+    float expected = AMPLITUDE / sqrtf(2);
+    float worst = 0;
+    for (auto reading : readings) {
+        worst = std::max(worst, fabsf(reading - expected) / expected);
+    }
+    char message[160];
+    float per_window = (float)(ads1115->conversions() - other_conversions) / readings.size();
+    snprintf(message, sizeof(message), "%s: %u windows, %.1f conversions per window (%.0f SPS), worst error %.2f%%",
+             name, (unsigned)readings.size(), per_window, per_window * 1000 / 200, 100 * worst);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_UINT32_WITHIN(1, elapsed_ms / 1000, readings.size());
+    TEST_ASSERT_LESS_THAN(0.02f, worst);
+    // Within 20% of the chip's 860 SPS: the start and the completion poll
+    // of each conversion are all that is lost
+    TEST_ASSERT_GREATER_THAN(0.8f * 860 * 200 / 1000, per_window);
+}
+
+void test_sine_accuracy() {
+    alternator_input(ALTERNATOR_OUTPUT_SENSOR_CHANNEL);
+    check_readings("50 Hz sine", run_sensor());
+}
+
+// The bursts share the chip with the three 500 ms single-shot channels
+void test_sine_accuracy_with_other_channels() {
+    alternator_input(ALTERNATOR_OUTPUT_SENSOR_CHANNEL);
+    std::vector<uint32_t> counts(4);
+    for (int channel = 0; channel < 4; channel++) {
+        if (channel == ALTERNATOR_OUTPUT_SENSOR_CHANNEL) {
+            continue;
+        }
+        ads1115->set_input(channel, [](uint64_t us) { return 1.0f; });
+        scheduler->add_channel(channel, 500, [channel, &counts](float value) {
+            TEST_ASSERT_EQUAL_FLOAT(8000, value);
+            counts[channel]++;
+        });
+    }
+    auto readings = run_sensor();
+    check_readings("50 Hz sine with three other channels", readings, counts[0] + counts[1] + counts[2] + counts[3]);
+    for (int channel = 0; channel < 4; channel++) {
+        if (channel != ALTERNATOR_OUTPUT_SENSOR_CHANNEL) {
+            TEST_ASSERT_UINT32_WITHIN(1, elapsed_ms / 500, counts[channel]);
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_accumulator_is_exact);
+    RUN_TEST(test_accumulator_benchmark);
+    RUN_TEST(test_sine_accuracy);
+    RUN_TEST(test_sine_accuracy_with_other_channels);
+    return UNITY_END();
+}
@@ -0,0 +1,349 @@
+#include <ArduinoJson.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "configuration.h"
+#include "edge_capture.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "pulse_counter.h"
+#include "rpm_sensor.h"
+#include "sensesp/system/lambda_consumer.h"
+
+using namespace sensesp;
+
+// RpmSensor on synthetic W-terminal edge streams, in period mode through a
+// simulated capture unit and in count mode through a simulated pulse
+// counter: accuracy at idle, lag while accelerating, glitches, the stop
+// timeout, capture buffer overflows, and the capture interrupt rate with
+// and without the prescaler.
+
+// Capture unit clock, the ESP32 APB clock
+static const uint32_t TICKS_PER_US = 80;
+static const float IDLE_HZ = 250;
+
+struct Edge {
+    double us;
+    bool glitch;
+};
+
+// Virtual time at the start of the test, which the edge streams start from
+static uint64_t start_us;
+
+// Virtual time since the start of the test
+static uint64_t test_us() { return fakes::now_us() - start_us; }
+
+/**
+ * @brief Edge times of a pulse train of frequency `hz(us)`
+ *
+ * Times are from the start of the test. Where the frequency is 0 there are
+ * no edges. Every `glitch_every`th edge is followed by a 2 us glitch.
+ */
+static std::vector<Edge> edge_stream(uint64_t until_us, std::function<float(double)> hz, int glitch_every = 0) {
+    std::vector<Edge> edges;
+    double us = 1000;
+    int count = 0;
+    while (us < until_us) {
+        float frequency = hz(us);
+        if (frequency <= 0) {
+            us += 1000;
+            continue;
+        }
+        edges.push_back({us, false});
+        if (glitch_every > 0 && ++count % glitch_every == 0) {
+            edges.push_back({us + 2, true});
+        }
+        us += 1e6 / frequency;
+    }
+    return edges;
+}
+
+/**
+ * @brief Capture unit on a simulated edge stream
+ *
+ * Behaves as McpwmEdgeCapture: every `prescale`th edge, glitches included,
+ * is pushed into a ring of BUFFER_SIZE timestamps once its time has come,
+ * and edges are dropped from a full buffer until the overflow is taken.
+ */
+class SimulatedEdgeCapture : public EdgeCapture {
+   public:
+    static const size_t BUFFER_SIZE = 64;
+
+    SimulatedEdgeCapture(const std::vector<Edge>* edges, uint32_t prescale) : edges_{edges}, prescale_{prescale} {}
+
+    void begin() override {}
+
+    bool next_edge(uint32_t* timestamp) override {
+        interrupts_until(test_us());
+        if (buffer_.empty()) {
+            return false;
+        }
+        *timestamp = buffer_.front();
+        buffer_.erase(buffer_.begin());
+        return true;
+    }
+
+    bool take_overflow() override {
+        interrupts_until(test_us());
+        bool overflow = overflow_;
+        overflow_ = false;
+        return overflow;
+    }
+
+    uint32_t edges_per_timestamp() override { return prescale_; }
+    uint32_t ticks_per_second() override { return TICKS_PER_US * 1000000; }
+
+    uint32_t interrupts() { return interrupts_; }
+
+   private:
+    void interrupts_until(uint64_t now_us) {
+        for (; next_ < edges_->size() && (*edges_)[next_].us <= now_us; next_++) {
+            if (++prescaled_ < prescale_) {
+                continue;
+            }
+            prescaled_ = 0;
+            interrupts_++;
+            if (overflow_ || buffer_.size() >= BUFFER_SIZE) {
+                overflow_ = true;
+                continue;
+            }
+            buffer_.push_back((uint32_t)((uint64_t)((*edges_)[next_].us * TICKS_PER_US)));
+        }
+    }
+
+    const std::vector<Edge>* edges_;
+    uint32_t prescale_;
+    size_t next_ = 0;
+    uint32_t prescaled_ = 0;
+    uint32_t interrupts_ = 0;
+    std::vector<uint32_t> buffer_;
+    bool overflow_ = false;
+};
+
+// Pulse counter on a simulated edge stream; its glitch filter drops the glitches
+class SimulatedPulseCounter : public PulseCounter {
+   public:
+    SimulatedPulseCounter(const std::vector<Edge>* edges) : edges_{edges} {}
+
+    void begin() override {}
+
+    uint32_t take_count() override {
+        uint32_t count = 0;
+        for (; next_ < edges_->size() && (*edges_)[next_].us <= test_us(); next_++) {
+            count += (*edges_)[next_].glitch ? 0 : 1;
+        }
+        return count;
+    }
+
+   private:
+    const std::vector<Edge>* edges_;
+    size_t next_ = 0;
+};
+
+struct Reading {
+    uint64_t us;
+    float hz;
+};
+
+static std::vector<Edge> edges;
+static std::vector<Reading> readings;
+static SimulatedEdgeCapture* capture;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    start_us = fakes::now_us();
+    readings.clear();
+}
+
+void tearDown() {}
+
+static RpmSensor* rpm_sensor(const char* mode, uint32_t prescale) {
+    capture = new SimulatedEdgeCapture(&edges, prescale);
+    auto sensor = new RpmSensor(new SimulatedPulseCounter(&edges), capture, 500);
+    DynamicJsonDocument doc(512);
+    JsonObject config = doc.to<JsonObject>();
+    config["mode"] = mode;
+    config["read_delay"] = 500;
+    config["average_periods"] = 8;
+    config["emit_edges"] = 8;
+    config["emit_interval"] = 100;
+    config["stop_timeout"] = 1000;
+    TEST_ASSERT_TRUE(sensor->set_configuration(config));
+    sensor->connect_to(new LambdaConsumer<float>([](float hz) { readings.push_back({test_us(), hz}); }));
+    sensor->start();
+    return sensor;
+}
+
+// Largest relative error of the readings from `from_us` on
+static float worst_error(uint64_t from_us, std::function<float(double)> hz) {
+    float worst = 0;
+    for (auto& reading : readings) {
+        if (reading.us >= from_us) {
+            worst = std::max(worst, fabsf(reading.hz - hz(reading.us)) / hz(reading.us));
+        }
+    }
+    return worst;
+}
+
+static float idle(double us) {
+    // 0.5% period jitter
+    return IDLE_HZ * (1 + 0.005f * sinf(us * 0.0137));
+}
+
+static float idle_error(const char* mode, uint32_t prescale, int glitch_every) {
+    edges = edge_stream(6000000, idle, glitch_every);
+    rpm_sensor(mode, prescale);
+    fakes::run_ms(6000);
+    float error = worst_error(1000000, [](double us) { return IDLE_HZ; });
+    char message[160];
+    int length = snprintf(message, sizeof(message), "%s mode, prescale %u, %s: worst error %.2f%%, %.0f readings/s",
+                          mode, (unsigned)prescale, glitch_every > 0 ? "a glitch every 50 edges" : "idle",
+                          100 * error, readings.size() / 6.0f);
+    if (strcmp(mode, "period") == 0) {
+        snprintf(message + length, sizeof(message) - length, ", %.0f capture interrupts/s", capture->interrupts() / 6.0f);
+    }
+    TEST_MESSAGE(message);
+    return error;
+}
+
+void test_period_idle() {
+    TEST_ASSERT_LESS_THAN(0.01f, idle_error("period", 1, 0));
+    uint32_t unscaled_interrupts = capture->interrupts();
+    setUp();
+    TEST_ASSERT_LESS_THAN(0.01f, idle_error("period", RPM_CAPTURE_PRESCALE, 0));
+    TEST_ASSERT_UINT32_WITHIN(2, unscaled_interrupts / RPM_CAPTURE_PRESCALE, capture->interrupts());
+}
+
+// The minimum period, with the prescaler the dropping of the short
+// interval, and in count mode the glitch filter of the pulse counter
+void test_count_idle() {
+    // One pulse more or less in a 500 ms count is 0.8%
+    TEST_ASSERT_LESS_THAN(0.01f, idle_error("count", 1, 0));
+}
+
+void test_glitches() {
+    TEST_ASSERT_LESS_THAN(0.01f, idle_error("period", 1, 50));
+    setUp();
+    TEST_ASSERT_LESS_THAN(0.01f, idle_error("period", RPM_CAPTURE_PRESCALE, 50));
+    setUp();
+    TEST_ASSERT_LESS_THAN(0.01f, idle_error("count", 1, 50));
+}
+
+static float accelerating(double us) {
+    // Idle to 4 times idle between 1 s and 3 s
+    float t = std::min(std::max((us - 1e6) / 2e6, 0.0), 1.0);
+    return IDLE_HZ * (1 + 3 * t);
+}
+
+// How long ago the true frequency was what a reading says, while accelerating
+static uint32_t worst_lag_ms(const char* mode, uint32_t prescale) {
+    edges = edge_stream(4000000, accelerating);
+    rpm_sensor(mode, prescale);
+    fakes::run_ms(4000);
+    double worst_us = 0;
+    for (auto& reading : readings) {
+        if (reading.us < 1100000 || reading.us > 3000000) {
+            continue;
+        }
+        double true_us = 1e6 + 2e6 * (reading.hz / IDLE_HZ - 1) / 3;
+        worst_us = std::max(worst_us, reading.us - true_us);
+    }
+    char message[120];
+    snprintf(message, sizeof(message), "%s mode, prescale %u: worst lag %.1f ms accelerating from %.0f to %.0f Hz", mode,
+             (unsigned)prescale, worst_us / 1000, IDLE_HZ, 4 * IDLE_HZ);
+    TEST_MESSAGE(message);
+    return worst_us / 1000;
+}
+
+void test_acceleration() {
+    // Half of the 8 averaged periods at idle, 16 ms
+    TEST_ASSERT_LESS_THAN(25, worst_lag_ms("period", 1));
+    setUp();
+    TEST_ASSERT_LESS_THAN(25, worst_lag_ms("period", RPM_CAPTURE_PRESCALE));
+    setUp();
+    // Half of the 500 ms count, plus the time since the last read
+    TEST_ASSERT_LESS_THAN(300, worst_lag_ms("count", 1));
+}
+
+// The engine stops at 2 s: the readings drop to 0 once stop_timeout passed
+void test_stop_timeout() {
+    edges = edge_stream(4000000, [](double us) { return us < 2e6 ? IDLE_HZ : 0.0f; });
+    rpm_sensor("period", RPM_CAPTURE_PRESCALE);
+    fakes::run_ms(4000);
+    uint64_t stopped_us = 0;
+    for (auto& reading : readings) {
+        if (reading.hz == 0 && reading.us > 1000000 && stopped_us == 0) {
+            stopped_us = reading.us;
+        }
+        if (stopped_us != 0) {
+            TEST_ASSERT_EQUAL_FLOAT(0, reading.hz);
+        }
+    }
+    double last_edge_us = edges.back().us;
+    char message[120];
+    snprintf(message, sizeof(message), "0 RPM read %.0f ms after the last edge", (stopped_us - last_edge_us) / 1000);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(stopped_us > last_edge_us + 1000000);
+    TEST_ASSERT_TRUE(stopped_us <= last_edge_us + 1000000 + 100000 + 1000);
+}
+
+// The main loop stalls long enough for the capture buffer to overflow; the
+// period across the gap must not make it into a reading
+static void overflow(uint32_t prescale, uint32_t stall_ms) {
+    edges = edge_stream(4000000, idle);
+    rpm_sensor("period", prescale);
+    fakes::run_ms(1000);
+    fakes::advance_ms(stall_ms);
+    fakes::run_ms(2000);
+    float error = worst_error(0, idle);
+    char message[120];
+    snprintf(message, sizeof(message), "prescale %u, %u ms main loop stall: worst error %.2f%%", (unsigned)prescale,
+             (unsigned)stall_ms, 100 * error);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN(0.02f, error);
+}
+
+void test_overflow() {
+    overflow(1, 500);
+    setUp();
+    overflow(RPM_CAPTURE_PRESCALE, 2000);
+}
+
+// The calibration saved by the SensESP Frequency transform and by the
+// Linear transform that replaced it
+void test_legacy_multiplier() {
+    auto multiplier = new RpmMultiplier(RPM_MULTIPLIER);
+    DynamicJsonDocument doc(128);
+    JsonObject frequency = doc.to<JsonObject>();
+    frequency["multiplier"] = 0.5f;
+    TEST_ASSERT_TRUE(multiplier->set_configuration(frequency));
+    multiplier->set_input(100);
+    TEST_ASSERT_EQUAL_FLOAT(50, multiplier->get());
+
+    JsonObject linear = doc.to<JsonObject>();
+    linear["multiplier"] = 0.25f;
+    linear["offset"] = 0;
+    TEST_ASSERT_TRUE(multiplier->set_configuration(linear));
+    multiplier->set_input(100);
+    TEST_ASSERT_EQUAL_FLOAT(25, multiplier->get());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_period_idle);
+    RUN_TEST(test_count_idle);
+    RUN_TEST(test_glitches);
+    RUN_TEST(test_acceleration);
+    RUN_TEST(test_stop_timeout);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_legacy_multiplier);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+#include <ReactESP.h>
+#include <SPIFFS.h>
+#include <unity.h>
+
+#include <chrono>
+
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "flash_ring.h"
+#include "run_time_sensor.h"
+#include "sensesp/system/configurable.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
+
+using namespace sensesp;
+
+// The engine run time journal on the simulated flash: recovery after a
+// power loss at every byte of a record write, the time and reads the
+// recovery takes, and the flash wear against the JSON config rewrites the
+// run time used before.
+
+static const char* JOURNAL_PATH = "/data/engine_runtime.jnl";
+static const size_t CAPACITY = 64;
+static const size_t SLOT_SIZE = 3 * sizeof(uint32_t);
+// Erase cycles an SPI NOR flash sector is rated for
+static const float RATED_ERASE_CYCLES = 100000;
+
+// What RunTimeSensor::update() saved every update period before the journal
+class OldRunTimeConfig : public Configurable {
+   public:
+    OldRunTimeConfig() : Configurable("/data/engine_runtime") {}
+    void get_configuration(JsonObject& root) override {
+        root["update_period"] = 10000;
+        root["save_period"] = 300000;
+        root["run_time"] = run_time;
+    }
+    float run_time = 0;
+};
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+}
+
+void tearDown() {}
+
+static FlashRing* boot() {
+    auto ring = new FlashRing(JOURNAL_PATH, sizeof(float), CAPACITY);
+    TEST_ASSERT_TRUE(ring->begin());
+    return ring;
+}
+
+static void append(FlashRing* ring, float value) { ring->append(&value); }
+
+static float latest(FlashRing* ring) {
+    float value = NAN;
+    TEST_ASSERT_TRUE(ring->read_latest(&value));
+    return value;
+}
+
+// Power is lost after each possible number of bytes of a record, both in
+// the middle of the ring and while it wraps around
+void test_power_loss_at_every_byte() {
+    for (size_t records : {5, (int)CAPACITY - 1, (int)CAPACITY, 3 * (int)CAPACITY + 7}) {
+        for (size_t bytes = 0; bytes <= SLOT_SIZE; bytes++) {
+            fakes::flash_format();
+            auto ring = boot();
+            for (size_t i = 1; i <= records; i++) {
+                append(ring, i * 60.0f);
+            }
+            fakes::cut_power_after(bytes);
+            append(ring, (records + 1) * 60.0f);
+            fakes::power_on();
+
+            ring = boot();
+            float expected = (bytes == SLOT_SIZE ? records + 1 : records) * 60.0f;
+            TEST_ASSERT_EQUAL_FLOAT(expected, latest(ring));
+            // Appends carry on after the recovered record
+            append(ring, 1e6f);
+            ring = boot();
+            TEST_ASSERT_EQUAL_FLOAT(1e6f, latest(ring));
+        }
+    }
+}
+
+// The recovery scans the whole ring once, however many records were written
+void test_recovery_time() {
+    auto ring = boot();
+    for (int i = 1; i <= 1000; i++) {
+        append(ring, i);
+    }
+
+    const int BOOTS = 1000;
+    fakes::reset_flash_stats();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < BOOTS; i++) {
+        FlashRing recovered(JOURNAL_PATH, sizeof(float), CAPACITY);
+        recovered.begin();
+    }
+    auto end = std::chrono::steady_clock::now();
+    uint64_t bytes_read = fakes::flash_stats().bytes_read / BOOTS;
+
+    char message[120];
+    snprintf(message, sizeof(message), "recovery: %.1f us host time, %u bytes read",
+             std::chrono::duration<double, std::micro>(end - begin).count() / BOOTS, (unsigned)bytes_read);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT64(CAPACITY * SLOT_SIZE, bytes_read);
+    TEST_ASSERT_EQUAL_FLOAT(1000, latest(boot()));
+}
+
+static void report_wear(const char* name, float hours) {
+    fakes::FlashStats stats = fakes::flash_stats();
+    // Wear levelling spreads the erases over all the blocks
+    float erases_per_block_hour = stats.block_erases / (float)fakes::FLASH_BLOCKS / hours;
+    char message[200];
+    snprintf(message, sizeof(message), "%s: %.1f bytes/h, %.2f block erases/h, rated life %.0f engine hours",
+             name, stats.bytes_written / hours, stats.block_erases / hours, RATED_ERASE_CYCLES / erases_per_block_hour);
+    TEST_MESSAGE(message);
+}
+
+// 500 engine hours of saves, the old way and with the journal
+void test_erase_cycles() {
+    const float HOURS = 500;
+
+    OldRunTimeConfig config;
+    fakes::reset_flash_stats();
+    for (uint32_t second = 10; second <= HOURS * 3600; second += 10) {
+        config.run_time = second;
+        config.save_configuration();
+    }
+    report_wear("JSON config every 10 s", HOURS);
+    uint64_t old_erases = fakes::flash_stats().block_erases;
+
+    fakes::flash_format();
+    auto ring = boot();
+    fakes::reset_flash_stats();
+    for (uint32_t second = 60; second <= HOURS * 3600; second += 60) {
+        append(ring, second);
+    }
+    report_wear("journal every 60 s", HOURS);
+    uint64_t erases = fakes::flash_stats().block_erases;
+
+    TEST_ASSERT_GREATER_THAN(0, old_erases);
+    // Every write costs a data page and an index page however small it is,
+    // so the erases drop with the number of writes rather than the bytes
+    TEST_ASSERT_LESS_THAN(old_erases / 5, erases);
+}
+
+// RunTimeSensor as in main.cpp, running for ten minutes and rebooted
+void test_run_time_sensor_recovers_journal() {
+    ObservableValue<float> rpms;
+    auto sensor = new RunTimeSensor(&rpms, 10000, 60000, "/data/engine_runtime");
+    sensor->start();
+    rpms.set(30);
+    fakes::reset_flash_stats();
+    fakes::run_ms(10 * 60000 + 1);
+    // One record per save period, and no config file rewrite
+    TEST_ASSERT_LESS_OR_EQUAL(10 * SLOT_SIZE, fakes::flash_stats().bytes_written);
+
+    new ReactESP();
+    auto rebooted = new RunTimeSensor(&rpms, 10000, 60000, "/data/engine_runtime");
+    float run_time = NAN;
+    rebooted->connect_to(new LambdaConsumer<float>([&run_time](float value) { run_time = value; }));
+    rebooted->start();
+    rpms.set(30);
+    fakes::run_ms(10000);
+    TEST_ASSERT_FLOAT_WITHIN(1, 610, run_time);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_power_loss_at_every_byte);
+    RUN_TEST(test_recovery_time);
+    RUN_TEST(test_erase_cycles);
+    RUN_TEST(test_run_time_sensor_recovers_journal);
+    return UNITY_END();
+}
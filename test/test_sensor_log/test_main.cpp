@@ -0,0 +1,140 @@
+#include <ArduinoJson.h>
+#include <ReactESP.h>
+#include <unity.h>
+
+#include <vector>
+
+#include "configuration.h"
+#include "fakes/can_bus.h"
+#include "fakes/clock.h"
+#include "fakes/flash.h"
+#include "rpm_sensor.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/transforms/linear.h"
+#include "sensor_log.h"
+
+using namespace sensesp;
+
+// SensorLog replay faster than real time: two boots of an RPM stream and a
+// coolant sender stream are recorded through their transforms, then
+// replayed at REPLAY_SPEED through the same transforms. The outputs must
+// come out with the same values, in the same order across both streams,
+// at the recorded intervals divided by the speed.
+
+static const uint32_t BOOT_MS = 30000;
+static const float REPLAY_SPEED = 10;
+// SensorLog replays from a 10 ms reaction
+static const uint32_t REPLAY_PERIOD = 10;
+
+struct Output {
+    uint8_t source;
+    float value;
+    uint32_t ms;
+};
+
+static std::vector<Output> outputs;
+
+void setUp() {
+    fakes::retire_tasks();
+    fakes::flash_format();
+    fakes::can_bus().clear();
+    new ReactESP();
+    outputs.clear();
+}
+
+void tearDown() {}
+
+static SensorLog* sensor_log(const char* mode) {
+    auto log = new SensorLog();
+    DynamicJsonDocument doc(128);
+    JsonObject config = doc.to<JsonObject>();
+    config["mode"] = mode;
+    config["speed"] = REPLAY_SPEED;
+    TEST_ASSERT_TRUE(log->set_configuration(config));
+    return log;
+}
+
+/**
+ * @brief One boot of the firmware: the live sensors, the taps and their transforms
+ *
+ * The RPMs change every 100 ms and the coolant sender resistance every
+ * second, as sampled values do; every output goes to `outputs`.
+ */
+static void boot(const char* mode, uint32_t run_ms) {
+    new ReactESP();
+    auto log = sensor_log(mode);
+
+    auto rpms = new ObservableValue<float>();
+    rpms->connect_to(log->tap("engine_rpms"))
+        ->connect_to(new RpmMultiplier(0.5f))
+        ->connect_to(new LambdaConsumer<float>([](float value) { outputs.push_back({0, value, (uint32_t)millis()}); }));
+    auto coolant = new ObservableValue<float>();
+    coolant->connect_to(log->tap("coolant_temperature"))
+        ->connect_to(new Linear(-0.4f, 330, ""))
+        ->connect_to(new LambdaConsumer<float>([](float value) { outputs.push_back({1, value, (uint32_t)millis()}); }));
+    log->start();
+
+    ReactESP::app->onRepeat(100, [rpms]() { rpms->set(40 + 10 * sinf(millis() / 700.0f)); });
+    ReactESP::app->onRepeat(1000, [coolant]() { coolant->set(90 + (millis() / 1000) % 17); });
+    fakes::run_ms(run_ms);
+}
+
+static std::vector<Output> recorded_boots[2];
+
+// The replayed outputs of one boot: a prefix of the recorded ones, as the
+// block being filled when the boot ended is not in the log
+static void check_boot(const std::vector<Output>& recorded, const std::vector<Output>& replayed, size_t from,
+                       size_t count) {
+    TEST_ASSERT_GREATER_THAN(recorded.size() / 2, count);
+    TEST_ASSERT_LESS_OR_EQUAL(recorded.size(), count);
+    for (size_t i = 0; i < count; i++) {
+        const Output& expected = recorded[i];
+        const Output& actual = replayed[from + i];
+        TEST_ASSERT_EQUAL_UINT8(expected.source, actual.source);
+        TEST_ASSERT_EQUAL_FLOAT(expected.value, actual.value);
+        if (i > 0) {
+            // The recorded interval, sped up, give or take a replay period
+            float interval = (expected.ms - recorded[0].ms) / REPLAY_SPEED;
+            TEST_ASSERT_FLOAT_WITHIN(REPLAY_PERIOD, interval, actual.ms - replayed[from].ms);
+        }
+    }
+}
+
+void test_replay_faster() {
+    for (auto& recorded : recorded_boots) {
+        boot("record", BOOT_MS);
+        recorded = outputs;
+        outputs.clear();
+    }
+
+    // The live sensors keep running during the replay, and are ignored
+    boot("replay", 2 * BOOT_MS / REPLAY_SPEED + 1000);
+    std::vector<Output> replayed = outputs;
+
+    // The second boot starts where its first two outputs come out
+    size_t first_boot = 1;
+    while (first_boot + 1 < replayed.size() &&
+           !(replayed[first_boot].source == recorded_boots[1][0].source &&
+             replayed[first_boot].value == recorded_boots[1][0].value &&
+             replayed[first_boot + 1].value == recorded_boots[1][1].value)) {
+        first_boot++;
+    }
+    size_t second_boot = replayed.size() - first_boot;
+    char message[160];
+    snprintf(message, sizeof(message), "%u and %u outputs recorded, %u and %u replayed in %.1f s at %.0fx",
+             (unsigned)recorded_boots[0].size(), (unsigned)recorded_boots[1].size(), (unsigned)first_boot,
+             (unsigned)second_boot, (replayed.back().ms - replayed.front().ms) / 1000.0f, REPLAY_SPEED);
+    TEST_MESSAGE(message);
+
+    check_boot(recorded_boots[0], replayed, 0, first_boot);
+    check_boot(recorded_boots[1], replayed, first_boot, second_boot);
+    // The second boot starts right after the last sample of the first one
+    TEST_ASSERT_LESS_OR_EQUAL(REPLAY_PERIOD, replayed[first_boot].ms - replayed[first_boot - 1].ms);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_faster);
+    return UNITY_END();
+}